@@ -126,6 +126,31 @@ bool BitReader::skip(uint32_t nbits)
     return true;
 }
 
+bool BitReader::skipBytes(uint32_t nbytes)
+{
+    uint64_t nbits = static_cast<uint64_t>(nbytes) << 3;
+    if (nbits <= m_bitsInCache) {
+        m_bitsInCache -= nbits;
+        m_pos += nbits;
+        return true;
+    }
+    if (nbits > getRemainingBitsCount()) {
+        m_pos += getRemainingBitsCount();
+        m_bitsInCache = 0;
+        m_loadBytes = m_size;
+        return false;
+    }
+    /* drop the cache, and jump over whole bytes in source data,
+     * if we are not byte aligned, the last few bits need a read */
+    nbits -= m_bitsInCache;
+    m_pos += m_bitsInCache;
+    m_bitsInCache = 0;
+    uint32_t bytes = nbits >> 3;
+    m_loadBytes += bytes;
+    m_pos += static_cast<uint64_t>(bytes) << 3;
+    return skip(nbits & 7);
+}
+
 uint32_t BitReader::peek(uint32_t nbits) const
 {
     BitReader tmp(*this);
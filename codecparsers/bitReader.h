@@ -53,6 +53,11 @@ public:
 
     bool skip(uint32_t nbits);
 
+    /* Skip nbytes without reading them, cost does not depend on nbytes.
+     * If not enough data, it will return false and eat all data.
+     * NalReader overrides this since it needs to count the emulation prevent bytes */
+    virtual bool skipBytes(uint32_t nbytes);
+
     /* Get the total bits that had been read from bitstream,
      * For the subclass NalReader, this pos already removed the Emulation Prevent Byte*/
     uint64_t getPos() const
@@ -22,6 +22,7 @@
 #include "bitReader.h"
 
 // library headers
+#include "common/common_def.h"
 #include "common/unittest.h"
 
 // system libraries
@@ -96,4 +97,44 @@ BITREADER_TEST(NullInit)
     EXPECT_DEATH(BitReader r3(NULL, 1), "");
 }
 
+BITREADER_TEST(SkipBytes)
+{
+    std::vector<uint8_t> data(100);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = i;
+
+    //aligned and unaligned start, inside and across the cache
+    const uint32_t bits[] = { 0, 3, 8, 13, 61 };
+    const uint32_t bytes[] = { 0, 1, 5, 8, 17, 70 };
+    for (size_t i = 0; i < N_ELEMENTS(bits); i++) {
+        for (size_t j = 0; j < N_ELEMENTS(bytes); j++) {
+            BitReader reader(&data[0], data.size());
+            BitReader expected(&data[0], data.size());
+            reader.skip(bits[i]);
+            expected.skip(bits[i]);
+            EXPECT_TRUE(reader.skipBytes(bytes[j]));
+            for (uint32_t k = 0; k < bytes[j]; k++)
+                expected.read(8);
+            EXPECT_EQ(expected.getPos(), reader.getPos());
+            EXPECT_EQ(expected.getRemainingBitsCount(), reader.getRemainingBitsCount());
+            EXPECT_EQ(expected.read(19), reader.read(19));
+        }
+    }
+
+    BitReader reader(&data[0], data.size());
+    reader.skip(4);
+    EXPECT_FALSE(reader.skipBytes(data.size()));
+    EXPECT_TRUE(reader.end());
+    EXPECT_EQ(data.size() * 8, reader.getPos());
+}
+
+BITREADER_TEST(SkipBytesLarge)
+{
+    std::vector<uint8_t>& data = largeData();
+    BitReader reader(&data[0], data.size());
+    EXPECT_TRUE(reader.skipBytes(data.size() - 1));
+    EXPECT_EQ(8u, reader.getRemainingBitsCount());
+    EXPECT_EQ((static_cast<uint64_t>(data.size()) - 1) << 3, reader.getPos());
+}
+
 } // namespace YamiParser
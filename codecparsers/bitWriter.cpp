@@ -24,19 +24,58 @@
 
 namespace YamiParser {
 
-const uint32_t CACHEBYTES = sizeof(unsigned long int);
-const uint32_t CACHEBITS = sizeof(unsigned long int) * 8;
+const uint32_t CACHEBYTES = sizeof(uint64_t);
+const uint32_t CACHEBITS = sizeof(uint64_t) * 8;
 
 // clip to keep lowest n bits
 #define CLIPBITS(value, n) ((value) & ((1 << (n)) - 1));
 
+/*count leading zero bits of a non-zero value*/
+static inline uint32_t countLeadingZeros(uint32_t x)
+{
+    assert(x);
+#if defined(__GNUC__)
+    return __builtin_clz(x);
+#else
+    uint32_t n = 0;
+    while (!(x & 0x80000000)) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
 BitWriter::BitWriter(uint32_t size)
     : m_cache(0)
     , m_bitsInCache(0)
+    , m_emulationPrevention(false)
+    , m_zeroBytes(0)
 {
     m_bs.reserve(size);
 }
 
+void BitWriter::setEmulationPrevention(bool enable)
+{
+    ASSERT(!(m_bitsInCache % 8));
+    flushCache();
+    m_emulationPrevention = enable;
+    m_zeroBytes = 0;
+}
+
+void BitWriter::putByte(uint8_t byte)
+{
+    if (m_emulationPrevention) {
+        /* 0x000000/0x000001/0x000002/0x000003 become 0x00000300... */
+        if (m_zeroBytes >= 2 && byte <= 3) {
+            m_bs.push_back(3);
+            m_zeroBytes = 0;
+        }
+        m_zeroBytes = byte ? 0 : m_zeroBytes + 1;
+    }
+    m_bs.push_back(byte);
+}
+
 uint8_t* BitWriter::getBitWriterData()
 {
     uint8_t* buf;
@@ -61,20 +100,16 @@ void BitWriter::flushCache()
 
     for (i = 0; i < bytesInCache; i++) {
         tmp = static_cast<uint8_t>(m_cache >> (m_bitsInCache - (i + 1) * 8));
-        m_bs.push_back(tmp);
+        putByte(tmp);
     }
 
     m_cache = 0;
     m_bitsInCache = 0;
 }
 
-bool BitWriter::writeBits(uint32_t value, uint32_t numBits)
+void BitWriter::putBits(uint32_t value, uint32_t numBits)
 {
-    if (value >= (uint64_t)1 << numBits) {
-        WARNING("Write Bits: value overflow");
-    }
-
-    ASSERT((m_bitsInCache <= CACHEBITS) && (numBits <= CACHEBITS));
+    ASSERT((m_bitsInCache <= CACHEBITS) && (numBits <= 32));
 
     uint32_t bitLeft = CACHEBITS - m_bitsInCache;
 
@@ -88,10 +123,59 @@ bool BitWriter::writeBits(uint32_t value, uint32_t numBits)
         m_cache = value;
         m_bitsInCache = numBits - bitLeft;
     }
+}
+
+bool BitWriter::writeBits(uint64_t value, uint32_t numBits)
+{
+    ASSERT(numBits <= CACHEBITS);
+
+    if (numBits < CACHEBITS && value >= (uint64_t)1 << numBits) {
+        WARNING("Write Bits: value overflow");
+    }
+
+    // the cache takes at most 32 bits at a time, so shifts stay in range
+    if (numBits > 32) {
+        putBits(static_cast<uint32_t>(value >> 32), numBits - 32);
+        numBits = 32;
+    }
+    if (numBits)
+        putBits(static_cast<uint32_t>(value & 0xffffffff), numBits);
+
+    // emulation prevention may add bytes, move whole bytes out of the cache
+    // so getCodedBitsCount() stays exact
+    while (m_emulationPrevention && m_bitsInCache >= 8) {
+        putByte(static_cast<uint8_t>(m_cache >> (m_bitsInCache - 8)));
+        m_bitsInCache -= 8;
+    }
 
     return true;
 }
 
+bool BitWriter::writeUe(uint32_t value)
+{
+    uint64_t codeNum = static_cast<uint64_t>(value) + 1;
+    // leading zeros and the code word, 2 * size - 1 bits in total
+    uint32_t size = (codeNum >> 32) ? 33
+        : 32 - countLeadingZeros(static_cast<uint32_t>(codeNum));
+    if (size > 32)
+        writeBits(0, size - 1);
+    else
+        size = 2 * size - 1;
+    return writeBits(codeNum, size);
+}
+
+bool BitWriter::writeSe(int32_t value)
+{
+    uint32_t codeNum;
+
+    if (value <= 0)
+        codeNum = static_cast<uint32_t>(-static_cast<int64_t>(value) * 2);
+    else
+        codeNum = (static_cast<uint32_t>(value) << 1) - 1;
+
+    return writeUe(codeNum);
+}
+
 bool BitWriter::writeBytes(uint8_t* data, uint32_t numBytes)
 {
     if (!data || !numBytes)
@@ -99,7 +183,12 @@ bool BitWriter::writeBytes(uint8_t* data, uint32_t numBytes)
 
     if ((m_bitsInCache % 8) == 0) {
         flushCache();
-        m_bs.insert(m_bs.end(), data, data + numBytes);
+        if (m_emulationPrevention) {
+            for (uint32_t i = 0; i < numBytes; i++)
+                putByte(data[i]);
+        } else {
+            m_bs.insert(m_bs.end(), data, data + numBytes);
+        }
     } else {
         for (uint32_t i = 0; i < numBytes; i++)
             writeBits(data[i], 8);
@@ -31,8 +31,12 @@ public:
        */
     BitWriter(uint32_t size = BIT_WRITER_DEFAULT_BUFFER_SIZE);
 
-    /* Write a value with numBits into bitstream */
-    bool writeBits(uint32_t value, uint32_t numBits);
+    /* Write a value with numBits (up to 64) into bitstream */
+    bool writeBits(uint64_t value, uint32_t numBits);
+
+    /* Write unsigned/signed Exp-Golomb codes, ue(v) and se(v) */
+    bool writeUe(uint32_t value);
+    bool writeSe(int32_t value);
 
     /* Write an array with numBytes into bitstream */
     bool writeBytes(uint8_t* data, uint32_t numBytes);
@@ -40,6 +44,13 @@ public:
     /* Pad some zeros to make sure bitsteam byte aligned */
     void writeToBytesAligned(bool bit = false);
 
+    /* Insert emulation prevention bytes (0x03) into all bytes written after
+     * this call, so the output is final Annex-B NAL data. The start code must
+     * be written before enabling it, and bitstream must be byte aligned here.
+     * When enabled, getCodedBitsCount includes the inserted bytes.
+     */
+    void setEmulationPrevention(bool enable);
+
     /* get encoded bitstream buffer */
     uint8_t* getBitWriterData();
 
@@ -55,11 +66,16 @@ public:
 
 protected:
     void flushCache();
+    void putBits(uint32_t value, uint32_t numBits);
+    inline void putByte(uint8_t byte);
 
     std::vector<uint8_t> m_bs; /* encoded bitstream buffer */
 
-    long int m_cache; /* a 32 or 64 bits cache buffer */
+    uint64_t m_cache; /* a 64 bits cache buffer */
     uint32_t m_bitsInCache; /* used bits in cache*/
+
+    bool m_emulationPrevention;
+    uint32_t m_zeroBytes; /* trailing zero bytes in m_bs */
 };
 
 } /*namespace YamiParser*/
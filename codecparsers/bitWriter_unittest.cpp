@@ -22,7 +22,9 @@
 #include "bitWriter.h"
 
 // library headers
+#include "common/common_def.h"
 #include "common/unittest.h"
+#include "nalReader.h"
 
 namespace YamiParser {
 
@@ -57,4 +59,101 @@ BITWriter_TEST(Writer_Simple)
     EXPECT_EQ(bitsSum, Writer.getCodedBitsCount());
 }
 
+BITWriter_TEST(Writer_Bits64)
+{
+    BitWriter writer;
+
+    EXPECT_TRUE(writer.writeBits(0x5, 3));
+    EXPECT_TRUE(writer.writeBits(0x123456789abcdef0ULL, 64));
+    EXPECT_TRUE(writer.writeBits(0x1f, 5));
+    EXPECT_EQ(72u, writer.getCodedBitsCount());
+
+    const uint8_t expected[] = {
+        0xa2, 0x46, 0x8a, 0xcf, 0x13, 0x57, 0x9b, 0xde, 0x1f
+    };
+    uint8_t* data = writer.getBitWriterData();
+    ASSERT_TRUE(data);
+    for (size_t i = 0; i < N_ELEMENTS(expected); i++)
+        EXPECT_EQ(expected[i], data[i]) << i;
+}
+
+BITWriter_TEST(Writer_ExpGolomb)
+{
+    BitWriter writer;
+
+    // 1, 010, 011, 00100, 00101
+    for (uint32_t i = 0; i < 5; i++)
+        EXPECT_TRUE(writer.writeUe(i));
+    EXPECT_EQ(17u, writer.getCodedBitsCount());
+    // 0 -> 1, 1 -> 010, -1 -> 011
+    EXPECT_TRUE(writer.writeSe(0));
+    EXPECT_TRUE(writer.writeSe(1));
+    EXPECT_TRUE(writer.writeSe(-1));
+    EXPECT_EQ(24u, writer.getCodedBitsCount());
+
+    uint8_t* data = writer.getBitWriterData();
+    ASSERT_TRUE(data);
+    EXPECT_EQ(0xa6, data[0]);
+    EXPECT_EQ(0x42, data[1]);
+    EXPECT_EQ(0xd3, data[2]);
+}
+
+BITWriter_TEST(Writer_EmulationPrevention)
+{
+    BitWriter writer;
+
+    writer.writeBits(1, 32); // start code is not touched
+    writer.setEmulationPrevention(true);
+    writer.writeBits(0, 16);
+    writer.writeBits(1, 8); // 00 00 03 01
+    writer.writeBits(0, 24); // 00 00 03 00
+    writer.writeBits(0xff, 8);
+    uint8_t bytes[] = { 0, 0, 2 }; // 00 00 03 02
+    writer.writeBytes(bytes, N_ELEMENTS(bytes));
+
+    const uint8_t expected[] = {
+        0x00, 0x00, 0x00, 0x01,
+        0x00, 0x00, 0x03, 0x01,
+        0x00, 0x00, 0x03, 0x00, 0xff,
+        0x00, 0x00, 0x03, 0x02
+    };
+    ASSERT_EQ(N_ELEMENTS(expected) * 8, writer.getCodedBitsCount());
+    uint8_t* data = writer.getBitWriterData();
+    ASSERT_TRUE(data);
+    for (size_t i = 0; i < N_ELEMENTS(expected); i++)
+        EXPECT_EQ(expected[i], data[i]) << i;
+}
+
+BITWriter_TEST(Writer_RoundTrip)
+{
+    BitWriter writer;
+    writer.setEmulationPrevention(true);
+
+    // plenty of zeros, so emulation prevention bytes are needed
+    const uint32_t ues[] = { 0, 1, 7, 255, 65535, 1u << 20, 0xfffffffe, 0 };
+    const int32_t ses[] = { 0, -1, 1, -128, 127, -32768, 1 << 20, 0 };
+    for (size_t i = 0; i < N_ELEMENTS(ues); i++) {
+        EXPECT_TRUE(writer.writeUe(ues[i]));
+        EXPECT_TRUE(writer.writeBits(0, 24));
+        EXPECT_TRUE(writer.writeSe(ses[i]));
+        EXPECT_TRUE(writer.writeBits(0x3, 40));
+    }
+    writer.writeBits(1, 1);
+    writer.writeToBytesAligned();
+
+    uint32_t size = writer.getCodedBitsCount() / 8;
+    uint8_t* data = writer.getBitWriterData();
+    ASSERT_TRUE(data);
+
+    NalReader reader(data, size);
+    for (size_t i = 0; i < N_ELEMENTS(ues); i++) {
+        EXPECT_EQ(ues[i], reader.readUe()) << i;
+        EXPECT_EQ(0u, reader.read(24)) << i;
+        EXPECT_EQ(ses[i], reader.readSe()) << i;
+        EXPECT_EQ(0u, reader.read(8)) << i;
+        EXPECT_EQ(0x3u, reader.read(32)) << i;
+    }
+    EXPECT_FALSE(reader.moreRbspData());
+}
+
 } // namespace YamiParser
@@ -308,10 +308,32 @@ bool Parser::vuiParameters(SharedPtr<SPS>& sps, NalReader& br)
     return true;
 }
 
+//read the ue(v) parameter set id which follows skipBits fixed bits
+static bool peekParameterSetId(const uint8_t* data, uint32_t size,
+    uint32_t skipBits, uint32_t& id)
+{
+    NalReader br(data, size);
+    return br.skip(skipBits) && br.readUe(id);
+}
+
 bool Parser::parseSps(SharedPtr<SPS>& sps, const NalUnit* nalu)
 {
-    NalReader br(nalu->m_data + nalu->m_nalUnitHeaderBytes,
-        nalu->m_size - nalu->m_nalUnitHeaderBytes);
+    const uint8_t* data = nalu->m_data + nalu->m_nalUnitHeaderBytes;
+    uint32_t size = nalu->m_size - nalu->m_nalUnitHeaderBytes;
+    uint32_t id;
+
+    //profile_idc, constraint flags and level_idc come before sps_id
+    if (peekParameterSetId(data, size, 24, id) && id <= MAX_SPS_ID
+        && m_sps.isSame(id, data, size)) {
+        sps = m_sps.get(id);
+        return true;
+    }
+    if (!sps) {
+        sps.reset(new SPS());
+        memset(sps.get(), 0, sizeof(SPS));
+    }
+
+    NalReader br(data, size);
 
     READ(sps->profile_idc);
     READ(sps->constraint_set0_flag);
@@ -495,7 +517,7 @@ bool Parser::parseSps(SharedPtr<SPS>& sps, const NalUnit* nalu)
         sps->m_cropY = cropUnitY * sps->frame_crop_top_offset;
     }
 
-    m_spsMap[sps->sps_id] = sps;
+    m_sps.set(sps->sps_id, sps, data, size);
 
     return true;
 }
@@ -505,9 +527,23 @@ bool Parser::parsePps(SharedPtr<PPS>& pps, const NalUnit* nalu)
     SharedPtr<SPS> sps;
     bool pic_scaling_matrix_present_flag;
     int32_t qp_bd_offset;
+    const uint8_t* data = nalu->m_data + nalu->m_nalUnitHeaderBytes;
+    uint32_t size = nalu->m_size - nalu->m_nalUnitHeaderBytes;
+    uint32_t id;
+
+    //a repeated pps is kept as long as its sps was not replaced
+    if (peekParameterSetId(data, size, 0, id) && id <= MAX_PPS_ID
+        && m_pps.isSame(id, data, size)) {
+        const SharedPtr<PPS>& saved = m_pps.get(id);
+        if (saved->m_sps == searchSps(saved->sps_id)) {
+            pps = saved;
+            return true;
+        }
+    }
+    if (!pps)
+        pps.reset(new PPS());
 
-    NalReader br(nalu->m_data + nalu->m_nalUnitHeaderBytes,
-        nalu->m_size - nalu->m_nalUnitHeaderBytes);
+    NalReader br(data, size);
 
     READ_UE(pps->pps_id);
     READ_UE(pps->sps_id);
@@ -641,34 +677,15 @@ bool Parser::parsePps(SharedPtr<PPS>& pps, const NalUnit* nalu)
             goto error;
     }
 
-    m_ppsMap[pps->pps_id] = pps;
+    m_pps.set(pps->pps_id, pps, data, size);
 
     return true;
 error:
     free(pps->slice_group_id);
+    pps->slice_group_id = NULL;
     return false;
 }
 
-inline SharedPtr<PPS>
-Parser::searchPps(uint8_t id) const
-{
-    SharedPtr<PPS> res;
-    PpsMap::const_iterator it = m_ppsMap.find(id);
-    if (it != m_ppsMap.end())
-        res = it->second;
-    return res;
-}
-
-inline SharedPtr<SPS>
-Parser::searchSps(uint8_t id) const
-{
-    SharedPtr<SPS> res;
-    SpsMap::const_iterator it = m_spsMap.find(id);
-    if (it != m_spsMap.end())
-        res = it->second;
-    return res;
-}
-
 SliceHeader::SliceHeader()
 {
     memset((void*)this, 0, offsetof(SliceHeader, m_pps));
@@ -814,7 +831,7 @@ bool SliceHeader::predWeightTable(NalReader& br, uint8_t chromaArrayType)
 bool SliceHeader::parseHeader(Parser* nalparser, NalUnit* nalu)
 {
     uint32_t pps_id;
-    SharedPtr<SPS> sps;
+    const SPS* sps;
 
     if (!nalu->m_size)
         return false;
@@ -832,7 +849,7 @@ bool SliceHeader::parseHeader(Parser* nalparser, NalUnit* nalu)
     if (!m_pps)
         return false;
 
-    sps = m_pps->m_sps;
+    sps = m_pps->m_sps.get();
 
     //set default values for fields that might not be present in the bitstream
     //and have valid defaults
@@ -30,9 +30,9 @@
 #define h264parser_h
 
 #include "nalReader.h"
+#include "parameterSets.h"
 #include "VideoCommonDefs.h"
 
-#include <map>
 #include <string.h>
 
 namespace YamiParser {
@@ -430,22 +430,22 @@ public:
         SCALING_LIST_DEFAULT_VALUE = 16
     };
 
-    typedef std::map<uint8_t, SharedPtr<SPS> > SpsMap;
-    typedef std::map<uint8_t, SharedPtr<PPS> > PpsMap;
-
+    //sps and pps may be empty, the parser allocates them then. When a nal
+    //repeats the payload of the set already stored for its id, the stored
+    //set is returned in sps/pps and nothing is parsed again.
     bool parseSps(SharedPtr<SPS>& sps, const NalUnit* nalu);
     bool parsePps(SharedPtr<PPS>& pps, const NalUnit* nalu);
 
-    inline SharedPtr<PPS> searchPps(uint8_t id) const;
-    inline SharedPtr<SPS> searchSps(uint8_t id) const;
+    const SharedPtr<PPS>& searchPps(uint8_t id) const { return m_pps.get(id); }
+    const SharedPtr<SPS>& searchSps(uint8_t id) const { return m_sps.get(id); }
 
 private:
     bool hrdParameters(HRDParameters* hrd, NalReader& nr);
     bool vuiParameters(SharedPtr<SPS>& sps, NalReader& nr);
 
     static const uint8_t EXTENDED_SAR;
-    SpsMap m_spsMap;
-    PpsMap m_ppsMap;
+    ParameterSets<SPS, MAX_SPS_ID + 1> m_sps;
+    ParameterSets<PPS, MAX_PPS_ID + 1> m_pps;
 };
 
 }
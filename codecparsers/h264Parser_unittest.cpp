@@ -209,5 +209,48 @@ namespace H264 {
         ASSERT_FALSE(HasFailure());
     }
 
+    H264_PARSER_TEST(Parse_RepeatedParameterSets)
+    {
+        const uint8_t* nal;
+        int32_t size;
+        NalUnit spsNalu, ppsNalu;
+        NalReader nr(&g_SimpleH264[0], g_SimpleH264.size());
+        Parser parser;
+        SharedPtr<SPS> sps, sps2;
+        SharedPtr<PPS> pps, pps2;
+
+        ASSERT_TRUE(nr.read(nal, size));
+        ASSERT_TRUE(spsNalu.parseNalUnit(nal, size));
+        ASSERT_TRUE(nr.read(nal, size));
+        ASSERT_TRUE(ppsNalu.parseNalUnit(nal, size));
+
+        ASSERT_TRUE(parser.parseSps(sps, &spsNalu));
+        ASSERT_TRUE(parser.parsePps(pps, &ppsNalu));
+        EXPECT_EQ(sps, pps->m_sps);
+
+        // identical sets resent before the next idr are not parsed again
+        ASSERT_TRUE(parser.parseSps(sps2, &spsNalu));
+        ASSERT_TRUE(parser.parsePps(pps2, &ppsNalu));
+        EXPECT_EQ(sps, sps2);
+        EXPECT_EQ(pps, pps2);
+
+        // a changed sps replaces the stored one, and the pps is parsed again
+        std::vector<uint8_t> changed(spsNalu.m_data, spsNalu.m_data + spsNalu.m_size);
+        changed[3] = 41; // level_idc
+        NalUnit changedNalu;
+        ASSERT_TRUE(changedNalu.parseNalUnit(&changed[0], changed.size()));
+        sps2.reset();
+        ASSERT_TRUE(parser.parseSps(sps2, &changedNalu));
+        EXPECT_NE(sps, sps2);
+        EXPECT_EQ(41, sps2->level_idc);
+        EXPECT_EQ(sps2, parser.searchSps(0));
+
+        pps2.reset();
+        ASSERT_TRUE(parser.parsePps(pps2, &ppsNalu));
+        EXPECT_NE(pps, pps2);
+        EXPECT_EQ(sps2, pps2->m_sps);
+        EXPECT_EQ(pps2, parser.searchPps(0));
+    }
+
 } // namespace H264
 } // namespace YamiParser
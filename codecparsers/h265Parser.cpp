@@ -237,39 +237,47 @@ bool NalUnit::parseNaluHeader(const uint8_t* data, size_t size)
 
 uint8_t Parser::EXTENDED_SAR = 255;
 
-SharedPtr<VPS> Parser::getVps(uint8_t id) const
+const SharedPtr<VPS>& Parser::getVps(uint8_t id) const
 {
-    SharedPtr<VPS> res;
-    VpsMap::const_iterator it = m_vps.find(id);
-    if (it != m_vps.end())
-        res = it->second;
-    else
+    const SharedPtr<VPS>& res = m_vps.get(id);
+    if (!res)
         WARNING("can't get the VPS by ID(%d)", id);
     return res;
 }
 
-SharedPtr<SPS> Parser::getSps(uint8_t id) const
+const SharedPtr<SPS>& Parser::getSps(uint8_t id) const
 {
-    SharedPtr<SPS> res;
-    SpsMap::const_iterator it = m_sps.find(id);
-    if (it != m_sps.end())
-        res = it->second;
-    else
+    const SharedPtr<SPS>& res = m_sps.get(id);
+    if (!res)
         WARNING("can't get the SPS by ID(%d)", id);
     return res;
 }
 
-SharedPtr<PPS> Parser::getPps(uint8_t id) const
+const SharedPtr<PPS>& Parser::getPps(uint8_t id) const
 {
-    SharedPtr<PPS> res;
-    PpsMap::const_iterator it = m_pps.find(id);
-    if (it != m_pps.end())
-        res = it->second;
-    else
+    const SharedPtr<PPS>& res = m_pps.get(id);
+    if (!res)
         WARNING("can't get the PPS by ID(%d)", id);
     return res;
 }
 
+// sps_id follows vps_id, sps_max_sub_layers_minus1,
+// sps_temporal_id_nesting_flag and profile_tier_level
+bool Parser::peekSpsId(const uint8_t* data, uint32_t size, uint32_t& id)
+{
+    NalReader br(data, size);
+    ProfileTierLevel ptl;
+    uint8_t maxSubLayersMinus1;
+
+    memset(&ptl, 0, sizeof(ptl));
+    return br.skip(4)
+        && br.readT(maxSubLayersMinus1, 3)
+        && maxSubLayersMinus1 < MAXSUBLAYERS
+        && br.skip(1)
+        && profileTierLevel(&ptl, br, maxSubLayersMinus1)
+        && br.readUe(id);
+}
+
 // 7.3.3 Profile, tier and level syntax
 bool Parser::profileTierLevel(ProfileTierLevel* ptl, NalReader& br,
     uint8_t maxNumSubLayersMinus1)
@@ -898,10 +906,14 @@ bool Parser::predWeightTable(SliceHeader* slice, NalReader& br)
 // 7.3.2.1 Video parameter set RBSP syntax
 bool Parser::parseVps(const NalUnit* nalu)
 {
-    SharedPtr<VPS> vps(new VPS());
+    const uint8_t* data = nalu->m_data + NalUnit::NALU_HEAD_SIZE;
+    uint32_t size = nalu->m_size - NalUnit::NALU_HEAD_SIZE;
 
-    NalReader br(nalu->m_data + NalUnit::NALU_HEAD_SIZE,
-        nalu->m_size - NalUnit::NALU_HEAD_SIZE);
+    if (size && m_vps.isSame(data[0] >> 4, data, size))
+        return true;
+
+    SharedPtr<VPS> vps(new VPS());
+    NalReader br(data, size);
 
     READ_BITS(vps->vps_id, 4);
     READ(vps->vps_base_layer_internal_flag);
@@ -971,7 +983,7 @@ bool Parser::parseVps(const NalUnit* nalu)
             SKIP(1); // vps_extension_data_flag
     }
     br.rbspTrailingBits();
-    m_vps[vps->vps_id] = vps;
+    m_vps.set(vps->vps_id, vps, data, size);
 
     return true;
 }
@@ -979,14 +991,25 @@ bool Parser::parseVps(const NalUnit* nalu)
 // 7.3.2.2 Sequence parameter set RBSP syntax
 bool Parser::parseSps(const NalUnit* nalu)
 {
+    const uint8_t* data = nalu->m_data + NalUnit::NALU_HEAD_SIZE;
+    uint32_t size = nalu->m_size - NalUnit::NALU_HEAD_SIZE;
+    uint32_t id;
+
+    // a repeated sps is kept as long as its vps was not replaced
+    if (peekSpsId(data, size, id) && id <= MAXSPSCOUNT
+        && m_sps.isSame(id, data, size)) {
+        const SharedPtr<SPS>& saved = m_sps.get(id);
+        if (saved->vps == m_vps.get(saved->vps_id))
+            return true;
+    }
+
     SharedPtr<SPS> sps(new SPS());
     SharedPtr<VPS> vps;
     // Table 6-1
     uint8_t subWidthC[5] = { 1, 2, 2, 1, 1 };
     uint8_t subHeightC[5] = { 1, 2, 1, 1, 1 };
 
-    NalReader br(nalu->m_data + NalUnit::NALU_HEAD_SIZE,
-        nalu->m_size - NalUnit::NALU_HEAD_SIZE);
+    NalReader br(data, size);
 
     READ_BITS(sps->vps_id, 4);
     vps = getVps(sps->vps_id);
@@ -1114,7 +1137,7 @@ bool Parser::parseSps(const NalUnit* nalu)
     // remaining some extension elements, it is not necessary for me, so ignore.
     // maybe add in the future.
 
-    m_sps[sps->sps_id] = sps;
+    m_sps.set(sps->sps_id, sps, data, size);
 
     return true;
 }
@@ -1122,6 +1145,19 @@ bool Parser::parseSps(const NalUnit* nalu)
 // 7.3.2.3 Picture parameter set RBSP syntax
 bool Parser::parsePps(const NalUnit* nalu)
 {
+    const uint8_t* data = nalu->m_data + NalUnit::NALU_HEAD_SIZE;
+    uint32_t size = nalu->m_size - NalUnit::NALU_HEAD_SIZE;
+    uint32_t id;
+
+    // a repeated pps is kept as long as its sps was not replaced
+    NalReader idReader(data, size);
+    if (idReader.readUe(id) && id <= MAXPPSCOUNT
+        && m_pps.isSame(id, data, size)) {
+        const SharedPtr<PPS>& saved = m_pps.get(id);
+        if (saved->sps == m_sps.get(saved->sps_id))
+            return true;
+    }
+
     SharedPtr<PPS> pps(new PPS());
     SharedPtr<SPS> sps;
 
@@ -1129,8 +1165,7 @@ bool Parser::parsePps(const NalUnit* nalu)
     uint32_t ctbLog2SizeY;
     uint32_t ctbSizeY;
 
-    NalReader br(nalu->m_data + NalUnit::NALU_HEAD_SIZE,
-        nalu->m_size - NalUnit::NALU_HEAD_SIZE);
+    NalReader br(data, size);
 
     // set default values
     pps->uniform_spacing_flag = 1;
@@ -1289,7 +1324,7 @@ bool Parser::parsePps(const NalUnit* nalu)
         CHECK_READ_UE(pps->log2_sao_offset_scale_chroma, 0, maxValue);
     }
 
-    m_pps[pps->pps_id] = pps;
+    m_pps.set(pps->pps_id, pps, data, size);
 
     return true;
 }
@@ -1298,8 +1333,8 @@ bool Parser::parsePps(const NalUnit* nalu)
 bool Parser::parseSlice(const NalUnit* nalu, SliceHeader* slice)
 {
     uint32_t nbits;
-    SharedPtr<PPS> pps;
-    SharedPtr<SPS> sps;
+    PPS* pps;
+    SPS* sps;
     ShortTermRefPicSet* stRPS = NULL;
     uint32_t UsedByCurrPicLt[16] = {0};
     int32_t numPicTotalCurr = 0;
@@ -1318,12 +1353,12 @@ bool Parser::parseSlice(const NalUnit* nalu, SliceHeader* slice)
 
     CHECK_READ_UE(slice->pps_id, 0, MAXPPSCOUNT);
 
-    pps = getPps(slice->pps_id);
-    if (!pps)
+    slice->pps = getPps(slice->pps_id);
+    if (!slice->pps)
         return false;
-    slice->pps = pps;
+    pps = slice->pps.get();
 
-    sps = pps->sps;
+    sps = pps->sps.get();
     if (!sps)
         return false;
 
@@ -1358,7 +1393,7 @@ bool Parser::parseSlice(const NalUnit* nalu, SliceHeader* slice)
             READ(slice->short_term_ref_pic_set_sps_flag);
             if (!slice->short_term_ref_pic_set_sps_flag) {
                 if (!stRefPicSet(&slice->short_term_ref_pic_sets, br,
-                        sps->num_short_term_ref_pic_sets, sps.get()))
+                        sps->num_short_term_ref_pic_sets, sps))
                     return false;
             }
             else if (sps->num_short_term_ref_pic_sets > 1) {
@@ -27,15 +27,16 @@
 #define h265Parser_h
 
 #include "nalReader.h"
+#include "parameterSets.h"
 #include "VideoCommonDefs.h"
 
-#include <map>
 #include <vector>
 
 namespace YamiParser {
 namespace H265 {
 
     const uint8_t MAXSUBLAYERS = 7;
+    const uint8_t MAXVPSCOUNT = 15;
     const uint8_t MAXSPSCOUNT = 15;
     const uint8_t MAXPPSCOUNT = 63;
     const uint8_t MAXSHORTTERMRPSCOUNT = 64;
@@ -574,6 +575,7 @@ namespace H265 {
         static uint8_t EXTENDED_SAR;
 
         bool profileTierLevel(ProfileTierLevel* ptl, NalReader& nr, uint8_t maxNumSubLayersMinus1);
+        bool peekSpsId(const uint8_t* data, uint32_t size, uint32_t& id);
         bool subLayerHrdParameters(SubLayerHRDParameters* subParams,
             NalReader& nr, uint32_t CpbCnt, uint8_t subPicParamsPresentFlag);
         bool hrdParameters(HRDParameters* params, NalReader& nr,
@@ -587,17 +589,14 @@ namespace H265 {
             NalReader& nr, int32_t numPicTotalCurr);
         bool predWeightTable(SliceHeader* slice, NalReader& nr);
 
-        typedef std::map<uint8_t, SharedPtr<VPS> > VpsMap;
-        typedef std::map<uint8_t, SharedPtr<SPS> > SpsMap;
-        typedef std::map<uint8_t, SharedPtr<PPS> > PpsMap;
+        const SharedPtr<VPS>& getVps(uint8_t id) const;
+        const SharedPtr<SPS>& getSps(uint8_t id) const;
+        const SharedPtr<PPS>& getPps(uint8_t id) const;
 
-        SharedPtr<VPS> getVps(uint8_t id) const;
-        SharedPtr<SPS> getSps(uint8_t id) const;
-        SharedPtr<PPS> getPps(uint8_t id) const;
-
-        VpsMap m_vps;
-        SpsMap m_sps;
-        PpsMap m_pps;
+        // repeated parameter sets keep their parsed object, see ParameterSets
+        ParameterSets<VPS, MAXVPSCOUNT + 1> m_vps;
+        ParameterSets<SPS, MAXSPSCOUNT + 1> m_sps;
+        ParameterSets<PPS, MAXPPSCOUNT + 1> m_pps;
 
         friend class H265ParserTest;
     };
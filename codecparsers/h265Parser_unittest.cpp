@@ -177,6 +177,10 @@ namespace H265 {
             EXPECT_EQ(2, slice.slice_type);
             EXPECT_EQ(0, slice.cr_qp_offset);
         }
+
+        SharedPtr<VPS> getVps(Parser& parser) { return parser.getVps(0); }
+        SharedPtr<SPS> getSps(Parser& parser) { return parser.getSps(0); }
+        SharedPtr<PPS> getPps(Parser& parser) { return parser.getPps(0); }
     };
 
 #define H265_PARSER_TEST(name) TEST_F(H265ParserTest, name)
@@ -208,5 +212,51 @@ namespace H265 {
         ASSERT_FALSE(HasFailure());
     }
 
+    H265_PARSER_TEST(Parse_RepeatedParameterSets)
+    {
+        const uint8_t* nal;
+        int32_t size;
+        NalUnit vpsNalu, spsNalu, ppsNalu;
+        NalReader nr(&g_SimpleH265[0], g_SimpleH265.size());
+        Parser parser;
+
+        ASSERT_TRUE(nr.read(nal, size));
+        ASSERT_TRUE(vpsNalu.parseNaluHeader(nal, size));
+        ASSERT_TRUE(nr.read(nal, size));
+        ASSERT_TRUE(spsNalu.parseNaluHeader(nal, size));
+        ASSERT_TRUE(nr.read(nal, size));
+        ASSERT_TRUE(ppsNalu.parseNaluHeader(nal, size));
+
+        ASSERT_TRUE(parser.parseVps(&vpsNalu));
+        ASSERT_TRUE(parser.parseSps(&spsNalu));
+        ASSERT_TRUE(parser.parsePps(&ppsNalu));
+        SharedPtr<VPS> vps = getVps(parser);
+        SharedPtr<SPS> sps = getSps(parser);
+        SharedPtr<PPS> pps = getPps(parser);
+
+        // identical sets resent before the next irap are not parsed again
+        ASSERT_TRUE(parser.parseVps(&vpsNalu));
+        ASSERT_TRUE(parser.parseSps(&spsNalu));
+        ASSERT_TRUE(parser.parsePps(&ppsNalu));
+        EXPECT_EQ(vps, getVps(parser));
+        EXPECT_EQ(sps, getSps(parser));
+        EXPECT_EQ(pps, getPps(parser));
+
+        // a changed vps is parsed, and the sets depending on it follow
+        std::vector<uint8_t> changed(vpsNalu.m_data, vpsNalu.m_data + vpsNalu.m_size);
+        changed[20] = 150; // general_level_idc
+        NalUnit changedNalu;
+        ASSERT_TRUE(changedNalu.parseNaluHeader(&changed[0], changed.size()));
+        ASSERT_TRUE(parser.parseVps(&changedNalu));
+        EXPECT_EQ(150, getVps(parser)->profile_tier_level.general_level_idc);
+
+        ASSERT_TRUE(parser.parseSps(&spsNalu));
+        ASSERT_TRUE(parser.parsePps(&ppsNalu));
+        EXPECT_NE(sps, getSps(parser));
+        EXPECT_NE(pps, getPps(parser));
+        EXPECT_EQ(getVps(parser), getSps(parser)->vps);
+        EXPECT_EQ(getSps(parser), getPps(parser)->sps);
+    }
+
 } // namespace H265
 } // namespace YamiParser
@@ -239,9 +239,31 @@ Parser::Parser(const uint8_t* data, const uint32_t size)
     , m_sawEOI(false)
     , m_sawSOS(false)
     , m_restartInterval(0)
+    , m_restartOffsets()
 {
 }
 
+void Parser::reset(const uint8_t* data, const uint32_t size)
+{
+    m_input = BitReader(data, size);
+    m_data = data;
+    m_size = size;
+    m_current = Segment();
+    m_frameHeader.reset();
+    m_scanHeader.reset();
+    m_quantTables = QuantTables();
+    m_dcHuffTables = HuffTables();
+    m_acHuffTables = HuffTables();
+    m_arithDCL = ArithmeticTable();
+    m_arithDCU = ArithmeticTable();
+    m_arithACK = ArithmeticTable();
+    m_sawSOI = false;
+    m_sawEOI = false;
+    m_sawSOS = false;
+    m_restartInterval = 0;
+    m_restartOffsets.clear();
+}
+
 bool Parser::skipBytes(const uint32_t nBytes)
 {
     if ((static_cast<uint64_t>(nBytes) << 3)
@@ -250,15 +272,7 @@ bool Parser::skipBytes(const uint32_t nBytes)
         return false;
     }
 
-    // BitReader only supports skipping a max of CACHEBYTES at a time
-    // for each call to skip.
-    const uint32_t nSkips = nBytes / BitReader::CACHEBYTES;
-    const uint32_t rem = nBytes % BitReader::CACHEBYTES;
-    for (uint32_t i(0); i < nSkips; ++i)
-        m_input.skip(BitReader::CACHEBYTES << 3);
-    m_input.skip(rem << 3);
-
-    return true;
+    return m_input.skipBytes(nBytes);
 }
 
 void Parser::registerCallback(const Marker& marker, const Callback& callback)
@@ -637,7 +651,37 @@ bool Parser::parseSOS()
 
     m_sawSOS = true;
 
-    return true;
+    return indexRestartMarkers();
+}
+
+bool Parser::indexRestartMarkers()
+{
+    m_restartOffsets.clear();
+
+    const uint8_t* const end = m_data + m_size;
+    const uint8_t* current = m_data + currentBytePosition();
+
+    // Walk the entropy-coded segment once, memchr does the heavy lifting.
+    // Stuffed 0xFF00 and fill bytes are skipped, RSTn is recorded, anything
+    // else ends the segment and is left for nextMarker().
+    while (current < end) {
+        const uint8_t* match = static_cast<const uint8_t*>(
+            memchr(current, 0xFF, end - current));
+        if (!match || match + 1 == end)
+            break;
+        const uint8_t c = match[1];
+        if (c >= M_RST0 && c <= M_RST7) {
+            m_restartOffsets.push_back(match - m_data);
+            current = match + 2;
+        } else if (c == 0x00 || c == 0xFF) {
+            current = match + 1;
+        } else {
+            return skipBytes(match - m_data - currentBytePosition());
+        }
+    }
+
+    // no marker after the scan, let parse() deal with the missing EOI
+    return skipBytes(m_size - currentBytePosition());
 }
 
 bool Parser::parseEOI()
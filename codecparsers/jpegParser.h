@@ -194,6 +194,13 @@ public:
      */
     bool parse();
 
+    /**
+     * Start over on new JPEG byte data.  All parsed state is cleared, but
+     * registered callbacks are kept, so one Parser can be used for every
+     * frame of a MJPEG stream.
+     */
+    void reset(const uint8_t* data, uint32_t size);
+
     /**
      * Register a Callback function for Marker. The Callback is called after
      * the Marker is parsed by the parse() method.
@@ -216,6 +223,18 @@ public:
     const HuffTables& acHuffTables() const { return m_acHuffTables; }
     unsigned restartInterval() const { return m_restartInterval; }
 
+    /**
+     * @return byte positions of the RSTn markers found in the entropy-coded
+     * data of the most current scan.  Each position points at the 0xFF of
+     * the marker, so restart interval k (k > 0) starts two bytes after
+     * restartOffsets()[k - 1].  RSTn markers inside a scan are indexed
+     * here and are not reported to registered callbacks.
+     */
+    const std::vector<uint32_t>& restartOffsets() const
+    {
+        return m_restartOffsets;
+    }
+
 private:
     friend class JPEGParserTest;
 
@@ -234,6 +253,7 @@ private:
     bool parseDQT();
     bool parseDHT();
     bool parseDRI();
+    bool indexRestartMarkers();
 
     BitReader m_input;
 
@@ -259,6 +279,7 @@ private:
     bool m_sawSOS;
 
     unsigned m_restartInterval;
+    std::vector<uint32_t> m_restartOffsets;
 };
 
 } // namespace JPEG
@@ -22,6 +22,7 @@
 #include "jpegParser.h"
 
 // library headers
+#include "common/common_def.h"
 #include "common/unittest.h"
 
 // system headers
@@ -515,6 +516,78 @@ JPEG_PARSER_TEST(Parse_SimpleWithCallbacks)
     ASSERT_FALSE(HasFailure());
 }
 
+JPEG_PARSER_TEST(Parse_Reset)
+{
+    Parser parser(&g_SimpleJPEG[0], g_SimpleJPEG.size());
+    Results results;
+    parser.registerCallback(M_EOI,
+        std::bind(&simpleCallback, std::ref(results), std::ref(parser)));
+
+    for (int i = 0; i < 3; i++) {
+        EXPECT_TRUE(parser.parse());
+        checkSimpleJPEG(parser);
+        ASSERT_FALSE(HasFailure());
+        //callbacks are kept after reset
+        EXPECT_EQ(i + 1u, results[M_EOI].size());
+        parser.reset(&g_SimpleJPEG[0], g_SimpleJPEG.size());
+        EXPECT_FALSE(parser.frameHeader());
+        EXPECT_FALSE(parser.quantTables()[0]);
+    }
+
+    //truncated data after a complete one
+    parser.reset(&g_SimpleJPEG[0], 100);
+    EXPECT_FALSE(parser.parse());
+    EXPECT_EQ(3u, results[M_EOI].size());
+}
+
+JPEG_PARSER_TEST(Parse_RestartMarkers)
+{
+    std::vector<uint8_t> data(g_SimpleJPEG.begin(), g_SimpleJPEG.end());
+
+    ASSERT_EQ(data[610], M_SOS);
+    const uint8_t dri[] = { 0xff, M_DRI, 0x00, 0x04, 0x00, 0x02 };
+    data.insert(data.begin() + 609, dri, dri + N_ELEMENTS(dri));
+
+    // entropy-coded data starts after the 14 bytes SOS segment
+    const uint32_t scan = 609 + N_ELEMENTS(dri) + 14;
+    const uint32_t offsets[] = { scan + 10, scan + 40, scan + 100 };
+    for (size_t i(0); i < N_ELEMENTS(offsets); ++i) {
+        const uint8_t rst[] = { 0xff, uint8_t(M_RST0 + i) };
+        ASSERT_NE(0xff, data[offsets[i] - 1]);
+        data.insert(data.begin() + offsets[i], rst, rst + N_ELEMENTS(rst));
+    }
+    // a fill byte before the last marker
+    data.insert(data.begin() + offsets[2], 0xff);
+    const uint32_t lastOffset = offsets[2] + 1;
+
+    Parser parser(&data[0], data.size());
+    Results results;
+    parser.registerCallback(M_EOI,
+        std::bind(&simpleCallback, std::ref(results), std::ref(parser)));
+    parser.registerCallback(M_RST0,
+        std::bind(&simpleCallback, std::ref(results), std::ref(parser)));
+
+    EXPECT_TRUE(parser.parse());
+    EXPECT_EQ(2u, parser.restartInterval());
+
+    const std::vector<uint32_t>& found = parser.restartOffsets();
+    ASSERT_EQ(3u, found.size());
+    EXPECT_EQ(offsets[0], found[0]);
+    EXPECT_EQ(offsets[1], found[1]);
+    EXPECT_EQ(lastOffset, found[2]);
+
+    // RSTn inside the scan are indexed, not reported
+    EXPECT_EQ(0u, results[M_RST0].size());
+    ASSERT_EQ(1u, results[M_EOI].size());
+    EXPECT_EQ(data.size() - 1, results[M_EOI][0].position);
+
+    // no RSTn in the simple stream
+    parser.reset(&g_SimpleJPEG[0], g_SimpleJPEG.size());
+    EXPECT_TRUE(parser.parse());
+    EXPECT_TRUE(parser.restartOffsets().empty());
+    EXPECT_EQ(2u, results[M_EOI].size());
+}
+
 JPEG_PARSER_TEST(Parse_SimpleTruncated)
 {
     const size_t size(g_SimpleJPEG.size());
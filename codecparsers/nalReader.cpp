@@ -19,6 +19,7 @@
 #endif
 
 #include <assert.h>
+#include <string.h>
 #include "nalReader.h"
 
 namespace YamiParser {
@@ -41,12 +42,28 @@ inline bool NalReader::isEmulationBytes(const uint8_t *p) const
             && *(p - 1) == 0x00 && *(p - 2) == 0x00;
 }
 
+/*check a cache word of data for 0x03, the emulation prevention byte candidate*/
+static inline bool hasEmulationCandidate(const uint8_t *p)
+{
+    const unsigned long int ones = ~0UL / 0xff;
+    unsigned long int v;
+    memcpy(&v, p, sizeof(v));
+    v ^= ones * 0x03;
+    return (v - ones) & ~v & (ones * 0x80);
+}
+
 void NalReader::loadDataToCache(uint32_t nbytes)
 {
     const uint8_t *pStart = m_stream + m_loadBytes;
     const uint8_t *p;
     const uint8_t *pEnd = m_stream + m_size;
-    /*the numbers of emulation prevention three byte in current load block*/
+
+    /*most of rbsp data has no 0x03 at all, load it as a whole*/
+    if (nbytes == CACHEBYTES && m_size - m_loadBytes >= nbytes
+        && !hasEmulationCandidate(pStart)) {
+        BitReader::loadDataToCache(nbytes);
+        return;
+    }
 
     unsigned long int tmp = 0;
     uint32_t size = 0;
@@ -62,9 +79,73 @@ void NalReader::loadDataToCache(uint32_t nbytes)
     m_bitsInCache = size << 3;
 }
 
+#if !defined(__GNUC__)
+/*leading zero bits of a byte, used when no clz builtin is available*/
+static const uint8_t s_leadingZeros[256] = {
+    8, 7, 6, 6, 5, 5, 5, 5, 4, 4, 4, 4, 4, 4, 4, 4,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+#endif
+
+/*count leading zero bits of a non-zero cache word*/
+static inline uint32_t countLeadingZeros(unsigned long int x)
+{
+    assert(x);
+#if defined(__GNUC__)
+    return __builtin_clzl(x);
+#else
+    uint32_t n = 0;
+    uint32_t shift = (sizeof(x) - 1) << 3;
+    while (!(x >> shift)) {
+        x <<= 8;
+        n += 8;
+    }
+    return n + s_leadingZeros[x >> shift];
+#endif
+}
+
+/*decode the Exp-Golomb code word from the cache directly,
+  return false if the code word is not entirely in the cache*/
+inline bool NalReader::readUeFromCache(uint32_t& v)
+{
+    const uint32_t cacheBits = CACHEBYTES << 3;
+    if (!m_bitsInCache)
+        return false;
+    /*left align the remaining bits, the low bits are zero padded*/
+    unsigned long int bits = m_cache << (cacheBits - m_bitsInCache);
+    if (!bits)
+        return false;
+    uint32_t leadingZeroBits = countLeadingZeros(bits);
+    uint32_t codeBits = (leadingZeroBits << 1) + 1;
+    if (leadingZeroBits > 31 || codeBits > m_bitsInCache)
+        return false;
+    v = (bits >> (cacheBits - codeBits)) - 1;
+    m_bitsInCache -= codeBits;
+    m_pos += codeBits;
+    return true;
+}
+
 /*according to 9.1 of h264 spec*/
 bool NalReader::readUe(uint32_t& v)
 {
+    if (readUeFromCache(v))
+        return true;
+
+    /*code word crosses the cache boundary, read it bit by bit*/
     int32_t leadingZeroBits = -1;
 
     for (uint32_t b = 0; !b; leadingZeroBits++) {
@@ -104,6 +185,17 @@ int32_t NalReader::readSe()
     return res;
 }
 
+bool NalReader::skipBytes(uint32_t nbytes)
+{
+    uint32_t tmp;
+    while (nbytes >= sizeof(tmp)) {
+        if (!readT(tmp))
+            return false;
+        nbytes -= sizeof(tmp);
+    }
+    return skip(nbytes << 3);
+}
+
 bool NalReader::moreRbspData() const
 {
     BitReader tmp(*this);
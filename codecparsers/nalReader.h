@@ -39,9 +39,13 @@ public:
 
     bool moreRbspData() const;
     void rbspTrailingBits();
+
+    /* we can't jump over data, emulation prevent bytes need to be removed */
+    bool skipBytes(uint32_t nbytes);
 private:
     void loadDataToCache(uint32_t nbytes);
     inline bool isEmulationBytes(const uint8_t *p) const;
+    inline bool readUeFromCache(uint32_t& v);
 };
 
 bool NalReader::readUe(uint8_t& v)
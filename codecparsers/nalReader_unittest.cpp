@@ -22,8 +22,13 @@
 #include "nalReader.h"
 
 // library headers
+#include "bitWriter.h"
 #include "common/unittest.h"
 
+// system headers
+#include <stdlib.h>
+#include <vector>
+
 namespace YamiParser {
 
 class NalReaderTest
@@ -113,4 +118,120 @@ NALREADER_TEST(GetPosForEPB)
     EXPECT_EQ(1u, b);
 }
 
+static void writeUe(BitWriter& writer, uint32_t v)
+{
+    uint64_t codeNum = static_cast<uint64_t>(v) + 1;
+    uint32_t bits = 0;
+    while (codeNum >> (bits + 1))
+        bits++;
+    writer.writeBits(0, bits);
+    writer.writeBits(1, 1);
+    writer.writeBits(static_cast<uint32_t>(codeNum), bits);
+}
+
+NALREADER_TEST(ReadUe)
+{
+    std::vector<uint32_t> values;
+    for (uint32_t i = 0; i < 2048; i++)
+        values.push_back(i);
+    for (uint32_t i = 11; i < 32; i++) {
+        values.push_back((1u << i) - 2);
+        values.push_back((1u << i) - 1);
+        values.push_back((1u << i) + 3);
+    }
+    values.push_back(0xfffffffe);
+
+    BitWriter writer;
+    //misalign all code words to the cache boundary
+    writer.writeBits(1, 3);
+    for (size_t i = 0; i < values.size(); i++)
+        writeUe(writer, values[i]);
+    uint64_t bits = writer.getCodedBitsCount();
+    uint8_t* data = writer.getBitWriterData();
+
+    NalReader reader(data, (bits + 7) >> 3);
+    EXPECT_EQ(1u, reader.read(3));
+    uint32_t v;
+    for (size_t i = 0; i < values.size(); i++) {
+        ASSERT_TRUE(reader.readUe(v));
+        EXPECT_EQ(values[i], v);
+    }
+    EXPECT_EQ(bits, reader.getPos());
+}
+
+NALREADER_TEST(ReadSe)
+{
+    BitWriter writer;
+    for (int32_t i = -1000; i <= 1000; i++)
+        writeUe(writer, i > 0 ? (i << 1) - 1 : -(i << 1));
+    uint64_t bits = writer.getCodedBitsCount();
+    uint8_t* data = writer.getBitWriterData();
+
+    NalReader reader(data, (bits + 7) >> 3);
+    int32_t v;
+    for (int32_t i = -1000; i <= 1000; i++) {
+        ASSERT_TRUE(reader.readSe(v));
+        EXPECT_EQ(i, v);
+    }
+    EXPECT_EQ(bits, reader.getPos());
+}
+
+NALREADER_TEST(ReadUeWithEPB)
+{
+    //0x0, 0x0, 0x3 is emulation prevention byte,
+    //the first code word has 16 leading zeros and ends in the last byte
+    const uint8_t data[] = {
+        0x0, 0x0, 0x3, 0x80,
+        0x0, 0xc0
+    };
+    NalReader r(data, sizeof(data));
+    uint32_t v;
+    EXPECT_TRUE(r.readUe(v));
+    EXPECT_EQ(0x10000u, v);
+    EXPECT_TRUE(r.readUe(v));
+    EXPECT_EQ(0u, v);
+    EXPECT_EQ(34u, r.getPos());
+}
+
+NALREADER_TEST(ReadWithEPB)
+{
+    std::vector<uint8_t> rbsp, ebsp;
+    srand(0x5678);
+    for (uint32_t i = 0; i < 4096; i++)
+        rbsp.push_back((rand() % 3) ? 0 : (rand() & 0xff));
+
+    //insert emulation prevention bytes
+    uint32_t zeros = 0;
+    for (size_t i = 0; i < rbsp.size(); i++) {
+        if (zeros == 2 && rbsp[i] <= 0x03) {
+            ebsp.push_back(0x03);
+            zeros = 0;
+        }
+        ebsp.push_back(rbsp[i]);
+        zeros = rbsp[i] ? 0 : zeros + 1;
+    }
+
+    NalReader nr(&ebsp[0], ebsp.size());
+    BitReader br(&rbsp[0], rbsp.size());
+    uint32_t v;
+    while (br.getRemainingBitsCount()) {
+        uint32_t nbits = std::min<uint64_t>(rand() % 33, br.getRemainingBitsCount());
+        ASSERT_TRUE(nr.read(v, nbits));
+        EXPECT_EQ(br.read(nbits), v);
+        ASSERT_EQ(br.getPos(), nr.getPos());
+    }
+    EXPECT_TRUE(nr.end());
+}
+
+NALREADER_TEST(SkipBytesWithEPB)
+{
+    //0x03 in 00 00 03 is removed, so skip 3 bytes lands on 0x80
+    const uint8_t data[] = { 0x01, 0x00, 0x00, 0x03, 0x01, 0x80 };
+    NalReader reader(data, sizeof(data));
+    EXPECT_TRUE(reader.skipBytes(4));
+    EXPECT_EQ(0x80u, reader.read(8));
+    EXPECT_EQ(40u, reader.getPos());
+    EXPECT_FALSE(reader.skipBytes(1));
+}
+
 } // namespace YamiParser
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef parameterSets_h
+#define parameterSets_h
+
+#include "VideoCommonDefs.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace YamiParser {
+
+/**
+ * Parameter sets of one kind (SPS, PPS, VPS), indexed by their id.
+ *
+ * Every set is kept with the payload it was parsed from.  Encoders usually
+ * resend the same parameter sets before each IDR, isSame() lets the parser
+ * recognize them and keep the parsed object instead of building a new one.
+ */
+template <class T, uint32_t N>
+class ParameterSets {
+public:
+    // id must be less than N, an empty pointer means not received yet
+    const SharedPtr<T>& get(uint32_t id) const { return m_sets[id]; }
+
+    bool isSame(uint32_t id, const uint8_t* data, uint32_t size) const
+    {
+        const std::vector<uint8_t>& saved = m_data[id];
+        return m_sets[id] && saved.size() == size
+            && (!size || !memcmp(&saved[0], data, size));
+    }
+
+    void set(uint32_t id, const SharedPtr<T>& ps, const uint8_t* data, uint32_t size)
+    {
+        m_sets[id] = ps;
+        m_data[id].assign(data, data + size);
+    }
+
+private:
+    SharedPtr<T> m_sets[N];
+    std::vector<uint8_t> m_data[N];
+};
+
+} /*namespace YamiParser*/
+
+#endif
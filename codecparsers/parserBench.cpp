@@ -0,0 +1,877 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Throughput and fuzz harness for the codec parsers.
+ *
+ * As a benchmark it replays elementary streams through one parser:
+ *
+ *     parserbench [-n loops] <codec> <file|dir>...
+ *
+ * and reports headers/sec, bytes/sec and a digest of the parsed results.
+ * The digest only depends on what the parser extracted, so it must stay the
+ * same across parser optimizations.  Directories are scanned one level deep.
+ * H.264, HEVC, MPEG-2 and VC-1 (advanced profile) inputs are Annex-B style
+ * start code streams, VP8 and VP9 inputs are IVF files (a bare frame is
+ * accepted too), and every JPEG input is a single picture.  For JPEG the time
+ * per input is the per-frame parsing overhead, jpeg-new shows it with a new
+ * parser for every frame.
+ *
+ * Some pseudo codecs time one primitive against the code it replaced on
+ * the same input and report both:
+ *
+ *     golomb     ue(v) decoding of every NAL unit in an Annex-B stream
+ *     startcode  start code search, std::search and each simd level
+ *     jpegskip   jumping from marker to marker of JPEG inputs, like the JPEG
+ *                parser does over entropy coded segments
+ *
+ * Built with -DYAMI_PARSER_FUZZER it provides LLVMFuzzerTestOneInput instead
+ * of main, the first input byte selects the parser.  For example:
+ *
+ *     CXXFLAGS="-g -fsanitize=address,fuzzer -DYAMI_PARSER_FUZZER"
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// library headers
+#include "common/common_def.h"
+#include "common/log.h"
+#include "common/nalreader.h"
+#include "common/startcode.h"
+#include "VideoCommonDefs.h"
+#include "nalReader.h"
+#ifdef __BUILD_H264_DECODER__
+#include "h264Parser.h"
+#endif
+#ifdef __BUILD_H265_DECODER__
+#include "h265Parser.h"
+#endif
+#ifdef __BUILD_MPEG2_DECODER__
+#include "mpeg2_parser.h"
+#endif
+#ifdef __BUILD_VC1_DECODER__
+#include "vc1Parser.h"
+#endif
+#ifdef __BUILD_VP8_DECODER__
+#include "vp8_parser.h"
+#endif
+#ifdef __BUILD_VP9_DECODER__
+#include "vp9parser.h"
+#endif
+#if defined(__BUILD_JPEG_DECODER__) || defined(__BUILD_JPEG_ENCODER__)
+#include "jpegParser.h"
+#endif
+
+// system headers
+#include <algorithm>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <time.h>
+#include <vector>
+
+namespace YamiParser {
+
+static double now()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// Feeds one input to a parser and accumulates what it found.
+class ParserRunner {
+public:
+    ParserRunner()
+        : m_headers(0)
+        , m_failures(0)
+        , m_digest(2166136261U)
+    {
+    }
+    virtual ~ParserRunner() {}
+
+    // Start over on a new stream, all parser state is dropped.
+    virtual void reset() = 0;
+    virtual void run(const uint8_t* data, size_t size) = 0;
+    // Print runner specific results.
+    virtual void report(const char* /*name*/) const {}
+
+    uint64_t headers() const { return m_headers; }
+    uint64_t failures() const { return m_failures; }
+    uint32_t digest() const { return m_digest; }
+
+protected:
+    // Record a header parse result and the values it produced.
+    void record(bool ok, uint32_t v0 = 0, uint32_t v1 = 0, uint32_t v2 = 0)
+    {
+        if (ok)
+            m_headers++;
+        else
+            m_failures++;
+        mix(ok);
+        mix(v0);
+        mix(v1);
+        mix(v2);
+    }
+
+private:
+    void mix(uint32_t v)
+    {
+        for (int i = 0; i < 4; i++) {
+            m_digest ^= (v >> (i * 8)) & 0xff;
+            m_digest *= 16777619U;
+        }
+    }
+
+    uint64_t m_headers;
+    uint64_t m_failures;
+    uint32_t m_digest;
+};
+
+#ifdef __BUILD_H264_DECODER__
+class H264Runner : public ParserRunner {
+public:
+    H264Runner() { reset(); }
+
+    void reset() { m_parser.reset(new H264::Parser()); }
+
+    void run(const uint8_t* data, size_t size)
+    {
+        YamiMediaCodec::NalReader reader(data, size);
+        const uint8_t* nal;
+        int32_t nalSize;
+        while (reader.read(nal, nalSize)) {
+            H264::NalUnit nalu;
+            if (!nalu.parseNalUnit(nal, nalSize)) {
+                record(false);
+                continue;
+            }
+            switch (nalu.nal_unit_type) {
+            case H264::NAL_SPS: {
+                SharedPtr<H264::SPS> sps;
+                bool ok = m_parser->parseSps(sps, &nalu);
+                record(ok, nalu.nal_unit_type, ok ? sps->profile_idc : 0,
+                    ok ? sps->level_idc : 0);
+                break;
+            }
+            case H264::NAL_PPS: {
+                SharedPtr<H264::PPS> pps;
+                bool ok = m_parser->parsePps(pps, &nalu);
+                record(ok, nalu.nal_unit_type, ok ? pps->pps_id : 0);
+                break;
+            }
+            case H264::NAL_SLICE_NONIDR:
+            case H264::NAL_SLICE_IDR: {
+                H264::SliceHeader slice;
+                bool ok = slice.parseHeader(m_parser.get(), &nalu);
+                record(ok, slice.first_mb_in_slice, slice.slice_type,
+                    slice.m_headerSize);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+
+private:
+    SharedPtr<H264::Parser> m_parser;
+};
+#endif
+
+#ifdef __BUILD_H265_DECODER__
+class H265Runner : public ParserRunner {
+public:
+    H265Runner() { reset(); }
+
+    void reset() { m_parser.reset(new H265::Parser()); }
+
+    void run(const uint8_t* data, size_t size)
+    {
+        YamiMediaCodec::NalReader reader(data, size);
+        const uint8_t* nal;
+        int32_t nalSize;
+        while (reader.read(nal, nalSize)) {
+            H265::NalUnit nalu;
+            if (!nalu.parseNaluHeader(nal, nalSize)) {
+                record(false);
+                continue;
+            }
+            uint8_t type = nalu.nal_unit_type;
+            if (type == H265::NalUnit::VPS_NUT) {
+                record(m_parser->parseVps(&nalu), type);
+            } else if (type == H265::NalUnit::SPS_NUT) {
+                record(m_parser->parseSps(&nalu), type);
+            } else if (type == H265::NalUnit::PPS_NUT) {
+                record(m_parser->parsePps(&nalu), type);
+            } else if (type <= H265::NalUnit::RSV_IRAP_VCL23) {
+                H265::SliceHeader slice;
+                bool ok = m_parser->parseSlice(&nalu, &slice);
+                record(ok, slice.slice_segment_address, slice.slice_type,
+                    slice.headerSize);
+            }
+        }
+    }
+
+private:
+    SharedPtr<H265::Parser> m_parser;
+};
+#endif
+
+#ifdef __BUILD_MPEG2_DECODER__
+class MPEG2Runner : public ParserRunner {
+public:
+    MPEG2Runner() { reset(); }
+
+    void reset()
+    {
+        m_parser.reset(new MPEG2::Parser());
+        m_matrices.reset(new MPEG2::QuantMatrices());
+    }
+
+    void run(const uint8_t* data, size_t size)
+    {
+        YamiMediaCodec::NalReader reader(data, size);
+        const uint8_t* nal;
+        int32_t nalSize;
+        while (reader.read(nal, nalSize)) {
+            MPEG2::DecodeUnit du;
+            if (!du.parse(nal, nalSize)) {
+                record(false);
+                continue;
+            }
+            if (du.isSlice()) {
+                MPEG2::Slice slice;
+                bool ok = m_parser->parseSlice(slice, du);
+                record(ok, slice.macroblockRow, slice.macroblockColumn,
+                    slice.sliceHeaderSize);
+                continue;
+            }
+            switch (du.m_type) {
+            case MPEG2::MPEG2_SEQUENCE_HEADER_CODE:
+                record(m_parser->parseSequenceHeader(du, m_matrices), du.m_type,
+                    m_parser->getWidth(), m_parser->getHeight());
+                break;
+            case MPEG2::MPEG2_GROUP_START_CODE:
+                record(m_parser->parseGOPHeader(du), du.m_type);
+                break;
+            case MPEG2::MPEG2_PICTURE_START_CODE:
+                record(m_parser->parsePictureHeader(du), du.m_type,
+                    m_parser->m_pictureHeader.picture_coding_type);
+                break;
+            case MPEG2::MPEG2_EXTENSION_START_CODE:
+                parseExtension(du);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+private:
+    void parseExtension(const MPEG2::DecodeUnit& du)
+    {
+        BitReader br(du.m_data, du.m_size);
+        uint32_t id;
+        if (!br.read(id, 4)) {
+            record(false);
+            return;
+        }
+        switch (id) {
+        case MPEG2::kSequence:
+            record(m_parser->parseSequenceExtension(br), du.m_type, id);
+            break;
+        case MPEG2::kPictureCoding:
+            record(m_parser->parsePictureCodingExtension(br), du.m_type, id);
+            break;
+        case MPEG2::kQuantizationMatrix:
+            record(m_parser->parseQuantMatrixExtension(br, m_matrices),
+                du.m_type, id);
+            break;
+        default:
+            break;
+        }
+    }
+
+    SharedPtr<MPEG2::Parser> m_parser;
+    SharedPtr<MPEG2::QuantMatrices> m_matrices;
+};
+#endif
+
+#ifdef __BUILD_VC1_DECODER__
+// Advanced profile only, simple and main profile need container side data.
+class VC1Runner : public ParserRunner {
+public:
+    VC1Runner() { reset(); }
+
+    void reset()
+    {
+        m_parser.reset(new VC1::Parser());
+        m_hasSequence = false;
+    }
+
+    void run(const uint8_t* data, size_t size)
+    {
+        // the VC-1 parser works in place
+        std::vector<uint8_t> copy(data, data + size);
+        YamiMediaCodec::NalReader reader(&copy[0], copy.size());
+        const uint8_t* nal;
+        int32_t nalSize;
+        while (reader.read(nal, nalSize)) {
+            if (nalSize < 1)
+                continue;
+            // back up to the start code, the parser searches for it
+            uint8_t* bdu = const_cast<uint8_t*>(nal) - 3;
+            uint32_t bduSize = nalSize + 3;
+            switch (nal[0]) {
+            case 0x0f:
+            case 0x0e: {
+                bool ok = m_parser->parseCodecData(bdu, bduSize);
+                m_hasSequence = m_hasSequence || (ok && nal[0] == 0x0f);
+                record(ok, nal[0], m_parser->m_seqHdr.coded_width,
+                    m_parser->m_seqHdr.coded_height);
+                break;
+            }
+            case 0x0d:
+                if (m_hasSequence) {
+                    bool ok = m_parser->parseFrameHeader(bdu, bduSize);
+                    record(ok, nal[0], m_parser->m_frameHdr.picture_type,
+                        m_parser->m_frameHdr.macroblock_offset);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+private:
+    SharedPtr<VC1::Parser> m_parser;
+    bool m_hasSequence;
+};
+#endif
+
+// Splits IVF files into frames, anything else is taken as a single frame.
+class IvfRunner : public ParserRunner {
+public:
+    void run(const uint8_t* data, size_t size)
+    {
+        if (size < 32 || memcmp(data, "DKIF", 4)) {
+            runFrame(data, size);
+            return;
+        }
+        size_t pos = data[6] | (data[7] << 8);
+        while (pos + 12 <= size) {
+            const uint8_t* p = data + pos;
+            size_t frameSize = p[0] | (p[1] << 8) | (p[2] << 16)
+                | ((uint32_t)p[3] << 24);
+            pos += 12;
+            if (frameSize > size - pos)
+                break;
+            runFrame(data + pos, frameSize);
+            pos += frameSize;
+        }
+    }
+
+protected:
+    virtual void runFrame(const uint8_t* data, size_t size) = 0;
+};
+
+#ifdef __BUILD_VP8_DECODER__
+class VP8Runner : public IvfRunner {
+public:
+    VP8Runner() { reset(); }
+
+    void reset() { m_parser.reset(new Vp8Parser()); }
+
+protected:
+    void runFrame(const uint8_t* data, size_t size)
+    {
+        Vp8FrameHeader hdr;
+        bool ok = m_parser->ParseFrame(data, size, &hdr) == VP8_PARSER_OK;
+        record(ok, hdr.key_frame, hdr.first_part_size,
+            hdr.macroblock_bit_offset);
+    }
+
+private:
+    SharedPtr<Vp8Parser> m_parser;
+};
+#endif
+
+#ifdef __BUILD_VP9_DECODER__
+class VP9Runner : public IvfRunner {
+public:
+    VP9Runner() { reset(); }
+
+    void reset() { m_parser.reset(vp9_parser_new(), vp9_parser_free); }
+
+protected:
+    void runFrame(const uint8_t* data, size_t size)
+    {
+        Vp9FrameHdr hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        bool ok = vp9_parse_frame_header(m_parser.get(), &hdr, data, size)
+            == VP9_PARSER_OK;
+        record(ok, hdr.frame_type, hdr.frame_header_length_in_bytes,
+            hdr.first_partition_size);
+    }
+
+private:
+    SharedPtr<Vp9Parser> m_parser;
+};
+#endif
+
+#if defined(__BUILD_JPEG_DECODER__) || defined(__BUILD_JPEG_ENCODER__)
+// Registers the same callbacks the JPEG decoder does.  The decoder keeps one
+// parser for all frames, jpeg-new builds one per frame as it used to.
+class JPEGRunner : public ParserRunner {
+public:
+    JPEGRunner(bool reuse = true)
+        : m_reuse(reuse)
+    {
+        if (m_reuse)
+            create(NULL, 0);
+    }
+
+    void reset() {}
+
+    void run(const uint8_t* data, size_t size)
+    {
+        if (m_reuse)
+            m_parser->reset(data, size);
+        else
+            create(data, size);
+        bool ok = m_parser->parse();
+        uint32_t width = 0, height = 0;
+        if (m_parser->frameHeader()) {
+            width = m_parser->frameHeader()->imageWidth;
+            height = m_parser->frameHeader()->imageHeight;
+        }
+        record(ok, width, height, m_parser->restartOffsets().size());
+    }
+
+private:
+    static JPEG::Parser::CallbackResult onMarker()
+    {
+        return JPEG::Parser::ParseContinue;
+    }
+
+    void create(const uint8_t* data, size_t size)
+    {
+        using namespace JPEG;
+        m_parser.reset(new Parser(data, size));
+        Parser::Callback callback(onMarker);
+        m_parser->registerCallback(M_SOI, callback);
+        m_parser->registerCallback(M_EOI, callback);
+        m_parser->registerCallback(M_SOS, callback);
+        m_parser->registerCallback(M_DHT, callback);
+        m_parser->registerCallback(M_DQT, callback);
+        m_parser->registerStartOfFrameCallback(callback);
+    }
+
+    bool m_reuse;
+    JPEG::Parser::Shared m_parser;
+};
+
+class JPEGNewRunner : public JPEGRunner {
+public:
+    JPEGNewRunner()
+        : JPEGRunner(false)
+    {
+    }
+};
+#endif
+
+// Times an operation done in different ways on the same input.
+class CompareRunner : public ParserRunner {
+public:
+    void reset() {}
+
+    void report(const char* name) const
+    {
+        for (size_t i = 0; i < m_ways.size(); i++) {
+            const Way& w = m_ways[i];
+            double elapsed = w.elapsed > 0 ? w.elapsed : 1e-9;
+            printf("%s: %-10s %.3f s, %.0f %s/s, %.2f MB/s\n", name, w.name,
+                w.elapsed, w.count / elapsed, m_unit, w.bytes / elapsed / (1024 * 1024));
+        }
+    }
+
+protected:
+    CompareRunner(const char* unit)
+        : m_unit(unit)
+    {
+    }
+
+    void addWay(const char* name) { m_ways.push_back(Way(name)); }
+
+    void start() { m_start = now(); }
+
+    void stop(size_t way, uint64_t count, uint64_t bytes)
+    {
+        Way& w = m_ways[way];
+        w.elapsed += now() - m_start;
+        w.count += count;
+        w.bytes += bytes;
+    }
+
+private:
+    struct Way {
+        Way(const char* n)
+            : name(n)
+            , elapsed(0)
+            , count(0)
+            , bytes(0)
+        {
+        }
+        const char* name;
+        double elapsed;
+        uint64_t count;
+        uint64_t bytes;
+    };
+    const char* m_unit;
+    double m_start;
+    std::vector<Way> m_ways;
+};
+
+// Decodes each NAL unit after its first byte as a run of ue(v) codes, with
+// NalReader::readUe and with the bit by bit loop it used before.
+class GolombRunner : public CompareRunner {
+public:
+    GolombRunner()
+        : CompareRunner("codes")
+    {
+        addWay("readUe");
+        addWay("bit-loop");
+    }
+
+    void run(const uint8_t* data, size_t size)
+    {
+        YamiMediaCodec::NalReader reader(data, size);
+        const uint8_t* nal;
+        int32_t nalSize;
+        while (reader.read(nal, nalSize)) {
+            if (nalSize < 2)
+                continue;
+            uint32_t sum, loopSum;
+            start();
+            uint32_t codes = readCodes(nal + 1, nalSize - 1, sum, false);
+            stop(0, codes, nalSize - 1);
+            start();
+            uint32_t loopCodes = readCodes(nal + 1, nalSize - 1, loopSum, true);
+            stop(1, loopCodes, nalSize - 1);
+            record(codes == loopCodes && sum == loopSum, codes, sum);
+        }
+    }
+
+private:
+    static bool readUeLoop(NalReader& reader, uint32_t& v)
+    {
+        int32_t leadingZeroBits = -1;
+        for (uint32_t b = 0; !b; leadingZeroBits++) {
+            if (!reader.read(b, 1))
+                return false;
+        }
+        if (!reader.read(v, leadingZeroBits))
+            return false;
+        v = (1 << leadingZeroBits) - 1 + v;
+        return true;
+    }
+
+    static uint32_t readCodes(const uint8_t* data, uint32_t size, uint32_t& sum, bool loop)
+    {
+        NalReader reader(data, size);
+        uint32_t codes = 0;
+        uint32_t v;
+        sum = 0;
+        while (loop ? readUeLoop(reader, v) : reader.readUe(v)) {
+            sum += v;
+            codes++;
+        }
+        return codes;
+    }
+};
+
+// Counts the start codes of the whole input with every search we have.
+class StartCodeRunner : public CompareRunner {
+public:
+    StartCodeRunner()
+        : CompareRunner("start codes")
+    {
+        add("std", stdSearch);
+        add("scalar", getSearchStartCodeFunc(YamiMediaCodec::START_CODE_SEARCH_C));
+        add("sse2", getSearchStartCodeFunc(YamiMediaCodec::START_CODE_SEARCH_SSE2));
+        add("avx2", getSearchStartCodeFunc(YamiMediaCodec::START_CODE_SEARCH_AVX2));
+        add("dispatched", YamiMediaCodec::searchStartCode);
+    }
+
+    void run(const uint8_t* data, size_t size)
+    {
+        const uint8_t* end = data + size;
+        uint64_t expected = 0;
+        for (size_t i = 0; i < m_searches.size(); i++) {
+            start();
+            uint64_t count = 0;
+            for (const uint8_t* p = m_searches[i](data, end); p != end;
+                 p = m_searches[i](p + 3, end))
+                count++;
+            stop(i, count, size);
+            if (!i)
+                expected = count;
+            record(count == expected, count);
+        }
+    }
+
+private:
+    static const uint8_t* stdSearch(const uint8_t* begin, const uint8_t* end)
+    {
+        static const uint8_t startCode[] = { 0, 0, 1 };
+        return std::search(begin, end, startCode, startCode + 3);
+    }
+
+    void add(const char* name, YamiMediaCodec::SearchStartCodeFunc search)
+    {
+        if (!search)
+            return;
+        addWay(name);
+        m_searches.push_back(search);
+    }
+
+    std::vector<YamiMediaCodec::SearchStartCodeFunc> m_searches;
+};
+
+// Walks the markers of a JPEG picture, jumping over everything in between
+// with BitReader::skipBytes and with BitReader::skip, which reads all bits.
+class JPEGSkipRunner : public CompareRunner {
+public:
+    JPEGSkipRunner()
+        : CompareRunner("markers")
+    {
+        addWay("skipBytes");
+        addWay("skip");
+    }
+
+    void run(const uint8_t* data, size_t size)
+    {
+        start();
+        uint32_t markers = walk(data, size, true);
+        stop(0, markers, size);
+        start();
+        uint32_t readMarkers = walk(data, size, false);
+        stop(1, readMarkers, size);
+        record(markers == readMarkers, markers);
+    }
+
+private:
+    static uint32_t walk(const uint8_t* data, size_t size, bool skipBytes)
+    {
+        if (size < 2)
+            return 0;
+        BitReader reader(data, size);
+        const uint8_t* end = data + size - 1;
+        const uint8_t* current = data;
+        uint32_t markers = 0;
+        while (true) {
+            const uint8_t* match = std::find(current, end, 0xFF);
+            if (match == end)
+                break;
+            // skip to the marker byte after 0xFF
+            uint32_t bytes = match + 1 - (data + reader.getPos() / 8);
+            bool ok = skipBytes ? reader.skipBytes(bytes) : reader.skip(bytes << 3);
+            if (!ok)
+                break;
+            if (reader.read(8) < 0xFF)
+                markers++;
+            current = match + 2;
+            if (current >= end)
+                break;
+        }
+        return markers;
+    }
+};
+
+struct Codec {
+    const char* name;
+    ParserRunner* (*create)();
+};
+
+template <class T>
+ParserRunner* createRunner()
+{
+    return new T;
+}
+
+static const Codec g_codecs[] = {
+#ifdef __BUILD_H264_DECODER__
+    { "h264", createRunner<H264Runner> },
+#endif
+#ifdef __BUILD_H265_DECODER__
+    { "h265", createRunner<H265Runner> },
+#endif
+#ifdef __BUILD_MPEG2_DECODER__
+    { "mpeg2", createRunner<MPEG2Runner> },
+#endif
+#ifdef __BUILD_VC1_DECODER__
+    { "vc1", createRunner<VC1Runner> },
+#endif
+#ifdef __BUILD_VP8_DECODER__
+    { "vp8", createRunner<VP8Runner> },
+#endif
+#ifdef __BUILD_VP9_DECODER__
+    { "vp9", createRunner<VP9Runner> },
+#endif
+#if defined(__BUILD_JPEG_DECODER__) || defined(__BUILD_JPEG_ENCODER__)
+    { "jpeg", createRunner<JPEGRunner> },
+    { "jpeg-new", createRunner<JPEGNewRunner> },
+#endif
+    { "golomb", createRunner<GolombRunner> },
+    { "startcode", createRunner<StartCodeRunner> },
+    { "jpegskip", createRunner<JPEGSkipRunner> },
+    { NULL, NULL }
+};
+
+static const size_t g_numCodecs = N_ELEMENTS(g_codecs) - 1;
+
+} // namespace YamiParser
+
+using namespace YamiParser;
+
+#ifdef YAMI_PARSER_FUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    if (!size || !g_numCodecs)
+        return 0;
+    SharedPtr<ParserRunner> runner(g_codecs[data[0] % g_numCodecs].create());
+    runner->run(data + 1, size - 1);
+    return 0;
+}
+
+#else
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& buf)
+{
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp)
+        return false;
+    buf.clear();
+    uint8_t chunk[64 * 1024];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+        buf.insert(buf.end(), chunk, chunk + n);
+    bool ok = !ferror(fp);
+    fclose(fp);
+    return ok;
+}
+
+static void listInputs(const std::string& path, std::vector<std::string>& files)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) || !S_ISDIR(st.st_mode)) {
+        files.push_back(path);
+        return;
+    }
+    DIR* dir = opendir(path.c_str());
+    if (!dir)
+        return;
+    std::vector<std::string> entries;
+    struct dirent* entry;
+    while ((entry = readdir(dir))) {
+        if (entry->d_name[0] == '.')
+            continue;
+        std::string name = path + "/" + entry->d_name;
+        if (!stat(name.c_str(), &st) && S_ISREG(st.st_mode))
+            entries.push_back(name);
+    }
+    closedir(dir);
+    std::sort(entries.begin(), entries.end());
+    files.insert(files.end(), entries.begin(), entries.end());
+}
+
+static void usage(const char* app)
+{
+    fprintf(stderr, "usage: %s [-n loops] <codec> <file|dir>...\ncodecs:", app);
+    for (size_t i = 0; i < g_numCodecs; i++)
+        fprintf(stderr, " %s", g_codecs[i].name);
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char** argv)
+{
+    int arg = 1;
+    uint32_t loops = 1;
+    if (arg + 1 < argc && !strcmp(argv[arg], "-n")) {
+        loops = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if (arg + 1 >= argc || !loops) {
+        usage(argv[0]);
+        return -1;
+    }
+    const Codec* codec = NULL;
+    for (size_t i = 0; i < g_numCodecs; i++) {
+        if (!strcmp(argv[arg], g_codecs[i].name))
+            codec = &g_codecs[i];
+    }
+    if (!codec) {
+        usage(argv[0]);
+        return -1;
+    }
+
+    std::vector<std::string> files;
+    for (int i = arg + 1; i < argc; i++)
+        listInputs(argv[i], files);
+
+    SharedPtr<ParserRunner> runner(codec->create());
+    std::vector<uint8_t> buf;
+    uint64_t bytes = 0;
+    uint64_t inputs = 0;
+    double elapsed = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (!readFile(files[i], buf)) {
+            ERROR("failed to read %s", files[i].c_str());
+            return -1;
+        }
+        const uint8_t* data = buf.empty() ? NULL : &buf[0];
+        for (uint32_t n = 0; n < loops; n++) {
+            double start = now();
+            runner->reset();
+            runner->run(data, buf.size());
+            elapsed += now() - start;
+            bytes += buf.size();
+            inputs++;
+        }
+    }
+
+    if (elapsed <= 0)
+        elapsed = 1e-9;
+    printf("%s: %zu files, %llu bytes, %llu headers, %llu failures, digest %08x\n",
+        codec->name, files.size(), (unsigned long long)bytes,
+        (unsigned long long)runner->headers(),
+        (unsigned long long)runner->failures(), runner->digest());
+    printf("%s: %.3f s, %.0f headers/s, %.2f MB/s, %.1f us/input\n", codec->name,
+        elapsed, runner->headers() / elapsed, bytes / elapsed / (1024 * 1024),
+        inputs ? elapsed / inputs * 1e6 : 0);
+    runner->report(codec->name);
+    return 0;
+}
+
+#endif
@@ -21,6 +21,7 @@
 #include "vc1Parser.h"
 #include "common/log.h"
 #include "common/common_def.h"
+#include "common/startcode.h"
 #include <cstring>
 #include <cassert>
 
@@ -59,6 +60,14 @@
 namespace YamiParser {
 namespace VC1 {
 
+    /* bit of a plane in BitPlanes::packed */
+    static const int32_t PACKED_NONE = -1;
+    static const int32_t PACKED_DIRECTMB = 0;
+    static const int32_t PACKED_SKIPMB = 1;
+    static const int32_t PACKED_ACPRED = 1;
+    static const int32_t PACKED_MVTYPEMB = 2;
+    static const int32_t PACKED_OVERFLAGS = 2;
+
     /* Table 36: PQINDEX to PQUANT/Quantizer Translation*/
     static const uint8_t QuantizerTranslationTable[32] = {
         0, 1, 2, 3, 4, 5, 6, 7, 8, 6, 7, 8, 9, 10, 11, 12, 13, 14,
@@ -139,6 +148,42 @@ namespace VC1 {
         { (3 << 1) | 1, (5 + 1) }
     };
 
+    /* Norm6VLCTable indexed by the next NORM6_MAX_BITS bits of the stream,
+     * so a tile takes one peek instead of a search over 64 codes */
+    static const uint32_t NORM6_MAX_BITS = 13;
+
+    class Norm6Lookup {
+    public:
+        struct Entry {
+            uint8_t tile;
+            uint8_t length; /* 0 for invalid code */
+        };
+
+        Norm6Lookup()
+        {
+            memset(m_entries, 0, sizeof(m_entries));
+            for (uint32_t i = 0; i < N_ELEMENTS(Norm6VLCTable); i++) {
+                uint32_t shift = NORM6_MAX_BITS - Norm6VLCTable[i].codeLength;
+                uint32_t first = Norm6VLCTable[i].codeWord << shift;
+                for (uint32_t j = 0; j < (1u << shift); j++) {
+                    m_entries[first + j].tile = i;
+                    m_entries[first + j].length = Norm6VLCTable[i].codeLength;
+                }
+            }
+        }
+
+        const Entry& get(uint32_t bits) const { return m_entries[bits]; }
+
+    private:
+        Entry m_entries[1 << NORM6_MAX_BITS];
+    };
+
+    static const Norm6Lookup& getNorm6Lookup()
+    {
+        static const Norm6Lookup lookup;
+        return lookup;
+    }
+
     static const FrameType FrameTypeTable[2][8] = {
         {
             FRAME_I, FRAME_I, FRAME_P, FRAME_P,
@@ -227,9 +272,7 @@ namespace VC1 {
 
     int32_t Parser::searchStartCode(uint8_t* data, uint32_t size)
     {
-        uint8_t* pos;
-        const uint8_t startCode[] = { 0x00, 0x00, 0x01 };
-        pos = std::search(data, data + size, startCode, startCode + 3);
+        const uint8_t* pos = YamiMediaCodec::searchStartCode(data, data + size);
         return (pos == data + size) ? (-1) : (pos - data);
     }
 
@@ -441,6 +484,13 @@ namespace VC1 {
     void Parser::mallocBitPlanes()
     {
         uint32_t size = m_mbHeight * m_mbWidth;
+        uint32_t packedSize = (size + 1) >> 1;
+        if (m_bitPlanes.packed.size() == packedSize && m_bitPlanes.acpred.size() == size) {
+            if (packedSize)
+                memset(&m_bitPlanes.packed[0], 0, packedSize);
+            return;
+        }
+        m_bitPlanes.packed.assign(packedSize, 0);
         m_bitPlanes.acpred.resize(size);
         m_bitPlanes.fieldtx.resize(size);
         m_bitPlanes.overflags.resize(size);
@@ -548,6 +598,26 @@ namespace VC1 {
         return true;
     }
 
+    bool Parser::decodeNorm6Tile(BitReader* br, uint16_t& tile)
+    {
+        uint32_t bits;
+        uint64_t left = br->getRemainingBitsCount();
+        if (left >= NORM6_MAX_BITS) {
+            bits = br->peek(NORM6_MAX_BITS);
+        }
+        else {
+            bits = left ? br->peek(left) << (NORM6_MAX_BITS - left) : 0;
+        }
+        const Norm6Lookup::Entry& entry = getNorm6Lookup().get(bits);
+        if (!entry.length || entry.length > left) {
+            ERROR("invalid norm6 tile code");
+            return false;
+        }
+        SKIP(entry.length);
+        tile = entry.tile;
+        return true;
+    }
+
     bool Parser::decodeNorm6Mode(BitReader* br, uint8_t* data, uint32_t width, uint32_t height)
     {
         uint32_t i = 0, j = 0;
@@ -557,7 +627,7 @@ namespace VC1 {
         if (is2x3Tiled) {
             for (j = 0; j < height; j += 3) {
                 for (i = width & 1; i < width; i += 2) {
-                    if (!decodeVLCTable(br, &temp, Norm6VLCTable, 64))
+                    if (!decodeNorm6Tile(br, temp))
                         return false;
                     out[i] = temp & 1;
                     out[i + 1] = (temp & 2) >> 1;
@@ -575,7 +645,7 @@ namespace VC1 {
             out += (height & 1) * width;
             for (j = height & 1; j < height; j += 2) {
                 for (i = width % 3; i < width; i += 3) {
-                    if (!decodeVLCTable(br, &temp, Norm6VLCTable, 64))
+                    if (!decodeNorm6Tile(br, temp))
                         return false;
                     out[i] = temp & 1;
                     out[i + 1] = (temp & 2) >> 1;
@@ -615,7 +685,7 @@ namespace VC1 {
             }
     }
 
-    bool Parser::decodeBitPlane(BitReader* br, uint8_t* data, bool* isRaw)
+    bool Parser::decodeBitPlane(BitReader* br, uint8_t* data, bool* isRaw, int32_t packedBit)
     {
         uint32_t i, invert;
         uint16_t mode;
@@ -647,10 +717,19 @@ namespace VC1 {
         else if (mode == IMODE_COLSKIP) {
             decodeColskipMode(br, data, m_mbWidth, m_mbHeight);
         }
-        /*8.7.1 INVERT*/
-        if ((mode != IMODE_DIFF2) && (mode != IMODE_DIFF6) && invert) {
-            for (i = 0; i < m_mbWidth * m_mbHeight; i++)
-                data[i] = !data[i];
+        /*8.7.1 INVERT, diff modes have applied it*/
+        uint8_t flip = ((mode != IMODE_DIFF2) && (mode != IMODE_DIFF6)) ? invert : 0;
+        uint32_t size = m_mbWidth * m_mbHeight;
+        if (packedBit == PACKED_NONE || !size) {
+            for (i = 0; flip && i < size; i++)
+                data[i] ^= 1;
+            return true;
+        }
+        /* pack in the same pass, so the decoder can copy the plane as is */
+        uint8_t* packed = &m_bitPlanes.packed[0];
+        for (i = 0; i < size; i++) {
+            data[i] ^= flip;
+            packed[i >> 1] |= data[i] << (packedBit + ((i & 1) ? 0 : 4));
         }
         return true;
     }
@@ -847,10 +926,10 @@ namespace VC1 {
             if (m_frameHdr.mv_mode == MVMODE_MIXED_MV
                 || (m_frameHdr.mv_mode == MVMODE_INTENSITY_COMPENSATION
                        && m_frameHdr.mv_mode2 == MVMODE_MIXED_MV)) {
-                if (!decodeBitPlane(br, &m_bitPlanes.mvtypemb[0], &m_frameHdr.mv_type_mb))
+                if (!decodeBitPlane(br, &m_bitPlanes.mvtypemb[0], &m_frameHdr.mv_type_mb, PACKED_MVTYPEMB))
                     return false;
             }
-            if (!decodeBitPlane(br, &m_bitPlanes.skipmb[0], &m_frameHdr.skip_mb))
+            if (!decodeBitPlane(br, &m_bitPlanes.skipmb[0], &m_frameHdr.skip_mb, PACKED_SKIPMB))
                 return false;
 
             READ_BITS(m_frameHdr.mv_table, 2);
@@ -869,9 +948,9 @@ namespace VC1 {
         else if (m_frameHdr.picture_type == FRAME_B) {
             READ_BITS(m_frameHdr.mv_mode, 1);
             m_frameHdr.mv_mode = !(m_frameHdr.mv_mode);
-            if (!decodeBitPlane(br, &m_bitPlanes.directmb[0], &m_frameHdr.direct_mb))
+            if (!decodeBitPlane(br, &m_bitPlanes.directmb[0], &m_frameHdr.direct_mb, PACKED_DIRECTMB))
                 return false;
-            if (!decodeBitPlane(br, &m_bitPlanes.skipmb[0], &m_frameHdr.skip_mb))
+            if (!decodeBitPlane(br, &m_bitPlanes.skipmb[0], &m_frameHdr.skip_mb, PACKED_SKIPMB))
                 return false;
             READ_BITS(m_frameHdr.mv_table, 2);
             READ_BITS(m_frameHdr.cbp_table, 2);
@@ -996,16 +1075,16 @@ namespace VC1 {
         if ((m_frameHdr.picture_type == FRAME_I)
             || (m_frameHdr.picture_type == FRAME_BI)) {
             if (m_frameHdr.fcm == FRAME_INTERLACE) {
-                if (!decodeBitPlane(br, &m_bitPlanes.fieldtx[0], &m_frameHdr.fieldtx))
+                if (!decodeBitPlane(br, &m_bitPlanes.fieldtx[0], &m_frameHdr.fieldtx, PACKED_NONE))
                     return false;
             }
-            if (!decodeBitPlane(br, &m_bitPlanes.acpred[0], &m_frameHdr.ac_pred))
+            if (!decodeBitPlane(br, &m_bitPlanes.acpred[0], &m_frameHdr.ac_pred, PACKED_ACPRED))
                 return false;
 
             if ((m_entryPointHdr.overlap) && m_frameHdr.pquant <= 8) {
                 m_frameHdr.condover = getFirst01Bit(br, 0, 2);
                 if (m_frameHdr.condover == 2) {
-                    if (!decodeBitPlane(br, &m_bitPlanes.overflags[0], &m_frameHdr.overflags))
+                    if (!decodeBitPlane(br, &m_bitPlanes.overflags[0], &m_frameHdr.overflags, PACKED_OVERFLAGS))
                         return false;
                 }
             }
@@ -1057,14 +1136,14 @@ namespace VC1 {
                     if (m_frameHdr.mv_mode == MVMODE_MIXED_MV
                         || (m_frameHdr.mv_mode == MVMODE_INTENSITY_COMPENSATION
                                && m_frameHdr.mv_mode2 == MVMODE_MIXED_MV)) {
-                        if (!decodeBitPlane(br, &m_bitPlanes.mvtypemb[0], &m_frameHdr.mv_type_mb))
+                        if (!decodeBitPlane(br, &m_bitPlanes.mvtypemb[0], &m_frameHdr.mv_type_mb, PACKED_MVTYPEMB))
                             return false;
                     }
                 }
             }
 
             if (m_frameHdr.fcm != FIELD_INTERLACE) {
-                if (!decodeBitPlane(br, &m_bitPlanes.skipmb[0], &m_frameHdr.skip_mb))
+                if (!decodeBitPlane(br, &m_bitPlanes.skipmb[0], &m_frameHdr.skip_mb, PACKED_SKIPMB))
                     return false;
             }
 
@@ -1111,13 +1190,13 @@ namespace VC1 {
                 m_frameHdr.mv_mode = !(m_frameHdr.mv_mode);
             }
             if (m_frameHdr.fcm == FIELD_INTERLACE) {
-                if (!decodeBitPlane(br, &m_bitPlanes.forwardmb[0], &m_frameHdr.forwardmb))
+                if (!decodeBitPlane(br, &m_bitPlanes.forwardmb[0], &m_frameHdr.forwardmb, PACKED_NONE))
                     return false;
             }
             else {
-                if (!decodeBitPlane(br, &m_bitPlanes.directmb[0], &m_frameHdr.direct_mb))
+                if (!decodeBitPlane(br, &m_bitPlanes.directmb[0], &m_frameHdr.direct_mb, PACKED_DIRECTMB))
                     return false;
-                if (!decodeBitPlane(br, &m_bitPlanes.skipmb[0], &m_frameHdr.skip_mb))
+                if (!decodeBitPlane(br, &m_bitPlanes.skipmb[0], &m_frameHdr.skip_mb, PACKED_SKIPMB))
                     return false;
             }
             if (m_frameHdr.fcm != PROGRESSIVE) {
@@ -153,6 +153,10 @@ namespace VC1 {
         std::vector<uint8_t> skipmb;
         std::vector<uint8_t> directmb;
         std::vector<uint8_t> forwardmb;
+        /* planes used by the VA bitplane buffer, in its layout: one nibble
+         * per macroblock, first macroblock in the high nibble. Bit 0 is
+         * directmb, bit 1 skipmb or acpred, bit 2 mvtypemb or overflags */
+        std::vector<uint8_t> packed;
     };
 
     struct FrameHdr {
@@ -263,7 +267,8 @@ namespace VC1 {
         bool decodeColskipMode(BitReader*, uint8_t*, uint32_t, uint32_t);
         bool decodeNorm2Mode(BitReader*, uint8_t*, uint32_t, uint32_t);
         bool decodeNorm6Mode(BitReader*, uint8_t*, uint32_t, uint32_t);
-        bool decodeBitPlane(BitReader*, uint8_t*, bool*);
+        bool decodeNorm6Tile(BitReader*, uint16_t&);
+        bool decodeBitPlane(BitReader*, uint8_t*, bool*, int32_t packedBit);
         void inverseDiff(uint8_t*, uint32_t, uint32_t, uint32_t);
         bool parseVopdquant(BitReader*, uint8_t);
         bool parseSequenceHeader(const uint8_t*, uint32_t);
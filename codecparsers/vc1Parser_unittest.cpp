@@ -663,5 +663,38 @@ namespace VC1 {
         checkParamsFrameHeader(parser);
     }
 
+    VC1_PARSER_TEST(ParseNorm6BitPlane)
+    {
+        Parser parser;
+        uint8_t* data = const_cast<uint8_t*>(SequenceHeader.data());
+        uint32_t size = SequenceHeader.size();
+        ASSERT_TRUE(parser.parseCodecData(data, size));
+        //3x2 macroblocks, one 3x2 tile
+        parser.m_seqHdr.coded_width = 48;
+        parser.m_seqHdr.coded_height = 32;
+
+        //main profile P frame, 1MV, skipmb coded with norm-6 tile 37
+        uint8_t frame[] = { 0x14, 0xd8, 0x8a, 0x00, 0x00, 0x00 };
+        data = frame;
+        size = sizeof(frame);
+        ASSERT_TRUE(parser.parseFrameHeader(data, size));
+        EXPECT_EQ(FRAME_P, parser.m_frameHdr.picture_type);
+        EXPECT_FALSE(parser.m_frameHdr.skip_mb);
+        const uint8_t skipmb[] = { 1, 0, 1, 0, 0, 1 };
+        EXPECT_EQ(0, memcmp(skipmb, &parser.m_bitPlanes.skipmb[0], sizeof(skipmb)));
+        //skipmb is bit 1 of the packed nibbles
+        const uint8_t packed[] = { 0x20, 0x20, 0x02 };
+        ASSERT_EQ(sizeof(packed), parser.m_bitPlanes.packed.size());
+        EXPECT_EQ(0, memcmp(packed, &parser.m_bitPlanes.packed[0], sizeof(packed)));
+
+        //same tile with INVERT, packed plane of last frame is cleared
+        frame[1] = 0xf8;
+        data = frame;
+        size = sizeof(frame);
+        ASSERT_TRUE(parser.parseFrameHeader(data, size));
+        const uint8_t inverted[] = { 0x02, 0x02, 0x20 };
+        EXPECT_EQ(0, memcmp(inverted, &parser.m_bitPlanes.packed[0], sizeof(inverted)));
+    }
+
 } // namespace VC1
 } // namespace YamiParser
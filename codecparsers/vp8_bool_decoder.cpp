@@ -81,8 +81,7 @@ namespace YamiParser {
 
 #define CHAR_BIT 8
 
-#define VP8_BD_VALUE_BIT \
-  static_cast<int>(sizeof(Vp8BoolDecoder::value_) * CHAR_BIT)
+#define VP8_BD_VALUE_BIT static_cast<int>(sizeof(uint64_t) * CHAR_BIT)
 
 static const int kDefaultProbability = 0x80;  // 0x80 / 256 = 0.5
 
@@ -111,6 +110,40 @@ static const unsigned char kVp8Norm[256] = {
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 };
 
+// Decodes one bool from the window, the window must hold at least 8 bits,
+// i.e. |count| is not negative.
+static inline int DecodeBit(uint64_t& value, int& count, size_t& range,
+                            int probability) {
+  int bit = 0;
+  size_t split = 1 + (((range - 1) * probability) >> 8);
+  uint64_t bigsplit = static_cast<uint64_t>(split) << (VP8_BD_VALUE_BIT - 8);
+
+  if (value >= bigsplit) {
+    range -= split;
+    value -= bigsplit;
+    bit = 1;
+  } else {
+    range = split;
+  }
+
+  // A table lookup measured faster than clz on x86-64 without lzcnt.
+  int shift = kVp8Norm[range];
+  range <<= shift;
+  value <<= shift;
+  count -= shift;
+
+  //DCHECK_EQ(1U, (range >> 7));  // In the range [128, 255].
+
+  return bit;
+}
+
+static inline uint64_t LoadBigEndian64(const uint8_t* p) {
+  uint64_t v = 0;
+  for (size_t i = 0; i < sizeof(v); ++i)
+    v = (v << CHAR_BIT) | p[i];
+  return v;
+}
+
 Vp8BoolDecoder::Vp8BoolDecoder()
     : user_buffer_(NULL),
       user_buffer_end_(NULL),
@@ -135,6 +168,18 @@ void Vp8BoolDecoder::FillDecoder() {
   // DCHECK(user_buffer_ != NULL);
   int shift = VP8_BD_VALUE_BIT - CHAR_BIT - (count_ + CHAR_BIT);
   size_t bytes_left = user_buffer_end_ - user_buffer_;
+
+  // More than a window left, load all whole bytes fitting in the window
+  // with one read. The last one goes to bit |shift| & 7, like the loop below.
+  if (bytes_left > sizeof(value_)) {
+    int bytes = (shift >> 3) + 1;
+    uint64_t next = LoadBigEndian64(user_buffer_);
+    value_ |= (next >> ((sizeof(value_) - bytes) * CHAR_BIT)) << (shift & 7);
+    user_buffer_ += bytes;
+    count_ += bytes * CHAR_BIT;
+    return;
+  }
+
   size_t bits_left = bytes_left * CHAR_BIT;
   int x = static_cast<int>(shift + CHAR_BIT - bits_left);
   int loop_end = 0;
@@ -147,7 +192,7 @@ void Vp8BoolDecoder::FillDecoder() {
   if (x < 0 || bits_left) {
     while (shift >= loop_end) {
       count_ += CHAR_BIT;
-      value_ |= static_cast<size_t>(*user_buffer_) << shift;
+      value_ |= static_cast<uint64_t>(*user_buffer_) << shift;
       ++user_buffer_;
       shift -= CHAR_BIT;
     }
@@ -155,28 +200,9 @@ void Vp8BoolDecoder::FillDecoder() {
 }
 
 int Vp8BoolDecoder::ReadBit(int probability) {
-  int bit = 0;
-  size_t split = 1 + (((range_ - 1) * probability) >> 8);
   if (count_ < 0)
     FillDecoder();
-  size_t bigsplit = static_cast<size_t>(split) << (VP8_BD_VALUE_BIT - 8);
-
-  if (value_ >= bigsplit) {
-    range_ -= split;
-    value_ -= bigsplit;
-    bit = 1;
-  } else {
-    range_ = split;
-  }
-
-  size_t shift = kVp8Norm[range_];
-  range_ <<= shift;
-  value_ <<= shift;
-  count_ -= shift;
-
-  //DCHECK_EQ(1U, (range_ >> 7));  // In the range [128, 255].
-
-  return bit;
+  return DecodeBit(value_, count_, range_, probability);
 }
 
 bool Vp8BoolDecoder::ReadLiteral(size_t num_bits, int* out) {
@@ -204,6 +230,42 @@ bool Vp8BoolDecoder::ReadLiteralWithSign(size_t num_bits, int* out) {
   return !OutOfBuffer();
 }
 
+bool Vp8BoolDecoder::ReadProbUpdates(const uint8_t* update_probs,
+                                     uint8_t* probs, size_t count) {
+  // |probs| may alias anything, keep the state out of |this| in the loop.
+  uint64_t value = value_;
+  int bits = count_;
+  size_t range = range_;
+#define FILL_LOCAL_STATE() \
+  do {                     \
+    if (bits < 0) {        \
+      value_ = value;      \
+      count_ = bits;       \
+      FillDecoder();       \
+      value = value_;      \
+      bits = count_;       \
+    }                      \
+  } while (0)
+
+  for (size_t i = 0; i < count; ++i) {
+    FILL_LOCAL_STATE();
+    if (!DecodeBit(value, bits, range, update_probs[i]))
+      continue;
+    int prob = 0;
+    for (int j = 0; j < CHAR_BIT; ++j) {
+      FILL_LOCAL_STATE();
+      prob = (prob << 1) | DecodeBit(value, bits, range, kDefaultProbability);
+    }
+    probs[i] = prob;
+  }
+#undef FILL_LOCAL_STATE
+
+  value_ = value;
+  count_ = bits;
+  range_ = range;
+  return !OutOfBuffer();
+}
+
 size_t Vp8BoolDecoder::BitOffset() {
   int bit_count = count_ + 8;
   if (bit_count > VP8_BD_VALUE_BIT)
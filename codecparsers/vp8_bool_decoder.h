@@ -115,6 +115,14 @@ class Vp8BoolDecoder {
   // This is different from the "read_signed_literal(d, n)" defined in RFC 6386.
   bool ReadLiteralWithSign(size_t num_bits, int* out);
 
+  // Reads |count| probability updates: for each i, a flag coded with
+  // |update_probs[i]| and, if the flag is set, an 8-bit literal that replaces
+  // |probs[i]|. This is the layout of the DCT token probability updates, the
+  // loop keeps the decoder state in locals instead of calling ReadBool()
+  // for each of the 1056 flags. Returns false if it ran out of data.
+  bool ReadProbUpdates(const uint8_t* update_probs, uint8_t* probs,
+                       size_t count);
+
   // The following methods are used to get the internal states of the decoder.
 
   // Returns the bit offset to the current top bit of the coded stream. It is
@@ -151,7 +159,8 @@ class Vp8BoolDecoder {
   const uint8_t* user_buffer_;
   const uint8_t* user_buffer_start_;
   const uint8_t* user_buffer_end_;
-  size_t value_;
+  // 64 bits window on all platforms, FillDecoder() loads 7 bytes at a time.
+  uint64_t value_;
   int count_;
   size_t range_;
 
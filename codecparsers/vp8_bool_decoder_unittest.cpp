@@ -158,4 +158,43 @@ TEST_F(Vp8BoolDecoderTest, DecodeBoolsWithParitiesAndIncreasingProbabilities) {
   }
 }
 
+TEST_F(Vp8BoolDecoderTest, ReadProbUpdatesMatchesReadBool) {
+  uint8_t data[1024];
+  uint8_t update_probs[300];
+  uint32_t seed = 1;
+  for (size_t i = 0; i < sizeof(data); ++i) {
+    seed = seed * 1103515245 + 12345;
+    data[i] = seed >> 24;
+  }
+  for (size_t i = 0; i < sizeof(update_probs); ++i)
+    update_probs[i] = static_cast<uint8_t>(i * 37 + 1);
+
+  uint8_t expected[sizeof(update_probs)];
+  memset(expected, 0x55, sizeof(expected));
+  Vp8BoolDecoder ref;
+  ASSERT_TRUE(ref.Initialize(data, sizeof(data)));
+  for (size_t i = 0; i < sizeof(update_probs); ++i) {
+    bool update;
+    ASSERT_TRUE(ref.ReadBool(&update, update_probs[i]));
+    int prob;
+    if (update) {
+      ASSERT_TRUE(ref.ReadLiteral(8, &prob));
+      expected[i] = prob;
+    }
+  }
+
+  uint8_t probs[sizeof(update_probs)];
+  memset(probs, 0x55, sizeof(probs));
+  INITIALIZE(data);
+  ASSERT_TRUE(bd_.ReadProbUpdates(update_probs, probs, sizeof(probs)));
+  EXPECT_EQ(0, memcmp(expected, probs, sizeof(probs)));
+  EXPECT_EQ(ref.BitOffset(), bd_.BitOffset());
+  EXPECT_EQ(ref.GetRange(), bd_.GetRange());
+  EXPECT_EQ(ref.GetBottom(), bd_.GetBottom());
+
+  //not enough data for all updates
+  INITIALIZE(kDataOnesAndEvenProbabilities);
+  EXPECT_FALSE(bd_.ReadProbUpdates(update_probs, probs, sizeof(probs)));
+}
+
 }  // namespace YamiParser
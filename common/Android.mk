@@ -13,6 +13,8 @@ LOCAL_SRC_FILES := \
         log.cpp \
         utils.cpp \
         nalreader.cpp \
+        startcode.cpp \
+        ImageCopy.cpp \
         surfacepool.cpp \
         PooledFrameAllocator.cpp \
         YamiVersion.cpp \
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef freelist_h
+#define freelist_h
+
+#include "VideoCommonDefs.h"
+#include "common/NonCopyable.h"
+#include "common/lock.h"
+
+#include <map>
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+/**
+ * \class FreeList
+ * \brief keeps released memory blocks, grouped by size, for later allocations.
+ * Blocks are only returned to heap when the free list is destroyed,
+ * so objects created and released at a steady rate do not touch the heap.
+ */
+class FreeList {
+public:
+    FreeList()
+        : m_heapAllocs(0)
+    {
+    }
+
+    ~FreeList()
+    {
+        Blocks::iterator it;
+        for (it = m_blocks.begin(); it != m_blocks.end(); ++it) {
+            for (size_t i = 0; i < it->second.size(); i++)
+                free(it->second[i]);
+        }
+    }
+
+    void* alloc(size_t size)
+    {
+        AutoLock lock(m_lock);
+        std::vector<void*>& blocks = m_blocks[size];
+        if (!blocks.empty()) {
+            void* p = blocks.back();
+            blocks.pop_back();
+            return p;
+        }
+        m_heapAllocs++;
+        //reserve for recycle, so recycle will not allocate memory
+        blocks.reserve(m_heapAllocs);
+        return malloc(size);
+    }
+
+    void recycle(void* p, size_t size)
+    {
+        AutoLock lock(m_lock);
+        m_blocks[size].push_back(p);
+    }
+
+    //how many blocks we allocated from heap
+    uint32_t getHeapAllocs()
+    {
+        AutoLock lock(m_lock);
+        return m_heapAllocs;
+    }
+
+private:
+    typedef std::map<size_t, std::vector<void*> > Blocks;
+    Lock m_lock;
+    Blocks m_blocks;
+    uint32_t m_heapAllocs;
+    DISALLOW_COPY_AND_ASSIGN(FreeList);
+};
+
+typedef SharedPtr<FreeList> FreeListPtr;
+
+#if __cplusplus > 199711L
+/* std allocator on top of FreeList, used with std::allocate_shared,
+ * so the object and shared pointer's control block come from one block */
+template <class T>
+class FreeListAllocator {
+public:
+    typedef T value_type;
+
+    FreeListAllocator(const FreeListPtr& list)
+        : m_list(list)
+    {
+    }
+
+    template <class U>
+    FreeListAllocator(const FreeListAllocator<U>& other)
+        : m_list(other.m_list)
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        void* p = m_list->alloc(n * sizeof(T));
+        if (!p)
+            throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        m_list->recycle(p, n * sizeof(T));
+    }
+
+    template <class U>
+    bool operator==(const FreeListAllocator<U>& other) const
+    {
+        return m_list == other.m_list;
+    }
+
+    template <class U>
+    bool operator!=(const FreeListAllocator<U>& other) const
+    {
+        return m_list != other.m_list;
+    }
+
+    FreeListPtr m_list;
+};
+
+template <class T, class... Args>
+SharedPtr<T> allocShared(const FreeListPtr& list, const Args&... args)
+{
+    return std::allocate_shared<T>(FreeListAllocator<T>(list), args...);
+}
+#else
+//no allocate_shared in tr1, fallback to heap
+template <class T>
+SharedPtr<T> allocShared(const FreeListPtr&)
+{
+    return SharedPtr<T>(new T());
+}
+
+template <class T, class A1, class A2, class A3>
+SharedPtr<T> allocShared(const FreeListPtr&, const A1& a1, const A2& a2, const A3& a3)
+{
+    return SharedPtr<T>(new T(a1, a2, a3));
+}
+#endif
+
+} //namespace YamiMediaCodec
+
+#endif //freelist_h
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// primary header
+#include "FreeList.h"
+
+// library headers
+#include "common/unittest.h"
+
+// system headers
+#include <deque>
+
+namespace YamiMediaCodec {
+
+#define FREELIST_TEST(name) \
+    TEST(FreeListTest, name)
+
+struct Object {
+    Object(int a, int b, int c)
+        : sum(a + b + c)
+    {
+        s_live++;
+    }
+    ~Object() { s_live--; }
+    int sum;
+    uint8_t payload[1024];
+    static int s_live;
+};
+
+int Object::s_live = 0;
+
+FREELIST_TEST(Recycle)
+{
+    FreeList list;
+    void* p = list.alloc(16);
+    ASSERT_TRUE(p);
+    list.recycle(p, 16);
+    EXPECT_EQ(p, list.alloc(16));
+    EXPECT_EQ(1u, list.getHeapAllocs());
+
+    //different size will not share block
+    void* q = list.alloc(32);
+    EXPECT_NE(p, q);
+    EXPECT_EQ(2u, list.getHeapAllocs());
+    list.recycle(p, 16);
+    list.recycle(q, 32);
+}
+
+FREELIST_TEST(SteadyState)
+{
+    FreeListPtr list(new FreeList);
+    std::deque<SharedPtr<Object> > objects;
+    const size_t depth = 16;
+    for (int i = 0; i < 1000; i++) {
+        SharedPtr<Object> obj = allocShared<Object>(list, i, 1, 2);
+        ASSERT_TRUE(bool(obj));
+        EXPECT_EQ(i + 3, obj->sum);
+        objects.push_back(obj);
+        if (objects.size() > depth)
+            objects.pop_front();
+    }
+#if __cplusplus > 199711L
+    //we only allocate when all freed blocks are in use
+    EXPECT_EQ(depth + 1, list->getHeapAllocs());
+#endif
+    objects.clear();
+    EXPECT_EQ(0, Object::s_live);
+}
+
+FREELIST_TEST(OutliveList)
+{
+    SharedPtr<Object> obj;
+    {
+        FreeListPtr list(new FreeList);
+        obj = allocShared<Object>(list, 1, 2, 3);
+    }
+    EXPECT_EQ(6, obj->sum);
+    obj.reset();
+    EXPECT_EQ(0, Object::s_live);
+}
+
+}
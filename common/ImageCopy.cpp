@@ -0,0 +1,354 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "ImageCopy.h"
+
+#include "common/Functional.h"
+#include "common/Thread.h"
+#include "common/log.h"
+
+#include <string.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace YamiMediaCodec {
+
+//frames larger than this are split to row bands and copied in parallel
+static const uint32_t MT_PIXELS_THRESHOLD = 2560 * 1440;
+//large frames will not stay in cache, bypass it with non-temporal stores
+static const uint32_t STREAM_PIXELS_THRESHOLD = 1280 * 720;
+static const uint32_t MAX_COPY_THREADS = 4;
+
+struct CopyTask {
+    uint8_t* dest;
+    const ImageLayout* destLayout;
+    const uint8_t* src;
+    const ImageLayout* srcLayout;
+    uint32_t width;
+    uint32_t height;
+    bool stream;
+    //byte width and rows of each source plane
+    uint32_t bytes[3];
+    uint32_t rows[3];
+    uint32_t planes;
+};
+
+static inline bool isAligned(const void* p)
+{
+    return !((uintptr_t)p & 15);
+}
+
+#ifdef __SSE2__
+static inline void store(uint8_t* p, __m128i v, bool stream)
+{
+    if (stream)
+        _mm_stream_si128((__m128i*)p, v);
+    else
+        _mm_storeu_si128((__m128i*)p, v);
+}
+#endif
+
+static void copyRow(uint8_t* dest, const uint8_t* src, uint32_t bytes, bool stream)
+{
+    uint32_t x = 0;
+#ifdef __SSE2__
+    if (stream && isAligned(dest)) {
+        for (; x + 64 <= bytes; x += 64) {
+            __m128i v0 = _mm_loadu_si128((const __m128i*)(src + x));
+            __m128i v1 = _mm_loadu_si128((const __m128i*)(src + x + 16));
+            __m128i v2 = _mm_loadu_si128((const __m128i*)(src + x + 32));
+            __m128i v3 = _mm_loadu_si128((const __m128i*)(src + x + 48));
+            _mm_stream_si128((__m128i*)(dest + x), v0);
+            _mm_stream_si128((__m128i*)(dest + x + 16), v1);
+            _mm_stream_si128((__m128i*)(dest + x + 32), v2);
+            _mm_stream_si128((__m128i*)(dest + x + 48), v3);
+        }
+    }
+#endif
+    memcpy(dest + x, src + x, bytes - x);
+}
+
+//dest is uv interleaved row, w is the width of u or v
+static void interleaveRow(uint8_t* dest, const uint8_t* u, const uint8_t* v,
+    uint32_t w, bool stream)
+{
+    uint32_t x = 0;
+#ifdef __SSE2__
+    stream = stream && isAligned(dest);
+    for (; x + 16 <= w; x += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(u + x));
+        __m128i b = _mm_loadu_si128((const __m128i*)(v + x));
+        store(dest + 2 * x, _mm_unpacklo_epi8(a, b), stream);
+        store(dest + 2 * x + 16, _mm_unpackhi_epi8(a, b), stream);
+    }
+#endif
+    for (; x < w; x++) {
+        dest[2 * x] = u[x];
+        dest[2 * x + 1] = v[x];
+    }
+}
+
+//convert two yuy2 rows to two y rows and one uv row, chroma is averaged.
+//for last odd row, src1 == src0 and y1 is NULL
+static void yuy2Rows(uint8_t* y0, uint8_t* y1, uint8_t* uv,
+    const uint8_t* src0, const uint8_t* src1, uint32_t w, bool stream)
+{
+    uint32_t x = 0;
+#ifdef __SSE2__
+    stream = stream && isAligned(y0) && (!y1 || isAligned(y1)) && isAligned(uv);
+    const __m128i mask = _mm_set1_epi16(0xff);
+    for (; x + 16 <= w; x += 16) {
+        __m128i a0 = _mm_loadu_si128((const __m128i*)(src0 + 2 * x));
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(src0 + 2 * x + 16));
+        __m128i a1 = _mm_loadu_si128((const __m128i*)(src1 + 2 * x));
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(src1 + 2 * x + 16));
+        store(y0 + x, _mm_packus_epi16(_mm_and_si128(a0, mask), _mm_and_si128(b0, mask)), stream);
+        if (y1)
+            store(y1 + x, _mm_packus_epi16(_mm_and_si128(a1, mask), _mm_and_si128(b1, mask)), stream);
+        __m128i c0 = _mm_packus_epi16(_mm_srli_epi16(a0, 8), _mm_srli_epi16(b0, 8));
+        __m128i c1 = _mm_packus_epi16(_mm_srli_epi16(a1, 8), _mm_srli_epi16(b1, 8));
+        store(uv + x, _mm_avg_epu8(c0, c1), stream);
+    }
+#endif
+    //yuy2 always stores the whole macro pixel, even for odd width
+    for (; x < w; x += 2) {
+        const uint8_t* p0 = src0 + 2 * x;
+        const uint8_t* p1 = src1 + 2 * x;
+        y0[x] = p0[0];
+        if (y1)
+            y1[x] = p1[0];
+        if (x + 1 < w) {
+            y0[x + 1] = p0[2];
+            if (y1)
+                y1[x + 1] = p1[2];
+        }
+        uv[x] = (p0[1] + p1[1] + 1) >> 1;
+        uv[x + 1] = (p0[3] + p1[3] + 1) >> 1;
+    }
+}
+
+//byte width and rows for each plane
+static bool getLayout(uint32_t fourcc, uint32_t w, uint32_t h,
+    uint32_t bytes[3], uint32_t rows[3], uint32_t& planes)
+{
+    uint32_t cw = (w + 1) >> 1;
+    uint32_t ch = (h + 1) >> 1;
+    switch (fourcc) {
+    case YAMI_FOURCC_NV12:
+        bytes[0] = w;
+        bytes[1] = cw * 2;
+        planes = 2;
+        break;
+    case YAMI_FOURCC_P010:
+        bytes[0] = w * 2;
+        bytes[1] = cw * 4;
+        planes = 2;
+        break;
+    case YAMI_FOURCC_I420:
+    case YAMI_FOURCC_YV12:
+        bytes[0] = w;
+        bytes[1] = bytes[2] = cw;
+        planes = 3;
+        break;
+    case YAMI_FOURCC_YUY2:
+        bytes[0] = cw * 4;
+        rows[0] = h;
+        planes = 1;
+        return true;
+    default:
+        return false;
+    }
+    rows[0] = h;
+    rows[1] = rows[2] = ch;
+    return true;
+}
+
+//first row of a plane for luma row y, y is even or equal to height
+static inline uint32_t planeRow(uint32_t y, uint32_t rows, uint32_t height)
+{
+    return rows == height ? y : (y + 1) >> 1;
+}
+
+static void copyPlanes(const CopyTask* task, uint32_t y0, uint32_t y1)
+{
+    const ImageLayout& d = *task->destLayout;
+    const ImageLayout& s = *task->srcLayout;
+    for (uint32_t i = 0; i < task->planes; i++) {
+        uint32_t start = planeRow(y0, task->rows[i], task->height);
+        uint32_t end = planeRow(y1, task->rows[i], task->height);
+        for (uint32_t r = start; r < end; r++) {
+            copyRow(task->dest + d.offsets[i] + r * d.pitches[i],
+                task->src + s.offsets[i] + r * s.pitches[i], task->bytes[i], task->stream);
+        }
+    }
+}
+
+static void i420ToNv12(const CopyTask* task, uint32_t y0, uint32_t y1)
+{
+    const ImageLayout& d = *task->destLayout;
+    const ImageLayout& s = *task->srcLayout;
+    uint32_t w = task->width;
+    for (uint32_t r = y0; r < y1; r++) {
+        copyRow(task->dest + d.offsets[0] + r * d.pitches[0],
+            task->src + s.offsets[0] + r * s.pitches[0], w, task->stream);
+    }
+    //yv12 has v plane before u plane
+    uint32_t u = s.fourcc == YAMI_FOURCC_YV12 ? 2 : 1;
+    uint32_t v = 3 - u;
+    for (uint32_t r = y0 >> 1; r < (y1 + 1) >> 1; r++) {
+        interleaveRow(task->dest + d.offsets[1] + r * d.pitches[1],
+            task->src + s.offsets[u] + r * s.pitches[u],
+            task->src + s.offsets[v] + r * s.pitches[v],
+            (w + 1) >> 1, task->stream);
+    }
+}
+
+static void yuy2ToNv12(const CopyTask* task, uint32_t y0, uint32_t y1)
+{
+    const ImageLayout& d = *task->destLayout;
+    const ImageLayout& s = *task->srcLayout;
+    for (uint32_t r = y0; r < y1; r += 2) {
+        const uint8_t* src0 = task->src + s.offsets[0] + r * s.pitches[0];
+        bool hasNext = r + 1 < y1;
+        yuy2Rows(task->dest + d.offsets[0] + r * d.pitches[0],
+            hasNext ? task->dest + d.offsets[0] + (r + 1) * d.pitches[0] : NULL,
+            task->dest + d.offsets[1] + (r >> 1) * d.pitches[1],
+            src0, hasNext ? src0 + s.pitches[0] : src0,
+            task->width, task->stream);
+    }
+}
+
+static void copyBand(const CopyTask* task, uint32_t y0, uint32_t y1)
+{
+    uint32_t src = task->srcLayout->fourcc;
+    uint32_t dest = task->destLayout->fourcc;
+    if (src == dest)
+        copyPlanes(task, y0, y1);
+    else if (src == YAMI_FOURCC_YUY2)
+        yuy2ToNv12(task, y0, y1);
+    else
+        i420ToNv12(task, y0, y1);
+#ifdef __SSE2__
+    //make non-temporal stores visible before we tell others we are done
+    if (task->stream)
+        _mm_sfence();
+#endif
+}
+
+static void waitDone()
+{
+}
+
+ImageCopier::ImageCopier()
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    m_maxThreads = cpus > 0 ? (uint32_t)cpus : 1;
+    if (m_maxThreads > MAX_COPY_THREADS)
+        m_maxThreads = MAX_COPY_THREADS;
+}
+
+ImageCopier::~ImageCopier()
+{
+    for (size_t i = 0; i < m_threads.size(); i++) {
+        m_threads[i]->stop();
+        delete m_threads[i];
+    }
+}
+
+uint32_t ImageCopier::getDestFourcc(uint32_t srcFourcc)
+{
+    if (srcFourcc == YAMI_FOURCC_I420 || srcFourcc == YAMI_FOURCC_YV12
+        || srcFourcc == YAMI_FOURCC_YUY2)
+        return YAMI_FOURCC_NV12;
+    return srcFourcc;
+}
+
+bool ImageCopier::isSupported(uint32_t srcFourcc, uint32_t destFourcc)
+{
+    uint32_t bytes[3], rows[3], planes;
+    if (!getLayout(srcFourcc, 1, 1, bytes, rows, planes))
+        return false;
+    return srcFourcc == destFourcc || getDestFourcc(srcFourcc) == destFourcc;
+}
+
+void ImageCopier::setThreads(uint32_t threads)
+{
+    m_maxThreads = threads ? threads : 1;
+}
+
+uint32_t ImageCopier::getThreads(uint32_t width, uint32_t height)
+{
+    if (width * height < MT_PIXELS_THRESHOLD)
+        return 1;
+    while (m_threads.size() + 1 < m_maxThreads) {
+        Thread* thread = new Thread("yami-copy");
+        if (!thread->start()) {
+            ERROR("failed to start copy thread");
+            delete thread;
+            break;
+        }
+        m_threads.push_back(thread);
+    }
+    return m_threads.size() + 1 < m_maxThreads ? m_threads.size() + 1 : m_maxThreads;
+}
+
+bool ImageCopier::copy(uint8_t* dest, const ImageLayout& destLayout,
+    const uint8_t* src, const ImageLayout& srcLayout,
+    uint32_t width, uint32_t height)
+{
+    if (!isSupported(srcLayout.fourcc, destLayout.fourcc)) {
+        ERROR("can't copy %.4s to %.4s", (char*)&srcLayout.fourcc, (char*)&destLayout.fourcc);
+        return false;
+    }
+    CopyTask task;
+    task.dest = dest;
+    task.destLayout = &destLayout;
+    task.src = src;
+    task.srcLayout = &srcLayout;
+    task.width = width;
+    task.height = height;
+    task.stream = width * height >= STREAM_PIXELS_THRESHOLD;
+    if (!getLayout(srcLayout.fourcc, width, height, task.bytes, task.rows, task.planes)) {
+        ERROR("unknown layout of %.4s", (char*)&srcLayout.fourcc);
+        return false;
+    }
+
+    uint32_t threads = getThreads(width, height);
+    if (threads <= 1) {
+        copyBand(&task, 0, height);
+        return true;
+    }
+
+    //even band size, so a band never splits a chroma row
+    uint32_t band = (((height + threads - 1) / threads) + 1) & ~1;
+    uint32_t y = 0;
+    uint32_t posted = 0;
+    for (; posted < threads - 1 && y + band < height; posted++) {
+        m_threads[posted]->post(std::bind(copyBand, &task, y, y + band));
+        y += band;
+    }
+    copyBand(&task, y, height);
+    for (uint32_t i = 0; i < posted; i++)
+        m_threads[i]->send(waitDone);
+    return true;
+}
+}
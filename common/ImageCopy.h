@@ -0,0 +1,70 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ImageCopy_h
+#define ImageCopy_h
+
+#include "VideoCommonDefs.h"
+#include "common/NonCopyable.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+class Thread;
+
+/* plane layout of an image, same as VAImage's offsets and pitches */
+struct ImageLayout {
+    uint32_t fourcc;
+    uint32_t offsets[3];
+    uint32_t pitches[3];
+};
+
+/**
+ * \class ImageCopier
+ * \brief copy raw images into mapped surfaces, converting to NV12 on the fly.
+ * Supported: NV12, P010, I420, YV12 and YUY2 to itself, I420/YV12/YUY2 to NV12.
+ * Large frames are split into row bands and copied by helper threads.
+ */
+class ImageCopier {
+public:
+    ImageCopier();
+    ~ImageCopier();
+
+    //the fourcc we prefer to upload srcFourcc to
+    static uint32_t getDestFourcc(uint32_t srcFourcc);
+    static bool isSupported(uint32_t srcFourcc, uint32_t destFourcc);
+
+    bool copy(uint8_t* dest, const ImageLayout& destLayout,
+        const uint8_t* src, const ImageLayout& srcLayout,
+        uint32_t width, uint32_t height);
+
+    //max threads used to copy a frame, including caller's thread
+    void setThreads(uint32_t threads);
+
+private:
+    uint32_t getThreads(uint32_t width, uint32_t height);
+
+    std::vector<Thread*> m_threads;
+    //max threads we can use, including caller's thread
+    uint32_t m_maxThreads;
+
+    DISALLOW_COPY_AND_ASSIGN(ImageCopier);
+};
+}
+
+#endif //ImageCopy_h
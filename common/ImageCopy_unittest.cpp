@@ -0,0 +1,167 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// primary header
+#include "ImageCopy.h"
+
+// library headers
+#include "common/common_def.h"
+#include "common/unittest.h"
+
+// system headers
+#include <stdlib.h>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+#define IMAGECOPY_TEST(name) \
+    TEST(ImageCopyTest, name)
+
+//planar image with padded pitches
+struct Image {
+    Image(uint32_t fourcc, uint32_t width, uint32_t height)
+    {
+        uint32_t cw = (width + 1) / 2;
+        uint32_t ch = (height + 1) / 2;
+        uint32_t bytes[3] = { width, cw, cw };
+        uint32_t rows[3] = { height, ch, ch };
+        planes = 3;
+        if (fourcc == YAMI_FOURCC_NV12) {
+            bytes[1] = cw * 2;
+            planes = 2;
+        } else if (fourcc == YAMI_FOURCC_YUY2) {
+            bytes[0] = cw * 4;
+            planes = 1;
+        }
+        layout.fourcc = fourcc;
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < planes; i++) {
+            layout.pitches[i] = (bytes[i] + 63) & ~63;
+            layout.offsets[i] = offset;
+            offset += layout.pitches[i] * rows[i];
+        }
+        data.resize(offset + 16);
+        for (size_t i = 0; i < data.size(); i++)
+            data[i] = rand();
+    }
+
+    uint8_t at(uint32_t plane, uint32_t x, uint32_t y) const
+    {
+        return data[layout.offsets[plane] + y * layout.pitches[plane] + x];
+    }
+
+    ImageLayout layout;
+    uint32_t planes;
+    std::vector<uint8_t> data;
+};
+
+static void checkNv12FromI420(const Image& nv12, const Image& src, uint32_t width, uint32_t height)
+{
+    uint32_t u = src.layout.fourcc == YAMI_FOURCC_YV12 ? 2 : 1;
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++)
+            ASSERT_EQ(src.at(0, x, y), nv12.at(0, x, y));
+    }
+    for (uint32_t y = 0; y < (height + 1) / 2; y++) {
+        for (uint32_t x = 0; x < (width + 1) / 2; x++) {
+            ASSERT_EQ(src.at(u, x, y), nv12.at(1, x * 2, y));
+            ASSERT_EQ(src.at(3 - u, x, y), nv12.at(1, x * 2 + 1, y));
+        }
+    }
+}
+
+static void testI420(uint32_t fourcc, uint32_t width, uint32_t height, uint32_t threads)
+{
+    ImageCopier copier;
+    copier.setThreads(threads);
+    Image src(fourcc, width, height);
+    Image dest(YAMI_FOURCC_NV12, width, height);
+    ASSERT_TRUE(copier.copy(&dest.data[0], dest.layout, &src.data[0], src.layout, width, height));
+    checkNv12FromI420(dest, src, width, height);
+}
+
+IMAGECOPY_TEST(I420ToNv12)
+{
+    testI420(YAMI_FOURCC_I420, 320, 240, 1);
+    testI420(YAMI_FOURCC_I420, 67, 33, 1);
+}
+
+IMAGECOPY_TEST(Yv12ToNv12)
+{
+    testI420(YAMI_FOURCC_YV12, 176, 144, 1);
+    testI420(YAMI_FOURCC_YV12, 35, 17, 1);
+}
+
+IMAGECOPY_TEST(Yuy2ToNv12)
+{
+    const uint32_t sizes[][2] = { { 64, 32 }, { 70, 33 }, { 33, 7 } };
+    for (size_t i = 0; i < N_ELEMENTS(sizes); i++) {
+        uint32_t width = sizes[i][0];
+        uint32_t height = sizes[i][1];
+        ImageCopier copier;
+        Image src(YAMI_FOURCC_YUY2, width, height);
+        Image dest(YAMI_FOURCC_NV12, width, height);
+        ASSERT_TRUE(copier.copy(&dest.data[0], dest.layout, &src.data[0], src.layout, width, height));
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++)
+                ASSERT_EQ(src.at(0, x * 2, y), dest.at(0, x, y));
+        }
+        for (uint32_t y = 0; y < (height + 1) / 2; y++) {
+            uint32_t next = y * 2 + 1 < height ? y * 2 + 1 : y * 2;
+            for (uint32_t x = 0; x < (width + 1) / 2 * 2; x++) {
+                uint32_t c = (src.at(0, x * 2 + 1, y * 2) + src.at(0, x * 2 + 1, next) + 1) / 2;
+                ASSERT_EQ(c, dest.at(1, x, y));
+            }
+        }
+    }
+}
+
+IMAGECOPY_TEST(SameFormat)
+{
+    ImageCopier copier;
+    Image src(YAMI_FOURCC_I420, 99, 51);
+    Image dest(YAMI_FOURCC_I420, 99, 51);
+    ASSERT_TRUE(copier.copy(&dest.data[0], dest.layout, &src.data[0], src.layout, 99, 51));
+    for (uint32_t i = 0; i < 3; i++) {
+        uint32_t w = i ? 50 : 99;
+        uint32_t h = i ? 26 : 51;
+        for (uint32_t y = 0; y < h; y++) {
+            for (uint32_t x = 0; x < w; x++)
+                ASSERT_EQ(src.at(i, x, y), dest.at(i, x, y));
+        }
+    }
+}
+
+IMAGECOPY_TEST(Unsupported)
+{
+    EXPECT_FALSE(ImageCopier::isSupported(YAMI_FOURCC_NV12, YAMI_FOURCC_I420));
+    EXPECT_FALSE(ImageCopier::isSupported(YAMI_FOURCC('R', 'G', 'B', 'A'), YAMI_FOURCC_NV12));
+    EXPECT_EQ(YAMI_FOURCC_NV12, ImageCopier::getDestFourcc(YAMI_FOURCC_I420));
+    EXPECT_EQ(YAMI_FOURCC_P010, ImageCopier::getDestFourcc(YAMI_FOURCC_P010));
+}
+
+IMAGECOPY_TEST(MultiThread)
+{
+    //4k frame with odd height goes to row bands
+    testI420(YAMI_FOURCC_I420, 3840, 2161, 4);
+    testI420(YAMI_FOURCC_I420, 3840, 2160, 3);
+}
+
+}
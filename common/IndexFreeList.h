@@ -0,0 +1,152 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef indexfreelist_h
+#define indexfreelist_h
+
+#include "common/NonCopyable.h"
+
+#include <sched.h>
+#include <stdint.h>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+/**
+ * \class IndexFreeList
+ * \brief lock free first-in-first-out list of free slot indices.
+ *
+ * Pools keep their objects in a fixed array and only pass the array index
+ * through this list, so alloc and recycle are a few atomic operations
+ * instead of a mutex and a deque/map update.  Each slot of the ring carries
+ * a sequence number, producers and consumers claim a slot by advancing
+ * their own position with compare-and-swap, and publish it by bumping the
+ * slot's sequence (bounded MPMC queue by Dmitry Vyukov).
+ *
+ * Every index must be pushed at most once before it is popped again.  The
+ * ring holds twice as many entries as indices, so a push only waits when
+ * slow pops still occupy the slot it wraps around to, and a pop only waits
+ * for a push that claimed its slot but was preempted before publishing.
+ * pop fails only when the list is really empty.
+ */
+class IndexFreeList {
+public:
+    /// create the list for indices [0, maxSize), first @size of them are free
+    IndexFreeList(uint32_t maxSize, uint32_t size)
+        : m_enqueuePos(0)
+        , m_dequeuePos(0)
+    {
+        uint32_t capacity = 1;
+        while (capacity < maxSize * 2)
+            capacity <<= 1;
+        m_mask = capacity - 1;
+        m_cells.resize(capacity);
+        for (uint32_t i = 0; i < capacity; i++)
+            m_cells[i].sequence = i;
+        for (uint32_t i = 0; i < size; i++)
+            push(i);
+    }
+
+    void push(uint32_t index)
+    {
+        Cell* cell;
+        uint32_t pos = load(&m_enqueuePos);
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            int32_t diff = (int32_t)(load(&cell->sequence) - pos);
+            if (!diff) {
+                if (compareAndSwap(&m_enqueuePos, pos, pos + 1))
+                    break;
+            }
+            else if (diff < 0) {
+                //a pop claimed this slot one lap ago and has not released it
+                sched_yield();
+            }
+            pos = load(&m_enqueuePos);
+        }
+        cell->index = index;
+        store(&cell->sequence, pos + 1);
+    }
+
+    bool pop(uint32_t& index)
+    {
+        Cell* cell;
+        uint32_t pos = load(&m_dequeuePos);
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            int32_t diff = (int32_t)(load(&cell->sequence) - (pos + 1));
+            if (!diff) {
+                if (compareAndSwap(&m_dequeuePos, pos, pos + 1))
+                    break;
+            }
+            else if (diff < 0) {
+                if (load(&m_enqueuePos) == pos)
+                    return false;
+                //a push claimed this slot and has not published it
+                sched_yield();
+            }
+            pos = load(&m_dequeuePos);
+        }
+        index = cell->index;
+        store(&cell->sequence, pos + m_mask + 1);
+        return true;
+    }
+
+    /// a snapshot, only exact when no one is pushing or popping
+    uint32_t size()
+    {
+        return load(&m_enqueuePos) - load(&m_dequeuePos);
+    }
+
+private:
+    static uint32_t load(const uint32_t* p)
+    {
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+    }
+
+    static void store(uint32_t* p, uint32_t v)
+    {
+        __atomic_store_n(p, v, __ATOMIC_RELEASE);
+    }
+
+    static bool compareAndSwap(uint32_t* p, uint32_t expected, uint32_t desired)
+    {
+        return __atomic_compare_exchange_n(p, &expected, desired, true,
+            __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    }
+
+    struct Cell {
+        uint32_t sequence;
+        uint32_t index;
+    };
+
+    enum {
+        CACHE_LINE_SIZE = 64,
+    };
+
+    //keep producer and consumer positions on their own cache lines
+    uint8_t m_pad0[CACHE_LINE_SIZE];
+    uint32_t m_enqueuePos;
+    uint8_t m_pad1[CACHE_LINE_SIZE - sizeof(uint32_t)];
+    uint32_t m_dequeuePos;
+    uint8_t m_pad2[CACHE_LINE_SIZE - sizeof(uint32_t)];
+    uint32_t m_mask;
+    std::vector<Cell> m_cells;
+    DISALLOW_COPY_AND_ASSIGN(IndexFreeList);
+};
+
+} //namespace YamiMediaCodec
+
+#endif //indexfreelist_h
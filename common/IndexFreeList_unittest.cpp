@@ -0,0 +1,138 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// primary header
+#include "IndexFreeList.h"
+
+// library headers
+#include "common/unittest.h"
+#include "common/videopool.h"
+
+// system headers
+#include <deque>
+#include <pthread.h>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+#define INDEXFREELIST_TEST(name) \
+    TEST(IndexFreeListTest, name)
+
+INDEXFREELIST_TEST(FirstInFirstOut)
+{
+    IndexFreeList list(5, 3);
+    EXPECT_EQ(3u, list.size());
+
+    uint32_t index;
+    for (uint32_t i = 0; i < 3; i++) {
+        ASSERT_TRUE(list.pop(index));
+        EXPECT_EQ(i, index);
+    }
+    EXPECT_FALSE(list.pop(index));
+
+    //wrap around the ring a few times
+    for (uint32_t i = 0; i < 100; i++) {
+        list.push(i % 5);
+        list.push((i + 1) % 5);
+        ASSERT_TRUE(list.pop(index));
+        EXPECT_EQ(i % 5, index);
+        ASSERT_TRUE(list.pop(index));
+        EXPECT_EQ((i + 1) % 5, index);
+    }
+    EXPECT_EQ(0u, list.size());
+}
+
+struct StressParam {
+    IndexFreeList* list;
+    std::vector<uint32_t>* owners;
+    uint32_t loops;
+    uint32_t errors;
+};
+
+static void* stress(void* arg)
+{
+    StressParam* p = (StressParam*)arg;
+    uint32_t index;
+    for (uint32_t i = 0; i < p->loops; i++) {
+        if (!p->list->pop(index))
+            continue;
+        //nobody else may own it until we push it back
+        if (__atomic_exchange_n(&(*p->owners)[index], 1, __ATOMIC_RELAXED))
+            p->errors++;
+        __atomic_store_n(&(*p->owners)[index], 0, __ATOMIC_RELAXED);
+        p->list->push(index);
+    }
+    return NULL;
+}
+
+INDEXFREELIST_TEST(Stress)
+{
+    const uint32_t size = 8;
+    const int threads = 4;
+    IndexFreeList list(size, size);
+    std::vector<uint32_t> owners(size, 0);
+
+    pthread_t ids[threads];
+    StressParam params[threads];
+    for (int i = 0; i < threads; i++) {
+        StressParam p = { &list, &owners, 200000, 0 };
+        params[i] = p;
+        ASSERT_EQ(0, pthread_create(&ids[i], NULL, stress, &params[i]));
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        EXPECT_EQ(0u, params[i].errors);
+    }
+
+    //every index is back exactly once
+    EXPECT_EQ(size, list.size());
+    std::vector<bool> seen(size, false);
+    uint32_t index;
+    while (list.pop(index)) {
+        ASSERT_LT(index, size);
+        EXPECT_FALSE(seen[index]);
+        seen[index] = true;
+    }
+}
+
+INDEXFREELIST_TEST(VideoPoolRecycle)
+{
+    std::deque<SharedPtr<int> > buffers;
+    for (int i = 0; i < 2; i++)
+        buffers.push_back(SharedPtr<int>(new int(i)));
+    SharedPtr<VideoPool<int> > pool(new VideoPool<int>(buffers));
+    EXPECT_TRUE(buffers.empty());
+
+    SharedPtr<int> a = pool->alloc();
+    SharedPtr<int> b = pool->alloc();
+    ASSERT_TRUE(bool(a));
+    ASSERT_TRUE(bool(b));
+    EXPECT_EQ(0, *a);
+    EXPECT_EQ(1, *b);
+    EXPECT_FALSE(bool(pool->alloc()));
+
+    //recycled in release order
+    int* p = b.get();
+    b.reset();
+    a.reset();
+    EXPECT_EQ(p, pool->alloc().get());
+}
+
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef keepalivecache_h
+#define keepalivecache_h
+
+#include "VideoCommonDefs.h"
+#include "common/NonCopyable.h"
+#include "common/lock.h"
+#include "common/utils.h"
+
+#include <list>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+/**
+ * \class KeepAliveCache
+ * \brief holds idle objects for a while, so the next session can reuse them.
+ *
+ * It's opt-in, controlled by environment variables:
+ *     YAMI_CACHE_TTL  how long (in ms) an idle object is kept, 0 disables the cache
+ *     YAMI_CACHE_SIZE max number of idle objects, default is 4
+ * There is no timer, expired objects are released on the next put() or take(),
+ * never under the lock, since releasing a display or a context calls into the driver.
+ * Call clear() to release all of them, e.g. before the driver goes away.
+ */
+template <class Key, class Value>
+class KeepAliveCache {
+public:
+    typedef SharedPtr<Value> ValuePtr;
+
+    KeepAliveCache()
+        : m_ttl(0)
+        , m_maxSize(4)
+    {
+        const char* ttl = getenv("YAMI_CACHE_TTL");
+        if (ttl)
+            m_ttl = strtoul(ttl, NULL, 0);
+        const char* size = getenv("YAMI_CACHE_SIZE");
+        if (size)
+            m_maxSize = strtoul(size, NULL, 0);
+    }
+
+    ///ttl in ms
+    void setLimits(uint32_t ttl, uint32_t maxSize)
+    {
+        std::vector<ValuePtr> expired;
+        AutoLock lock(m_lock);
+        m_ttl = ttl;
+        m_maxSize = maxSize;
+        purge(expired);
+    }
+
+    bool enabled()
+    {
+        AutoLock lock(m_lock);
+        return m_ttl && m_maxSize;
+    }
+
+    /// keep @value for later take(), put the same value again only refreshes it.
+    void put(const Key& key, const ValuePtr& value)
+    {
+        std::vector<ValuePtr> expired;
+        AutoLock lock(m_lock);
+        typename Entries::iterator it;
+        for (it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->value == value) {
+                m_entries.erase(it);
+                break;
+            }
+        }
+        if (m_ttl && m_maxSize) {
+            Entry entry = { key, value, getSystemTime() };
+            m_entries.push_back(entry);
+        }
+        purge(expired);
+    }
+
+    /// remove the most recent object with @key from cache
+    bool take(const Key& key, ValuePtr& value)
+    {
+        std::vector<ValuePtr> expired;
+        AutoLock lock(m_lock);
+        purge(expired);
+        typename Entries::reverse_iterator it;
+        for (it = m_entries.rbegin(); it != m_entries.rend(); ++it) {
+            if (it->key == key) {
+                value = it->value;
+                m_entries.erase(--it.base());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// release all objects now
+    void clear()
+    {
+        Entries entries;
+        AutoLock lock(m_lock);
+        m_entries.swap(entries);
+    }
+
+    uint32_t size()
+    {
+        AutoLock lock(m_lock);
+        return m_entries.size();
+    }
+
+private:
+    //the caller releases @expired after it drops the lock
+    void purge(std::vector<ValuePtr>& expired)
+    {
+        uint64_t now = getSystemTime();
+        while (!m_entries.empty()) {
+            const Entry& oldest = m_entries.front();
+            if (m_entries.size() <= m_maxSize && oldest.time + m_ttl > now)
+                break;
+            expired.push_back(oldest.value);
+            m_entries.pop_front();
+        }
+    }
+
+    struct Entry {
+        Key key;
+        ValuePtr value;
+        uint64_t time;
+    };
+    typedef std::list<Entry> Entries;
+
+    Lock m_lock;
+    Entries m_entries;
+    uint32_t m_ttl;
+    uint32_t m_maxSize;
+    DISALLOW_COPY_AND_ASSIGN(KeepAliveCache);
+};
+
+} //namespace YamiMediaCodec
+
+#endif //keepalivecache_h
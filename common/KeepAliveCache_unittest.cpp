@@ -0,0 +1,117 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// primary header
+#include "KeepAliveCache.h"
+
+// library headers
+#include "common/unittest.h"
+
+// system headers
+#include <unistd.h>
+
+namespace YamiMediaCodec {
+
+#define KEEPALIVECACHE_TEST(name) \
+    TEST(KeepAliveCacheTest, name)
+
+typedef KeepAliveCache<int, int> IntCache;
+typedef IntCache::ValuePtr IntPtr;
+
+KEEPALIVECACHE_TEST(Disabled)
+{
+    IntCache cache;
+    cache.setLimits(0, 4);
+    EXPECT_FALSE(cache.enabled());
+
+    IntPtr v(new int(1));
+    cache.put(1, v);
+    EXPECT_EQ(1, v.use_count());
+    IntPtr out;
+    EXPECT_FALSE(cache.take(1, out));
+}
+
+KEEPALIVECACHE_TEST(PutTake)
+{
+    IntCache cache;
+    cache.setLimits(60000, 4);
+    EXPECT_TRUE(cache.enabled());
+
+    IntPtr a(new int(1));
+    IntPtr b(new int(2));
+    cache.put(1, a);
+    cache.put(1, b);
+    //same value only refreshes
+    cache.put(1, a);
+    EXPECT_EQ(2u, cache.size());
+
+    IntPtr out;
+    EXPECT_FALSE(cache.take(2, out));
+    //most recent first
+    ASSERT_TRUE(cache.take(1, out));
+    EXPECT_EQ(a, out);
+    ASSERT_TRUE(cache.take(1, out));
+    EXPECT_EQ(b, out);
+    EXPECT_FALSE(cache.take(1, out));
+}
+
+KEEPALIVECACHE_TEST(MaxSize)
+{
+    IntCache cache;
+    cache.setLimits(60000, 2);
+    IntPtr v[3];
+    for (int i = 0; i < 3; i++) {
+        v[i].reset(new int(i));
+        cache.put(i, v[i]);
+    }
+    EXPECT_EQ(2u, cache.size());
+    //oldest dropped
+    EXPECT_EQ(1, v[0].use_count());
+    IntPtr out;
+    EXPECT_FALSE(cache.take(0, out));
+    EXPECT_TRUE(cache.take(2, out));
+}
+
+KEEPALIVECACHE_TEST(Expire)
+{
+    IntCache cache;
+    cache.setLimits(10, 4);
+    IntPtr v(new int(1));
+    cache.put(1, v);
+    EXPECT_EQ(2, v.use_count());
+    usleep(30 * 1000);
+
+    IntPtr out;
+    EXPECT_FALSE(cache.take(1, out));
+    EXPECT_EQ(1, v.use_count());
+}
+
+KEEPALIVECACHE_TEST(Clear)
+{
+    IntCache cache;
+    cache.setLimits(60000, 4);
+    IntPtr v(new int(1));
+    cache.put(1, v);
+    cache.clear();
+    EXPECT_EQ(0u, cache.size());
+    EXPECT_EQ(1, v.use_count());
+}
+
+}
@@ -0,0 +1,305 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "ThreadPool.h"
+#include "Functional.h"
+#include "log.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace YamiMediaCodec {
+
+const int32_t ThreadPool::NO_AFFINITY;
+
+struct ThreadPool::Worker {
+    Worker(ThreadPool* p, uint32_t i)
+        : pool(p)
+        , index(i)
+        , started(false)
+    {
+    }
+    ThreadPool* pool;
+    uint32_t index;
+    bool started;
+    pthread_t thread;
+    Lock lock;
+    std::deque<Job> jobs;
+};
+
+ThreadPool::ThreadPool(uint32_t threads)
+    : m_cond(m_lock)
+    , m_pending(0)
+    , m_idle(0)
+    , m_stopped(false)
+    , m_next(0)
+{
+    if (!threads) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? cpus : 1;
+    }
+    for (uint32_t i = 0; i < threads; i++)
+        m_workers.push_back(new Worker(this, i));
+    //all workers exist before any of them steals
+    for (uint32_t i = 0; i < threads; i++) {
+        Worker* w = m_workers[i];
+        if (pthread_create(&w->thread, NULL, init, w))
+            ERROR("create pool worker %d failed", i);
+        else
+            w->started = true;
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        AutoLock lock(m_lock);
+        m_stopped = true;
+        m_cond.broadcast();
+    }
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        if (m_workers[i]->started)
+            pthread_join(m_workers[i]->thread, NULL);
+    }
+    for (size_t i = 0; i < m_workers.size(); i++)
+        delete m_workers[i];
+}
+
+static ThreadPool* s_shared = NULL;
+
+static void createSharedPool()
+{
+    uint32_t threads = 0;
+    const char* env = getenv("YAMI_POOL_THREADS");
+    if (env)
+        threads = atoi(env);
+    s_shared = new ThreadPool(threads);
+    INFO("shared thread pool with %d workers", s_shared->size());
+}
+
+ThreadPool& ThreadPool::shared()
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, createSharedPool);
+    return *s_shared;
+}
+
+void* ThreadPool::init(void* arg)
+{
+    Worker* w = (Worker*)arg;
+    w->pool->loop(w);
+    return NULL;
+}
+
+int32_t ThreadPool::currentWorker() const
+{
+    pthread_t self = pthread_self();
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        if (m_workers[i]->started && pthread_equal(m_workers[i]->thread, self))
+            return i;
+    }
+    return NO_AFFINITY;
+}
+
+void ThreadPool::post(const Job& job, int32_t affinity)
+{
+    uint32_t size = m_workers.size();
+    int32_t index = affinity;
+    if (index < 0 || (uint32_t)index >= size)
+        index = currentWorker();
+    if (index < 0) {
+        AutoLock lock(m_lock);
+        index = m_next++ % size;
+    }
+    Worker* w = m_workers[index];
+    {
+        AutoLock lock(w->lock);
+        w->jobs.push_back(job);
+    }
+    AutoLock lock(m_lock);
+    m_pending++;
+    if (m_idle)
+        m_cond.signal();
+}
+
+bool ThreadPool::popJob(uint32_t index, Job& job)
+{
+    uint32_t size = m_workers.size();
+    //our own jobs first, then steal from the next workers
+    for (uint32_t i = 0; i < size; i++) {
+        Worker* w = m_workers[(index + i) % size];
+        AutoLock lock(w->lock);
+        if (!w->jobs.empty()) {
+            job.swap(w->jobs.front());
+            w->jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::loop(Worker* self)
+{
+    while (1) {
+        Job job;
+        if (popJob(self->index, job)) {
+            {
+                AutoLock lock(m_lock);
+                m_pending--;
+            }
+            job();
+            continue;
+        }
+        bool busy;
+        {
+            AutoLock lock(m_lock);
+            //a job is taken by other worker but m_pending is not updated yet
+            busy = m_pending > 0;
+            if (!busy) {
+                if (m_stopped)
+                    return;
+                m_idle++;
+                m_cond.wait();
+                m_idle--;
+            }
+        }
+        if (busy)
+            sched_yield();
+    }
+}
+
+SerialQueue::SerialQueue(const char* name, ThreadPool& pool)
+    : m_name(name)
+    , m_pool(pool)
+    , m_cond(m_lock)
+    , m_started(false)
+    , m_scheduled(false)
+    , m_running(false)
+    , m_worker(ThreadPool::NO_AFFINITY)
+{
+}
+
+SerialQueue::~SerialQueue()
+{
+    stop();
+}
+
+bool SerialQueue::start()
+{
+    AutoLock lock(m_lock);
+    if (m_started)
+        return false;
+    m_started = true;
+    return true;
+}
+
+void SerialQueue::stop()
+{
+    AutoLock lock(m_lock);
+    if (!m_started)
+        return;
+    m_started = false;
+    while (m_scheduled)
+        m_cond.wait();
+}
+
+//called with m_lock held
+void SerialQueue::schedule()
+{
+    if (m_scheduled)
+        return;
+    m_scheduled = true;
+    m_pool.post(std::bind(&SerialQueue::run, this), m_worker);
+}
+
+void SerialQueue::post(const Job& r)
+{
+    AutoLock lock(m_lock);
+    if (!m_started) {
+        ERROR("%s: post job after stop()", m_name.c_str());
+        return;
+    }
+    m_queue.push_back(r);
+    schedule();
+}
+
+void SerialQueue::sendJob(const Job& r, bool& flag)
+{
+    r();
+
+    //flag need protect here since we check it in other thread
+    AutoLock lock(m_lock);
+    flag = true;
+    m_cond.broadcast();
+}
+
+bool SerialQueue::send(const Job& c)
+{
+    if (isCurrent()) {
+        c();
+        return true;
+    }
+    bool flag = false;
+
+    AutoLock lock(m_lock);
+    if (!m_started) {
+        ERROR("%s: sent job after stop()", m_name.c_str());
+        return false;
+    }
+    m_queue.push_back(std::bind(&SerialQueue::sendJob, this, std::ref(c), std::ref(flag)));
+    schedule();
+    //wait for result;
+    while (!flag) {
+        m_cond.wait();
+    }
+    return true;
+}
+
+bool SerialQueue::isCurrent()
+{
+    AutoLock lock(m_lock);
+    return m_running && pthread_equal(m_runner, pthread_self());
+}
+
+void SerialQueue::run()
+{
+    //give the worker to other queues after some jobs
+    static const int kMaxBatch = 8;
+
+    AutoLock lock(m_lock);
+    m_running = true;
+    m_runner = pthread_self();
+    m_worker = m_pool.currentWorker();
+    for (int i = 0; i < kMaxBatch && !m_queue.empty(); i++) {
+        Job job = m_queue.front();
+        m_queue.pop_front();
+        m_lock.release();
+        job();
+        m_lock.acquire();
+    }
+    m_running = false;
+    m_scheduled = false;
+    if (!m_queue.empty())
+        schedule();
+    else
+        m_cond.broadcast();
+}
+};
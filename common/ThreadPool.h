@@ -0,0 +1,123 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ThreadPool_h
+#define ThreadPool_h
+
+#include "Thread.h"
+#include "condition.h"
+#include "lock.h"
+
+#include <deque>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+/**
+ * \class ThreadPool
+ * \brief fixed number of workers, each one has its own job deque.
+ *
+ * post() puts the job to the worker given by affinity hint, or to the calling
+ * worker when it's called from a job. A worker runs its own jobs in order,
+ * when it has nothing to do, it steals the oldest job from other workers.
+ * Jobs should not block, a blocked job holds a worker from all streams.
+ */
+class ThreadPool {
+public:
+    /// @threads 0 means one worker per online cpu
+    explicit ThreadPool(uint32_t threads = 0);
+    /// runs all posted jobs and joins the workers
+    ~ThreadPool();
+
+    /// process wide pool, created on first use. YAMI_POOL_THREADS sets its size
+    static ThreadPool& shared();
+
+    static const int32_t NO_AFFINITY = -1;
+    /// run @job on a worker, @affinity is the preferred worker index
+    void post(const Job& job, int32_t affinity = NO_AFFINITY);
+
+    uint32_t size() const { return m_workers.size(); }
+    /// index of calling worker, NO_AFFINITY if we are not called from this pool
+    int32_t currentWorker() const;
+
+private:
+    struct Worker;
+    static void* init(void*);
+    void loop(Worker*);
+    bool popJob(uint32_t index, Job& job);
+
+    std::vector<Worker*> m_workers;
+
+    Lock m_lock;
+    Condition m_cond;
+    //jobs in all deques
+    uint32_t m_pending;
+    //workers waiting on m_cond
+    uint32_t m_idle;
+    bool m_stopped;
+    //next worker for jobs posted from outside without affinity
+    uint32_t m_next;
+
+    DISALLOW_COPY_AND_ASSIGN(ThreadPool);
+};
+
+/**
+ * \class SerialQueue
+ * \brief runs jobs one by one in post order on a ThreadPool.
+ *
+ * It has the same interface as Thread, but it does not own a pthread,
+ * many queues share the workers of one pool. A queue prefers the worker it
+ * ran on last time, so its data stays in the same cpu cache.
+ */
+class SerialQueue {
+public:
+    explicit SerialQueue(const char* name = "", ThreadPool& pool = ThreadPool::shared());
+    ~SerialQueue();
+    bool start();
+    //stop queue, this will waiting all post/sent job done
+    void stop();
+    //post job to this queue
+    void post(const Job&);
+    //send job and wait it done, it runs the job directly if we are called from this queue
+    bool send(const Job&);
+    bool isCurrent();
+
+private:
+    //run queued jobs on a pool worker
+    void run();
+    void schedule();
+    void sendJob(const Job& r, bool& flag);
+
+    std::string m_name;
+    ThreadPool& m_pool;
+
+    Lock m_lock;
+    Condition m_cond;
+    std::deque<Job> m_queue;
+    bool m_started;
+    //run() is posted to pool or running
+    bool m_scheduled;
+    bool m_running;
+    pthread_t m_runner;
+    int32_t m_worker;
+
+    DISALLOW_COPY_AND_ASSIGN(SerialQueue);
+};
+};
+
+#endif
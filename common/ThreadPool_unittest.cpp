@@ -0,0 +1,150 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// primary header
+#include "ThreadPool.h"
+
+// library headers
+#include "common/unittest.h"
+
+// system headers
+#include <unistd.h>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+#define THREADPOOL_TEST(name) \
+    TEST(ThreadPoolTest, name)
+
+static void append(Lock& lock, std::vector<int>& v, int i)
+{
+    AutoLock l(lock);
+    v.push_back(i);
+}
+
+static void increase(int& v)
+{
+    __atomic_add_fetch(&v, 1, __ATOMIC_RELAXED);
+}
+
+static int load(int& v)
+{
+    return __atomic_load_n(&v, __ATOMIC_ACQUIRE);
+}
+
+static void checkCurrent(SerialQueue& q, bool& current)
+{
+    current = q.isCurrent();
+}
+
+//holds a worker until @release is set
+static void block(int& started, int& release)
+{
+    increase(started);
+    while (!load(release))
+        usleep(1000);
+}
+
+THREADPOOL_TEST(SerialOrder)
+{
+    ThreadPool pool(4);
+    const int kQueues = 8;
+    const int kJobs = 200;
+    SerialQueue* queues[kQueues];
+    std::vector<int> results[kQueues];
+    Lock lock;
+    for (int i = 0; i < kQueues; i++) {
+        queues[i] = new SerialQueue("test", pool);
+        EXPECT_TRUE(queues[i]->start());
+    }
+    for (int j = 0; j < kJobs; j++) {
+        for (int i = 0; i < kQueues; i++)
+            queues[i]->post(std::bind(append, std::ref(lock), std::ref(results[i]), j));
+    }
+    //stop waits for all jobs
+    for (int i = 0; i < kQueues; i++) {
+        queues[i]->stop();
+        delete queues[i];
+    }
+    for (int i = 0; i < kQueues; i++) {
+        ASSERT_EQ(kJobs, (int)results[i].size());
+        for (int j = 0; j < kJobs; j++)
+            EXPECT_EQ(j, results[i][j]);
+    }
+}
+
+THREADPOOL_TEST(Send)
+{
+    ThreadPool pool(2);
+    SerialQueue q("test", pool);
+    int v = 0;
+    bool current = true;
+
+    EXPECT_FALSE(q.send(std::bind(increase, std::ref(v))));
+    EXPECT_TRUE(q.start());
+    EXPECT_FALSE(q.start());
+    for (int i = 0; i < 10; i++)
+        q.post(std::bind(increase, std::ref(v)));
+    EXPECT_TRUE(q.send(std::bind(increase, std::ref(v))));
+    EXPECT_EQ(11, v);
+
+    EXPECT_TRUE(q.send(std::bind(checkCurrent, std::ref(q), std::ref(current))));
+    EXPECT_TRUE(current);
+    EXPECT_FALSE(q.isCurrent());
+
+    //send from our own job does not dead lock
+    EXPECT_TRUE(q.send(std::bind(&SerialQueue::send, &q, Job(std::bind(increase, std::ref(v))))));
+    EXPECT_EQ(12, v);
+    q.stop();
+}
+
+THREADPOOL_TEST(Steal)
+{
+    ThreadPool pool(3);
+    int started = 0;
+    int release = 0;
+    int v = 0;
+
+    //block worker 0, jobs queued to it must be stolen by others
+    pool.post(std::bind(block, std::ref(started), std::ref(release)), 0);
+    while (!load(started))
+        usleep(1000);
+    for (int i = 0; i < 100; i++)
+        pool.post(std::bind(increase, std::ref(v)), 0);
+    for (int i = 0; i < 1000 && load(v) < 100; i++)
+        usleep(1000);
+    EXPECT_EQ(100, load(v));
+    __atomic_store_n(&release, 1, __ATOMIC_RELEASE);
+}
+
+THREADPOOL_TEST(DestroyRunsAll)
+{
+    int v = 0;
+    {
+        ThreadPool pool(2);
+        EXPECT_EQ(ThreadPool::NO_AFFINITY, pool.currentWorker());
+        //out of range affinity is only a hint
+        for (int i = 0; i < 1000; i++)
+            pool.post(std::bind(increase, std::ref(v)), i % 4 - 1);
+    }
+    EXPECT_EQ(1000, v);
+}
+
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Raw frame upload benchmark for ImageCopier.
+ *
+ *     imagecopybench [-w width] [-h height] [-n frames] [-t threads]
+ *
+ * Copies frames of every supported conversion into an NV12 (or same
+ * format) destination with padded pitches, like a mapped surface has, and
+ * reports frames/sec and GB/s of source data.  The first line is a plain
+ * row by row memcpy of an NV12 frame, it is what the encoder did before.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// library headers
+#include "common/ImageCopy.h"
+
+// system headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace YamiMediaCodec;
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//pitches are padded to 64 bytes, returns the image size
+static uint32_t makeLayout(ImageLayout& layout, uint32_t fourcc,
+    uint32_t width, uint32_t height, uint32_t& bytes)
+{
+    uint32_t cw = (width + 1) / 2;
+    uint32_t ch = (height + 1) / 2;
+    uint32_t widths[3] = { width, cw, cw };
+    uint32_t rows[3] = { height, ch, ch };
+    uint32_t planes = 3;
+    if (fourcc == YAMI_FOURCC_NV12) {
+        widths[1] = cw * 2;
+        planes = 2;
+    } else if (fourcc == YAMI_FOURCC_P010) {
+        widths[0] = width * 2;
+        widths[1] = cw * 4;
+        planes = 2;
+    } else if (fourcc == YAMI_FOURCC_YUY2) {
+        widths[0] = cw * 4;
+        planes = 1;
+    }
+    memset(&layout, 0, sizeof(layout));
+    layout.fourcc = fourcc;
+    uint32_t offset = 0;
+    bytes = 0;
+    for (uint32_t i = 0; i < planes; i++) {
+        layout.pitches[i] = (widths[i] + 63) & ~63;
+        layout.offsets[i] = offset;
+        offset += layout.pitches[i] * rows[i];
+        bytes += widths[i] * rows[i];
+    }
+    return offset;
+}
+
+static void report(const char* name, uint32_t frames, uint64_t bytes, double elapsed)
+{
+    if (elapsed <= 0)
+        elapsed = 1e-9;
+    printf("%-14s %8u frames %8.3f s %10.1f fps %8.2f GB/s\n",
+        name, frames, elapsed, frames / elapsed, bytes / elapsed / 1e9);
+}
+
+//the old encoder upload, one memcpy per row of every plane
+static void benchMemcpy(uint32_t width, uint32_t height, uint32_t frames)
+{
+    ImageLayout layout;
+    uint32_t bytes;
+    uint32_t size = makeLayout(layout, YAMI_FOURCC_NV12, width, height, bytes);
+    std::vector<uint8_t> src(size, 0x80), dest(size);
+    uint32_t rows[2] = { height, (height + 1) / 2 };
+    uint32_t widths[2] = { width, ((width + 1) / 2) * 2 };
+    double start = now();
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint32_t i = 0; i < 2; i++) {
+            for (uint32_t r = 0; r < rows[i]; r++) {
+                uint32_t offset = layout.offsets[i] + r * layout.pitches[i];
+                memcpy(&dest[offset], &src[offset], widths[i]);
+            }
+        }
+    }
+    report("memcpy", frames, (uint64_t)bytes * frames, now() - start);
+}
+
+static bool bench(ImageCopier& copier, const char* name, uint32_t fourcc,
+    uint32_t width, uint32_t height, uint32_t frames)
+{
+    uint32_t destFourcc = ImageCopier::getDestFourcc(fourcc);
+    ImageLayout srcLayout, destLayout;
+    uint32_t bytes, destBytes;
+    uint32_t srcSize = makeLayout(srcLayout, fourcc, width, height, bytes);
+    uint32_t destSize = makeLayout(destLayout, destFourcc, width, height, destBytes);
+    std::vector<uint8_t> src(srcSize), dest(destSize);
+    for (size_t i = 0; i < src.size(); i++)
+        src[i] = rand();
+
+    double start = now();
+    for (uint32_t f = 0; f < frames; f++) {
+        if (!copier.copy(&dest[0], destLayout, &src[0], srcLayout, width, height)) {
+            fprintf(stderr, "%s: copy failed\n", name);
+            return false;
+        }
+    }
+    report(name, frames, (uint64_t)bytes * frames, now() - start);
+    return true;
+}
+
+static void usage(const char* app)
+{
+    fprintf(stderr, "usage: %s [-w width] [-h height] [-n frames] [-t threads]\n", app);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t width = 3840;
+    uint32_t height = 2160;
+    uint32_t frames = 100;
+    uint32_t threads = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "w:h:n:t:")) != -1) {
+        switch (opt) {
+        case 'w':
+            width = atoi(optarg);
+            break;
+        case 'h':
+            height = atoi(optarg);
+            break;
+        case 'n':
+            frames = atoi(optarg);
+            break;
+        case 't':
+            threads = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return -1;
+        }
+    }
+    if (!width || !height || !frames) {
+        usage(argv[0]);
+        return -1;
+    }
+    ImageCopier copier;
+    if (threads)
+        copier.setThreads(threads);
+    printf("%ux%u, %u frames\n", width, height, frames);
+    benchMemcpy(width, height, frames);
+    bool ok = bench(copier, "NV12", YAMI_FOURCC_NV12, width, height, frames)
+        && bench(copier, "P010", YAMI_FOURCC_P010, width, height, frames)
+        && bench(copier, "I420->NV12", YAMI_FOURCC_I420, width, height, frames)
+        && bench(copier, "YV12->NV12", YAMI_FOURCC_YV12, width, height, frames)
+        && bench(copier, "YUY2->NV12", YAMI_FOURCC_YUY2, width, height, frames);
+    return ok ? 0 : -1;
+}
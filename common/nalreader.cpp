@@ -18,13 +18,14 @@
 #include "config.h"
 #endif
 
-#include <algorithm>
 #include "nalreader.h"
+#include "startcode.h"
 
 namespace YamiMediaCodec{
 
 NalReader::NalReader(const uint8_t* buf, int32_t size, uint32_t nalLengthSize, bool asWhole)
 {
+    m_buf = buf;
     m_begin = buf;
     m_next  = buf;
     m_end   = buf + size;
@@ -53,13 +54,27 @@ bool NalReader::read(const uint8_t*& nal, int32_t& nalSize)
     return true;
 }
 
-static const uint8_t START_CODE[] = { 0, 0, 1 };
+void NalReader::readAll(NalIndex& index)
+{
+    index.clear();
+    const uint8_t* nal;
+    int32_t size;
+    while (read(nal, size)) {
+        if (size <= 0)
+            continue;
+        NalIndexEntry entry;
+        entry.offset = nal - m_buf;
+        entry.size = size;
+        entry.header = nal[0];
+        index.push_back(entry);
+    }
+}
+
 static const int START_CODE_SIZE = 3;
-static const uint8_t* START_CODE_END = START_CODE + START_CODE_SIZE;
 
 const uint8_t* NalReader::searchStartCode()
 {
-    m_begin = std::search(m_next, m_end, START_CODE, START_CODE_END);
+    m_begin = YamiMediaCodec::searchStartCode(m_next, m_end);
 
     if (m_begin != m_end) {
         m_next = m_begin + START_CODE_SIZE;
@@ -13,10 +13,22 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#ifndef nalreader_h
+#define nalreader_h
+
 #include <stdint.h>
+#include <vector>
 
 namespace YamiMediaCodec{
 
+/*location of a nal unit in the buffer given to NalReader*/
+struct NalIndexEntry {
+    uint32_t offset; /*first byte after the start code or length bytes*/
+    uint32_t size;
+    uint8_t header; /*first byte of the nal unit, it carries the nal type*/
+};
+typedef std::vector<NalIndexEntry> NalIndex;
+
 class NalReader
 {
 public:
@@ -25,8 +37,13 @@ public:
     /*nal point to the nal unit without start code or length bytes*/
     bool read(const uint8_t*& nal, int32_t& nalSize);
 
+    /*split all remaining nal units in one pass, empty units are skipped.
+      index is cleared first, so callers can reuse its storage*/
+    void readAll(NalIndex& index);
+
 private:
     const uint8_t* searchNalStart();
+    const uint8_t* m_buf;
     const uint8_t* searchStartCode();
     const uint8_t* m_begin;
     const uint8_t* m_next;
@@ -37,3 +54,5 @@ private:
 };
 
 } //namespace YamiMediaCodec
+
+#endif //nalreader_h
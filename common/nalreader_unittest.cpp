@@ -96,6 +96,51 @@ NALREADER_TEST(ReadAsWhole) {
     EXPECT_FALSE(reader.read(nal, size));
 }
 
+NALREADER_TEST(ReadAllAnnexB) {
+    NalIndex index;
+    NalReader reader(&g_data[0], g_data.size());
+    reader.readAll(index);
+
+    ASSERT_EQ(index.size(), g_nsizes.size());
+    uint32_t offset = 1 + 3; //junk byte and first start code
+    for (size_t n(0); n < index.size(); ++n) {
+        EXPECT_EQ(index[n].offset, offset);
+        EXPECT_EQ(index[n].size, (uint32_t)g_nsizes[n]);
+        EXPECT_EQ(index[n].header, g_data[offset]);
+        offset += g_nsizes[n] + 3;
+    }
+
+    //index is reset by the next call
+    reader = NalReader(&g_data[0], g_data.size(), 0, true);
+    reader.readAll(index);
+    ASSERT_EQ(index.size(), 1u);
+    EXPECT_EQ(index[0].offset, 4u);
+    EXPECT_EQ(index[0].size, g_data.size() - 4);
+}
+
+NALREADER_TEST(ReadAllLengthPrefixed) {
+    const std::array<uint8_t, 14> data = {
+        0x00, 0x03, 0x65, 0x88, 0x84,
+        0x00, 0x00, // empty unit is skipped
+        0x00, 0x02, 0x41, 0x9a,
+        0x00, 0x09, 0x01 // truncated unit
+    };
+    NalIndex index;
+
+    NalReader reader(&data[0], data.size(), 2);
+    reader.readAll(index);
+
+    ASSERT_EQ(index.size(), 3u);
+    EXPECT_EQ(index[0].offset, 2u);
+    EXPECT_EQ(index[0].size, 3u);
+    EXPECT_EQ(index[0].header, 0x65);
+    EXPECT_EQ(index[1].offset, 9u);
+    EXPECT_EQ(index[1].size, 2u);
+    EXPECT_EQ(index[1].header, 0x41);
+    EXPECT_EQ(index[2].offset, 13u);
+    EXPECT_EQ(index[2].size, 1u);
+}
+
 NALREADER_TEST(ReadEmptyBuf) {
     const uint8_t data[] = {};
     const uint8_t* nal;
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Multi-threaded stress benchmark for the surface free list.
+ *
+ *     poolbench [-t threads] [-n loops] [-s size]
+ *
+ * Every thread takes an entry from the pool and gives it back, like decode,
+ * render and encode threads do with surfaces.  It runs the same load on
+ * a mutex protected deque (the old pool), on IndexFreeList and on
+ * VideoPool, reports allocs/sec, and fails if two threads ever own the
+ * same entry or an entry is lost.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// library headers
+#include "common/IndexFreeList.h"
+#include "common/lock.h"
+#include "common/videopool.h"
+
+// system headers
+#include <deque>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace YamiMediaCodec;
+
+//same interface as IndexFreeList, maxSize is not needed by a deque
+class LockedPool {
+public:
+    LockedPool(uint32_t, uint32_t size)
+    {
+        for (uint32_t i = 0; i < size; i++)
+            m_freed.push_back(i);
+    }
+    bool pop(uint32_t& index)
+    {
+        AutoLock lock(m_lock);
+        if (m_freed.empty())
+            return false;
+        index = m_freed.front();
+        m_freed.pop_front();
+        return true;
+    }
+    void push(uint32_t index)
+    {
+        AutoLock lock(m_lock);
+        m_freed.push_back(index);
+    }
+    uint32_t size()
+    {
+        AutoLock lock(m_lock);
+        return m_freed.size();
+    }
+
+private:
+    Lock m_lock;
+    std::deque<uint32_t> m_freed;
+};
+
+struct Shared {
+    uint32_t loops;
+    std::vector<uint32_t> owners;
+    uint32_t errors;
+    uint32_t allocs;
+};
+
+static void own(Shared* s, uint32_t index)
+{
+    if (__atomic_exchange_n(&s->owners[index], 1, __ATOMIC_RELAXED))
+        __atomic_add_fetch(&s->errors, 1, __ATOMIC_RELAXED);
+}
+
+static void disown(Shared* s, uint32_t index)
+{
+    __atomic_store_n(&s->owners[index], 0, __ATOMIC_RELAXED);
+}
+
+template <class Pool>
+struct IndexJob {
+    Pool* pool;
+    Shared* shared;
+    static void* run(void* arg)
+    {
+        IndexJob* job = (IndexJob*)arg;
+        Shared* s = job->shared;
+        uint32_t index, allocs = 0;
+        for (uint32_t i = 0; i < s->loops; i++) {
+            if (!job->pool->pop(index))
+                continue;
+            own(s, index);
+            disown(s, index);
+            job->pool->push(index);
+            allocs++;
+        }
+        __atomic_add_fetch(&s->allocs, allocs, __ATOMIC_RELAXED);
+        return NULL;
+    }
+};
+
+struct VideoPoolJob {
+    SharedPtr<VideoPool<uint32_t> > pool;
+    Shared* shared;
+    static void* run(void* arg)
+    {
+        VideoPoolJob* job = (VideoPoolJob*)arg;
+        Shared* s = job->shared;
+        uint32_t allocs = 0;
+        for (uint32_t i = 0; i < s->loops; i++) {
+            SharedPtr<uint32_t> p = job->pool->alloc();
+            if (!p)
+                continue;
+            own(s, *p);
+            disown(s, *p);
+            allocs++;
+        }
+        __atomic_add_fetch(&s->allocs, allocs, __ATOMIC_RELAXED);
+        return NULL;
+    }
+};
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+template <class Job>
+static bool runJobs(const char* name, std::vector<Job>& jobs, Shared& shared)
+{
+    std::vector<pthread_t> ids(jobs.size());
+    double start = now();
+    for (size_t i = 0; i < jobs.size(); i++) {
+        if (pthread_create(&ids[i], NULL, Job::run, &jobs[i])) {
+            fprintf(stderr, "failed to create thread\n");
+            return false;
+        }
+    }
+    for (size_t i = 0; i < jobs.size(); i++)
+        pthread_join(ids[i], NULL);
+    double elapsed = now() - start;
+    printf("%-14s %10u allocs %8.3f s %12.0f allocs/sec\n",
+        name, shared.allocs, elapsed, shared.allocs / elapsed);
+    if (shared.errors) {
+        fprintf(stderr, "%s: %u entries owned twice\n", name, shared.errors);
+        return false;
+    }
+    return true;
+}
+
+template <class Pool>
+static bool benchIndex(const char* name, uint32_t threads, uint32_t loops, uint32_t size)
+{
+    Pool pool(size, size);
+    Shared shared = { loops, std::vector<uint32_t>(size, 0), 0, 0 };
+    IndexJob<Pool> job = { &pool, &shared };
+    std::vector<IndexJob<Pool> > jobs(threads, job);
+    if (!runJobs(name, jobs, shared))
+        return false;
+    if (pool.size() != size) {
+        fprintf(stderr, "%s: %u entries lost\n", name, size - pool.size());
+        return false;
+    }
+    return true;
+}
+
+static bool benchVideoPool(uint32_t threads, uint32_t loops, uint32_t size)
+{
+    std::deque<SharedPtr<uint32_t> > buffers;
+    for (uint32_t i = 0; i < size; i++)
+        buffers.push_back(SharedPtr<uint32_t>(new uint32_t(i)));
+    Shared shared = { loops, std::vector<uint32_t>(size, 0), 0, 0 };
+    VideoPoolJob job;
+    job.pool.reset(new VideoPool<uint32_t>(buffers));
+    job.shared = &shared;
+    std::vector<VideoPoolJob> jobs(threads, job);
+    bool ret = runJobs("VideoPool", jobs, shared);
+    jobs.clear();
+
+    //all entries must come back
+    std::vector<SharedPtr<uint32_t> > held;
+    SharedPtr<uint32_t> p;
+    while ((p = job.pool->alloc()))
+        held.push_back(p);
+    if (held.size() != size) {
+        fprintf(stderr, "VideoPool: %u entries lost\n", size - (uint32_t)held.size());
+        return false;
+    }
+    return ret;
+}
+
+static void usage(const char* app)
+{
+    fprintf(stderr, "usage: %s [-t threads] [-n loops] [-s size]\n", app);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t threads = 4;
+    uint32_t loops = 1000000;
+    uint32_t size = 16;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:n:s:h")) != -1) {
+        switch (opt) {
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 'n':
+            loops = atoi(optarg);
+            break;
+        case 's':
+            size = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return -1;
+        }
+    }
+    if (!threads || !size) {
+        usage(argv[0]);
+        return -1;
+    }
+    printf("%u threads, %u loops per thread, %u entries\n", threads, loops, size);
+    bool ok = benchIndex<LockedPool>("locked deque", threads, loops, size)
+        && benchIndex<IndexFreeList>("IndexFreeList", threads, loops, size)
+        && benchVideoPool(threads, loops, size);
+    return ok ? 0 : -1;
+}
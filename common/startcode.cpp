@@ -0,0 +1,133 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "startcode.h"
+
+#include <stddef.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STARTCODE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace YamiMediaCodec {
+
+/* skip 3 bytes when p[2] > 1, since no start code can begin at p, p + 1 or p + 2 */
+static const uint8_t* searchStartCodeC(const uint8_t* begin, const uint8_t* end)
+{
+    const uint8_t* p = begin;
+    while (end - p >= 3) {
+        if (p[2] > 1)
+            p += 3;
+        else if (p[1])
+            p += 2;
+        else if (p[0] || p[2] != 1)
+            p++;
+        else
+            return p;
+    }
+    return end;
+}
+
+#ifdef STARTCODE_X86
+
+#if defined(__SSE2__)
+static const uint8_t* searchStartCodeSSE2(const uint8_t* begin, const uint8_t* end)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    const uint8_t* p = begin;
+    /* mask bit i is set when p[i], p[i + 1], p[i + 2] is 0x00, 0x00, 0x01 */
+    for (; end - p >= 18; p += 16) {
+        __m128i b0 = _mm_loadu_si128((const __m128i*)p);
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(p + 1));
+        __m128i b2 = _mm_loadu_si128((const __m128i*)(p + 2));
+        __m128i m = _mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero));
+        m = _mm_and_si128(m, _mm_cmpeq_epi8(b2, one));
+        int mask = _mm_movemask_epi8(m);
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return searchStartCodeC(p, end);
+}
+#endif
+
+__attribute__((target("avx2"))) static const uint8_t* searchStartCodeAVX2(const uint8_t* begin, const uint8_t* end)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    const uint8_t* p = begin;
+    for (; end - p >= 34; p += 32) {
+        __m256i b0 = _mm256_loadu_si256((const __m256i*)p);
+        __m256i b1 = _mm256_loadu_si256((const __m256i*)(p + 1));
+        __m256i b2 = _mm256_loadu_si256((const __m256i*)(p + 2));
+        __m256i m = _mm256_and_si256(_mm256_cmpeq_epi8(b0, zero), _mm256_cmpeq_epi8(b1, zero));
+        m = _mm256_and_si256(m, _mm256_cmpeq_epi8(b2, one));
+        uint32_t mask = _mm256_movemask_epi8(m);
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return searchStartCodeC(p, end);
+}
+
+static SearchStartCodeFunc getBestSearchStartCodeFunc()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return searchStartCodeAVX2;
+#if defined(__SSE2__)
+    return searchStartCodeSSE2;
+#else
+    return searchStartCodeC;
+#endif
+}
+
+#endif //STARTCODE_X86
+
+const uint8_t* searchStartCode(const uint8_t* begin, const uint8_t* end)
+{
+#ifdef STARTCODE_X86
+    static const SearchStartCodeFunc search = getBestSearchStartCodeFunc();
+    return search(begin, end);
+#else
+    return searchStartCodeC(begin, end);
+#endif
+}
+
+SearchStartCodeFunc getSearchStartCodeFunc(StartCodeSearchType type)
+{
+    switch (type) {
+    case START_CODE_SEARCH_C:
+        return searchStartCodeC;
+#if defined(STARTCODE_X86) && defined(__SSE2__)
+    case START_CODE_SEARCH_SSE2:
+        return searchStartCodeSSE2;
+#endif
+#ifdef STARTCODE_X86
+    case START_CODE_SEARCH_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? searchStartCodeAVX2 : NULL;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+} //namespace YamiMediaCodec
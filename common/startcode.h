@@ -0,0 +1,43 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef startcode_h
+#define startcode_h
+
+#include <stdint.h>
+
+namespace YamiMediaCodec {
+
+/* search the 0x00 0x00 0x01 start code prefix in [begin, end),
+ * return the address of the first prefix byte, or end if not found.
+ * It uses SSE2/AVX2 when the cpu supports them. */
+const uint8_t* searchStartCode(const uint8_t* begin, const uint8_t* end);
+
+enum StartCodeSearchType {
+    START_CODE_SEARCH_C,
+    START_CODE_SEARCH_SSE2,
+    START_CODE_SEARCH_AVX2
+};
+
+typedef const uint8_t* (*SearchStartCodeFunc)(const uint8_t* begin, const uint8_t* end);
+
+/* one implementation of searchStartCode, for tests and benchmarks.
+ * return NULL if it is not built in or the cpu does not support it. */
+SearchStartCodeFunc getSearchStartCodeFunc(StartCodeSearchType type);
+
+} //namespace YamiMediaCodec
+
+#endif //startcode_h
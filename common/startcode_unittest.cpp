@@ -0,0 +1,147 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// primary header
+#include "startcode.h"
+
+// library headers
+#include "common/unittest.h"
+
+// system headers
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+#define STARTCODE_TEST(name) \
+    TEST(StartCodeTest, name)
+
+static const uint8_t* stdSearch(const uint8_t* begin, const uint8_t* end)
+{
+    static const uint8_t startCode[] = { 0, 0, 1 };
+    return std::search(begin, end, startCode, startCode + 3);
+}
+
+STARTCODE_TEST(Empty)
+{
+    const uint8_t data[] = { 0 };
+    EXPECT_EQ(data, searchStartCode(data, data));
+    EXPECT_EQ(data + 1, searchStartCode(data, data + 1));
+}
+
+STARTCODE_TEST(Simple)
+{
+    const uint8_t data[] = {
+        0x00, 0x00, 0x00, 0x01, 0xff,
+        0x00, 0x01, 0x00, 0x00, 0x01
+    };
+    const uint8_t* end = data + sizeof(data);
+    const uint8_t* p = searchStartCode(data, end);
+    EXPECT_EQ(data + 1, p);
+    p = searchStartCode(p + 3, end);
+    EXPECT_EQ(data + 7, p);
+    EXPECT_EQ(end, searchStartCode(p + 1, end));
+}
+
+STARTCODE_TEST(MatchStdSearch)
+{
+    //values in [0, 3] to get many partial start codes
+    std::vector<uint8_t> data(4096);
+    srand(0x1234);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = (rand() % 5) ? 0 : (rand() & 3);
+
+    const uint8_t* end = &data[0] + data.size();
+    for (size_t offset = 0; offset < 64; offset++) {
+        const uint8_t* p = &data[0] + offset;
+        while (p != end) {
+            const uint8_t* expected = stdSearch(p, end);
+            ASSERT_EQ(expected, searchStartCode(p, end));
+            p = (expected == end) ? end : expected + 1;
+        }
+    }
+}
+
+STARTCODE_TEST(NoStartCode)
+{
+    std::vector<uint8_t> data(1000, 0);
+    const uint8_t* end = &data[0] + data.size();
+    EXPECT_EQ(end, searchStartCode(&data[0], end));
+
+    //start code at the last 3 bytes
+    data[data.size() - 1] = 1;
+    for (size_t i = 0; i < 64; i++)
+        EXPECT_EQ(end - 3, searchStartCode(&data[0] + i, end));
+}
+
+//run every implementation on the same inputs, not only the dispatched one
+static void checkSearch(SearchStartCodeFunc search)
+{
+    std::vector<uint8_t> data(4096);
+    srand(0x5678);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = (rand() % 5) ? 0 : (rand() & 3);
+
+    const uint8_t* end = &data[0] + data.size();
+    for (size_t offset = 0; offset < 64; offset++) {
+        const uint8_t* p = &data[0] + offset;
+        while (p != end) {
+            const uint8_t* expected = stdSearch(p, end);
+            ASSERT_EQ(expected, search(p, end));
+            p = (expected == end) ? end : expected + 1;
+        }
+    }
+
+    std::vector<uint8_t> zeros(1000, 0);
+    end = &zeros[0] + zeros.size();
+    EXPECT_EQ(end, search(&zeros[0], end));
+    zeros[zeros.size() - 1] = 1;
+    for (size_t i = 0; i < 64; i++)
+        EXPECT_EQ(end - 3, search(&zeros[0] + i, end));
+    //short inputs never reach the vector loop
+    for (size_t size = 0; size < 40; size++)
+        EXPECT_EQ(stdSearch(end - size, end), search(end - size, end));
+}
+
+STARTCODE_TEST(Scalar)
+{
+    SearchStartCodeFunc search = getSearchStartCodeFunc(START_CODE_SEARCH_C);
+    ASSERT_TRUE(search);
+    checkSearch(search);
+}
+
+STARTCODE_TEST(SSE2)
+{
+    SearchStartCodeFunc search = getSearchStartCodeFunc(START_CODE_SEARCH_SSE2);
+    if (!search)
+        return;
+    checkSearch(search);
+}
+
+STARTCODE_TEST(AVX2)
+{
+    SearchStartCodeFunc search = getSearchStartCodeFunc(START_CODE_SEARCH_AVX2);
+    if (!search)
+        return;
+    checkSearch(search);
+}
+
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Job dispatch benchmark for Thread and SerialQueue.
+ *
+ *     threadpoolbench [-s streams] [-n jobs] [-t pool threads]
+ *
+ * Every stream gets its own job queue, like a decoder or a v4l2 port does.
+ * Jobs are posted round robin to all streams from one thread, it runs the
+ * same load on one Thread per stream and on SerialQueues sharing a
+ * ThreadPool, reports jobs/sec, the post to run latency, and fails if a
+ * stream runs its jobs out of order.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// library headers
+#include "common/Functional.h"
+#include "common/Thread.h"
+#include "common/ThreadPool.h"
+
+// system headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace YamiMediaCodec;
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//jobs of one stream run one by one, so no lock is needed here
+struct Stream {
+    Stream()
+        : next(0)
+        , errors(0)
+        , latency(0)
+        , maxLatency(0)
+    {
+    }
+    void run(uint32_t seq, double posted)
+    {
+        double delay = now() - posted;
+        if (seq != next++)
+            errors++;
+        latency += delay;
+        if (delay > maxLatency)
+            maxLatency = delay;
+    }
+    uint32_t next;
+    uint32_t errors;
+    double latency;
+    double maxLatency;
+};
+
+class ThreadFactory {
+public:
+    Thread* create() { return new Thread("bench"); }
+    uint32_t threads(uint32_t streams) { return streams; }
+};
+
+class QueueFactory {
+public:
+    QueueFactory(uint32_t threads)
+        : m_pool(threads)
+    {
+    }
+    SerialQueue* create() { return new SerialQueue("bench", m_pool); }
+    uint32_t threads(uint32_t) { return m_pool.size(); }
+
+private:
+    ThreadPool m_pool;
+};
+
+template <class Queue, class Factory>
+static bool bench(const char* name, Factory& factory, uint32_t streams, uint32_t jobs)
+{
+    std::vector<Queue*> queues(streams);
+    std::vector<Stream> results(streams);
+    for (uint32_t i = 0; i < streams; i++) {
+        queues[i] = factory.create();
+        if (!queues[i]->start()) {
+            fprintf(stderr, "%s: failed to start\n", name);
+            return false;
+        }
+    }
+
+    double start = now();
+    for (uint32_t j = 0; j < jobs; j++) {
+        for (uint32_t i = 0; i < streams; i++)
+            queues[i]->post(std::bind(&Stream::run, &results[i], j, now()));
+    }
+    //stop waits for all jobs
+    for (uint32_t i = 0; i < streams; i++)
+        queues[i]->stop();
+    double elapsed = now() - start;
+    for (uint32_t i = 0; i < streams; i++)
+        delete queues[i];
+
+    uint32_t errors = 0, done = 0;
+    double latency = 0, maxLatency = 0;
+    for (uint32_t i = 0; i < streams; i++) {
+        const Stream& s = results[i];
+        errors += s.errors;
+        done += s.next;
+        latency += s.latency;
+        if (s.maxLatency > maxLatency)
+            maxLatency = s.maxLatency;
+    }
+    printf("%-12s %5u threads %10u jobs %8.3f s %12.0f jobs/sec %10.1f us avg %10.1f us max\n",
+        name, factory.threads(streams), done, elapsed, done / elapsed,
+        done ? latency / done * 1e6 : 0, maxLatency * 1e6);
+    if (done != streams * jobs) {
+        fprintf(stderr, "%s: %u jobs lost\n", name, streams * jobs - done);
+        return false;
+    }
+    if (errors) {
+        fprintf(stderr, "%s: %u jobs out of order\n", name, errors);
+        return false;
+    }
+    return true;
+}
+
+static void usage(const char* app)
+{
+    fprintf(stderr, "usage: %s [-s streams] [-n jobs] [-t pool threads]\n", app);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t streams = 64;
+    uint32_t jobs = 10000;
+    uint32_t threads = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:t:h")) != -1) {
+        switch (opt) {
+        case 's':
+            streams = atoi(optarg);
+            break;
+        case 'n':
+            jobs = atoi(optarg);
+            break;
+        case 't':
+            threads = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return -1;
+        }
+    }
+    if (!streams) {
+        usage(argv[0]);
+        return -1;
+    }
+    printf("%u streams, %u jobs per stream\n", streams, jobs);
+    ThreadFactory threadFactory;
+    QueueFactory queueFactory(threads);
+    bool ok = bench<Thread>("Thread", threadFactory, streams, jobs)
+        && bench<SerialQueue>("ThreadPool", queueFactory, streams, jobs);
+    return ok ? 0 : -1;
+}
@@ -258,6 +258,16 @@ void FpsCalc::log()
     }
     printf("\n");
 }
+uint64_t hashBytes(const void* data, size_t size, uint64_t hash)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
 void CalcFps::setAnchor()
 {
     m_timeStart = getSystemTime();
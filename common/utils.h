@@ -35,6 +35,12 @@ bool getPlaneResolution(uint32_t fourcc, uint32_t pixelWidth, uint32_t pixelHeig
 
 bool fillFrameRawData(VideoFrameRawData* frame, uint32_t fourcc, uint32_t width, uint32_t height, uint8_t* data);
 
+//64 bits FNV-1a hash, pass the last result as hash to continue with more data
+uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL);
+
+/// return system clock in ms
+uint64_t getSystemTime();
+
 class CalcFps
 {
   public:
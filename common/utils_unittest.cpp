@@ -210,3 +210,15 @@ UTILS_TEST(getPlaneResolution)
         EXPECT_FLOAT_EQ(e.bpp, bpp);
     }
 }
+
+UTILS_TEST(hashBytes)
+{
+    //reference values of 64 bits FNV-1a
+    EXPECT_EQ(0xcbf29ce484222325ULL, hashBytes(NULL, 0));
+    EXPECT_EQ(0xaf63dc4c8601ec8cULL, hashBytes("a", 1));
+    EXPECT_EQ(0x85944171f73967e8ULL, hashBytes("foobar", 6));
+
+    //hash can be chained
+    EXPECT_EQ(hashBytes("foobar", 6), hashBytes("bar", 3, hashBytes("foo", 3)));
+    EXPECT_NE(hashBytes("foobar", 6), hashBytes("foobaz", 6));
+}
@@ -16,8 +16,9 @@
 #ifndef videopool_h
 #define videopool_h
 #include "VideoCommonDefs.h"
-#include "common/lock.h"
+#include "common/IndexFreeList.h"
 #include <deque>
+#include <vector>
 
 namespace YamiMediaCodec{
 
@@ -26,51 +27,47 @@ class VideoPool : public EnableSharedFromThis<VideoPool<T> >
 {
 public:
     VideoPool(std::deque<SharedPtr<T> >& buffers)
+        : m_holder(buffers.begin(), buffers.end())
+        , m_freed(m_holder.size(), m_holder.size())
     {
-            m_holder.swap(buffers);
-            for (size_t i = 0; i < m_holder.size(); i++) {
-                m_freed.push_back(m_holder[i].get());
-            }
+        buffers.clear();
     }
 
     SharedPtr<T> alloc()
     {
         SharedPtr<T> ret;
-        AutoLock _l(m_lock);
-        if (!m_freed.empty()) {
-            T* p = m_freed.front();
-            m_freed.pop_front();
-            ret.reset(p, Recycler(this->shared_from_this()));
-        }
+        uint32_t index;
+        if (m_freed.pop(index))
+            ret.reset(m_holder[index].get(), Recycler(this->shared_from_this(), index));
         return ret;
     }
 
 private:
 
-    void recycle(T* ptr)
+    void recycle(uint32_t index)
     {
-        AutoLock _l(m_lock);
-        m_freed.push_back(ptr);
+        m_freed.push(index);
     }
 
     class Recycler
     {
     public:
-        Recycler(const SharedPtr<VideoPool<T> >& pool)
-            :m_pool(pool)
+        Recycler(const SharedPtr<VideoPool<T> >& pool, uint32_t index)
+            : m_pool(pool)
+            , m_index(index)
         {
         }
-        void operator()(T* ptr) const
+        void operator()(T*) const
         {
-            m_pool->recycle(ptr);
+            m_pool->recycle(m_index);
         }
     private:
         SharedPtr<VideoPool<T> > m_pool;
+        uint32_t m_index;
     };
 
-    Lock m_lock;
-    std::deque<T*> m_freed;
-    std::deque<SharedPtr<T> > m_holder;
+    std::vector<SharedPtr<T> > m_holder;
+    IndexFreeList m_freed;
 };
 
 };
@@ -4,6 +4,7 @@ include $(LOCAL_PATH)/../common.mk
 
 LOCAL_SRC_FILES := \
         vaapidecoder_base.cpp \
+        vaapidecoder_async.cpp \
         vaapidecoder_host.cpp \
         vaapidecsurfacepool.cpp \
         vaapidecpicture.cpp \
@@ -0,0 +1,352 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Decode throughput benchmark on the null VA driver.
+ *
+ *     decodebench [-n loops] <codec> <file|dir>...
+ *
+ * Decodes real bitstreams with createVideoDecoder() on a null display, so
+ * nothing is decoded and the time is the host side overhead: parsing, DPB,
+ * buffer creation and output reordering.  H.264, HEVC and MPEG-2 inputs are
+ * elementary streams, fed one start code unit per buffer like a client
+ * does, VP8 and VP9 inputs are IVF files fed one frame per buffer, and every
+ * JPEG input is one picture.  Output frames are returned as soon as they
+ * come out.  It reports frames/sec, the time per frame, the part of it spent
+ * in the driver, and the driver calls per frame.  Directories are scanned
+ * one level deep, every file is a new stream.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// library headers
+#include "common/common_def.h"
+#include "common/log.h"
+#include "common/startcode.h"
+#include "vaapi/VaapiNullDriver.h"
+#include "VideoDecoderHost.h"
+
+// system headers
+#include <algorithm>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <time.h>
+#include <vector>
+
+using namespace YamiMediaCodec;
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct Unit {
+    Unit(size_t o, size_t s)
+        : offset(o)
+        , size(s)
+    {
+    }
+    size_t offset;
+    size_t size;
+};
+
+typedef void (*SplitFunc)(const std::vector<uint8_t>& data, std::vector<Unit>& units);
+
+//one unit from every start code prefix to the next one
+static void splitStartCode(const std::vector<uint8_t>& data, std::vector<Unit>& units)
+{
+    if (data.empty())
+        return;
+    const uint8_t* begin = &data[0];
+    const uint8_t* end = begin + data.size();
+    const uint8_t* p = searchStartCode(begin, end);
+    while (p != end) {
+        const uint8_t* next = searchStartCode(p + 3, end);
+        units.push_back(Unit(p - begin, next - p));
+        p = next;
+    }
+}
+
+//frames of an IVF file, anything else is a single frame
+static void splitIvf(const std::vector<uint8_t>& data, std::vector<Unit>& units)
+{
+    size_t size = data.size();
+    if (size < 32 || memcmp(&data[0], "DKIF", 4)) {
+        if (size)
+            units.push_back(Unit(0, size));
+        return;
+    }
+    size_t pos = data[6] | (data[7] << 8);
+    while (pos + 12 <= size) {
+        const uint8_t* p = &data[pos];
+        size_t frameSize = p[0] | (p[1] << 8) | (p[2] << 16)
+            | ((uint32_t)p[3] << 24);
+        pos += 12;
+        if (frameSize > size - pos)
+            break;
+        units.push_back(Unit(pos, frameSize));
+        pos += frameSize;
+    }
+}
+
+static void splitPicture(const std::vector<uint8_t>& data, std::vector<Unit>& units)
+{
+    if (!data.empty())
+        units.push_back(Unit(0, data.size()));
+}
+
+struct Codec {
+    const char* name;
+    const char* mime;
+    SplitFunc split;
+};
+
+static const Codec g_codecs[] = {
+    { "h264", YAMI_MIME_H264, splitStartCode },
+    { "h265", YAMI_MIME_H265, splitStartCode },
+    { "mpeg2", YAMI_MIME_MPEG2, splitStartCode },
+    { "vp8", YAMI_MIME_VP8, splitIvf },
+    { "vp9", YAMI_MIME_VP9, splitIvf },
+    { "jpeg", YAMI_MIME_JPEG, splitPicture },
+};
+
+class Bench {
+public:
+    Bench()
+        : m_frames(0)
+        , m_units(0)
+        , m_bytes(0)
+        , m_errors(0)
+    {
+    }
+
+    //decode one stream, the decoder is flushed at the end of it
+    bool run(IVideoDecoder* decoder, const std::vector<uint8_t>& data,
+        const std::vector<Unit>& units)
+    {
+        for (size_t i = 0; i < units.size(); i++) {
+            VideoDecodeBuffer buffer;
+            memset(&buffer, 0, sizeof(buffer));
+            buffer.data = const_cast<uint8_t*>(&data[units[i].offset]);
+            buffer.size = units[i].size;
+            buffer.timeStamp = m_units;
+            if (!decode(decoder, buffer))
+                return false;
+            m_units++;
+            m_bytes += buffer.size;
+        }
+        decoder->decode(NULL);
+        drain(decoder);
+        return true;
+    }
+
+    void report(const char* name, double elapsed, const NullDriverStats& stats) const
+    {
+        if (elapsed <= 0)
+            elapsed = 1e-9;
+        uint64_t driverNs = 0;
+        for (int i = 0; i < NullDriverStats::CallMax; i++)
+            driverNs += stats.nanoseconds[i];
+        double frames = m_frames ? m_frames : 1;
+        printf("%s: %llu frames, %llu buffers, %llu bytes, %llu errors\n", name,
+            (unsigned long long)m_frames, (unsigned long long)m_units,
+            (unsigned long long)m_bytes, (unsigned long long)m_errors);
+        printf("%s: %.3f s, %.1f fps, %.1f us/frame, %.1f us/frame in the driver\n",
+            name, elapsed, m_frames / elapsed, elapsed / frames * 1e6,
+            driverNs / frames / 1e3);
+        printf("%s: per frame %.2f buffers created, %.2f maps, %.2f rendered, "
+               "%.1f slice bytes, %.2f surfaces created\n",
+            name, stats.count[NullDriverStats::CreateBuffer] / frames,
+            stats.count[NullDriverStats::MapBuffer] / frames,
+            stats.renderedBuffers / frames, stats.renderedSliceBytes / frames,
+            stats.count[NullDriverStats::CreateSurfaces] / frames);
+    }
+
+    uint64_t frames() const { return m_frames; }
+
+private:
+    bool decode(IVideoDecoder* decoder, VideoDecodeBuffer& buffer)
+    {
+        while (true) {
+            YamiStatus status = decoder->decode(&buffer);
+            //all output frames were returned, it will not get better
+            if (status == YAMI_DECODE_NO_SURFACE && !drain(decoder)) {
+                ERROR("no surface, %llu frames out", (unsigned long long)m_frames);
+                return false;
+            }
+            if (status != YAMI_DECODE_NO_SURFACE && status != YAMI_DECODE_FORMAT_CHANGE) {
+                if (status != YAMI_SUCCESS)
+                    m_errors++;
+                drain(decoder);
+                return true;
+            }
+        }
+    }
+
+    //return surfaces like a client does, true if we got any
+    bool drain(IVideoDecoder* decoder)
+    {
+        bool got = false;
+        while (decoder->getOutput()) {
+            m_frames++;
+            got = true;
+        }
+        return got;
+    }
+
+    uint64_t m_frames;
+    uint64_t m_units;
+    uint64_t m_bytes;
+    uint64_t m_errors;
+};
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& buf)
+{
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp)
+        return false;
+    buf.clear();
+    uint8_t chunk[64 * 1024];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+        buf.insert(buf.end(), chunk, chunk + n);
+    bool ok = !ferror(fp);
+    fclose(fp);
+    return ok;
+}
+
+static void listInputs(const std::string& path, std::vector<std::string>& files)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) || !S_ISDIR(st.st_mode)) {
+        files.push_back(path);
+        return;
+    }
+    DIR* dir = opendir(path.c_str());
+    if (!dir)
+        return;
+    std::vector<std::string> entries;
+    struct dirent* entry;
+    while ((entry = readdir(dir))) {
+        if (entry->d_name[0] == '.')
+            continue;
+        std::string name = path + "/" + entry->d_name;
+        if (!stat(name.c_str(), &st) && S_ISREG(st.st_mode))
+            entries.push_back(name);
+    }
+    closedir(dir);
+    std::sort(entries.begin(), entries.end());
+    files.insert(files.end(), entries.begin(), entries.end());
+}
+
+static void usage(const char* app)
+{
+    fprintf(stderr, "usage: %s [-n loops] <codec> <file|dir>...\ncodecs:", app);
+    for (size_t i = 0; i < N_ELEMENTS(g_codecs); i++)
+        fprintf(stderr, " %s", g_codecs[i].name);
+    fprintf(stderr, "\n");
+}
+
+static bool benchCodec(VADisplay display, const Codec& codec,
+    const std::vector<std::string>& files, uint32_t loops)
+{
+    IVideoDecoder* decoder = createVideoDecoder(codec.mime);
+    if (!decoder) {
+        ERROR("%s is not built in", codec.name);
+        return false;
+    }
+    NativeDisplay native = { (intptr_t)display, NATIVE_DISPLAY_VA };
+    decoder->setNativeDisplay(&native);
+    VideoConfigBuffer config;
+    memset(&config, 0, sizeof(config));
+    config.profile = VAProfileNone;
+    bool ok = decoder->start(&config) == YAMI_SUCCESS;
+    if (!ok)
+        ERROR("failed to start %s decoder", codec.name);
+
+    Bench bench;
+    std::vector<uint8_t> buf;
+    std::vector<Unit> units;
+    double elapsed = 0;
+    resetNullDriverStats(display);
+    for (size_t i = 0; ok && i < files.size(); i++) {
+        if (!readFile(files[i], buf)) {
+            ERROR("failed to read %s", files[i].c_str());
+            ok = false;
+            break;
+        }
+        units.clear();
+        codec.split(buf, units);
+        for (uint32_t n = 0; ok && n < loops; n++) {
+            double start = now();
+            ok = bench.run(decoder, buf, units);
+            elapsed += now() - start;
+        }
+    }
+    NullDriverStats stats;
+    getNullDriverStats(display, stats);
+    decoder->stop();
+    releaseVideoDecoder(decoder);
+    if (ok)
+        bench.report(codec.name, elapsed, stats);
+    return ok && bench.frames();
+}
+
+int main(int argc, char** argv)
+{
+    int arg = 1;
+    uint32_t loops = 1;
+    if (arg + 1 < argc && !strcmp(argv[arg], "-n")) {
+        loops = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if (arg + 1 >= argc || !loops) {
+        usage(argv[0]);
+        return -1;
+    }
+    const Codec* codec = NULL;
+    for (size_t i = 0; i < N_ELEMENTS(g_codecs); i++) {
+        if (!strcmp(argv[arg], g_codecs[i].name))
+            codec = &g_codecs[i];
+    }
+    if (!codec) {
+        usage(argv[0]);
+        return -1;
+    }
+
+    std::vector<std::string> files;
+    for (int i = arg + 1; i < argc; i++)
+        listInputs(argv[i], files);
+
+    VADisplay display = createNullDisplay();
+    if (!display) {
+        ERROR("failed to create the null display");
+        return -1;
+    }
+    bool ok = benchCodec(display, *codec, files, loops);
+    //cached sessions hold the display
+    releaseVideoDecoderCache();
+    destroyNullDisplay(display);
+    return ok ? 0 : -1;
+}
@@ -24,6 +24,7 @@
 // library headers
 #include "codecparsers/jpegParser.h"
 #include "common/common_def.h"
+#include "common/utils.h"
 
 // system headers
 #include <cassert>
@@ -45,6 +46,39 @@ namespace YamiMediaCodec {
 
 #define JPEG_SURFACE_NUM 2
 
+//tell whether tables changed without keeping a copy of them
+static uint64_t hashTables(const QuantTables& tables)
+{
+    uint64_t hash = hashBytes(NULL, 0);
+    for (size_t i = 0; i < tables.size(); i++) {
+        const QuantTable::Shared& table = tables[i];
+        uint8_t valid = bool(table);
+        hash = hashBytes(&valid, sizeof(valid), hash);
+        if (valid)
+            hash = hashBytes(&table->values[0], sizeof(table->values), hash);
+    }
+    return hash;
+}
+
+static uint64_t hashTables(uint64_t hash, const HuffTables& tables)
+{
+    for (size_t i = 0; i < tables.size(); i++) {
+        const HuffTable::Shared& table = tables[i];
+        uint8_t valid = bool(table);
+        hash = hashBytes(&valid, sizeof(valid), hash);
+        if (valid) {
+            hash = hashBytes(&table->codes[0], sizeof(table->codes), hash);
+            hash = hashBytes(&table->values[0], sizeof(table->values), hash);
+        }
+    }
+    return hash;
+}
+
+static uint64_t hashTables(const HuffTables& dcTables, const HuffTables& acTables)
+{
+    return hashTables(hashTables(hashBytes(NULL, 0), dcTables), acTables);
+}
+
 struct Slice {
     Slice() : data(NULL), start(0) , length(0) { }
 
@@ -67,24 +101,15 @@ public:
         , m_quantizationTables(Defaults::instance().quantTables())
         , m_slice()
         , m_decodeStatus(YAMI_SUCCESS)
-    {
-    }
-
-    YamiStatus decode(const uint8_t* data, const uint32_t size)
     {
         using namespace ::YamiParser::JPEG;
 
-        //this mainly for codec flush, jpeg/mjpeg do not have to flush.
-        //just return success for this
-        if (!data || !size)
-            return YAMI_SUCCESS;
-
+        //parser and its callbacks are reused for all frames
         Parser::Callback defaultCallback =
             bind(&Impl::onMarker, ref(*this));
         Parser::Callback sofCallback =
             bind(&Impl::onStartOfFrame, ref(*this));
-        m_slice.data = data;
-        m_parser.reset(new Parser(data, size));
+        m_parser.reset(new Parser(NULL, 0));
         m_parser->registerCallback(M_SOI, defaultCallback);
         m_parser->registerCallback(M_EOI, defaultCallback);
         m_parser->registerCallback(M_SOS, defaultCallback);
@@ -92,6 +117,22 @@ public:
         m_parser->registerCallback(M_DQT, defaultCallback);
         m_parser->registerStartOfFrameCallback(sofCallback);
 
+        m_quantTablesHash = hashTables(m_quantizationTables);
+        m_huffTablesHash = hashTables(m_dcHuffmanTables, m_acHuffmanTables);
+    }
+
+    YamiStatus decode(const uint8_t* data, const uint32_t size)
+    {
+        using namespace ::YamiParser::JPEG;
+
+        //this mainly for codec flush, jpeg/mjpeg do not have to flush.
+        //just return success for this
+        if (!data || !size)
+            return YAMI_SUCCESS;
+
+        m_slice.data = data;
+        m_parser->reset(data, size);
+
         if (!m_parser->parse())
             m_decodeStatus = YAMI_FAIL;
 
@@ -113,10 +154,17 @@ public:
         return m_parser->restartInterval();
     }
 
+    const std::vector<uint32_t>& restartOffsets() const
+    {
+        return m_parser->restartOffsets();
+    }
+
     const HuffTables& dcHuffmanTables() const { return m_dcHuffmanTables; }
     const HuffTables& acHuffmanTables() const { return m_acHuffmanTables; }
     const QuantTables& quantTables() const { return m_quantizationTables; }
     const Slice& slice() const { return m_slice; }
+    uint64_t quantTablesHash() const { return m_quantTablesHash; }
+    uint64_t huffTablesHash() const { return m_huffTablesHash; }
 
 private:
     Parser::CallbackResult onMarker()
@@ -145,10 +193,12 @@ private:
             break;
         case M_DQT:
             m_quantizationTables = m_parser->quantTables();
+            m_quantTablesHash = hashTables(m_quantizationTables);
             break;
         case M_DHT:
             m_dcHuffmanTables = m_parser->dcHuffTables();
             m_acHuffmanTables = m_parser->acHuffTables();
+            m_huffTablesHash = hashTables(m_dcHuffmanTables, m_acHuffmanTables);
             break;
         default:
             m_decodeStatus = YAMI_FAIL;
@@ -174,6 +224,8 @@ private:
     HuffTables m_dcHuffmanTables;
     HuffTables m_acHuffmanTables;
     QuantTables m_quantizationTables;
+    uint64_t m_quantTablesHash;
+    uint64_t m_huffTablesHash;
 
     Slice m_slice;
 
@@ -184,6 +236,10 @@ VaapiDecoderJPEG::VaapiDecoderJPEG()
     : VaapiDecoderBase::VaapiDecoderBase()
     , m_impl()
     , m_picture()
+    , m_iqMatrixValid(false)
+    , m_iqMatrixHash(0)
+    , m_huffmanTableValid(false)
+    , m_huffmanTableHash(0)
 {
     return;
 }
@@ -218,14 +274,14 @@ YamiStatus VaapiDecoderJPEG::fillPictureParam()
     return YAMI_SUCCESS;
 }
 
-YamiStatus VaapiDecoderJPEG::fillSliceParam()
+YamiStatus VaapiDecoderJPEG::fillSliceParam(uint32_t offset, uint32_t size,
+    uint32_t firstMcu, uint32_t numMcus, uint32_t mcusPerRow)
 {
     const ScanHeader::Shared scan = m_impl->scanHeader();
-    const FrameHeader::Shared frame = m_impl->frameHeader();
     const Slice& slice = m_impl->slice();
     VASliceParameterBufferJPEGBaseline *sliceParam(NULL);
 
-    if (!m_picture->newSlice(sliceParam, slice.data + slice.start, slice.length))
+    if (!m_picture->newSlice(sliceParam, slice.data + offset, size))
         return YAMI_FAIL;
 
     for (size_t i(0); i < scan->numComponents; ++i) {
@@ -239,8 +295,20 @@ YamiStatus VaapiDecoderJPEG::fillSliceParam()
 
     sliceParam->restart_interval = m_impl->restartInterval();
     sliceParam->num_components = scan->numComponents;
-    sliceParam->slice_horizontal_position = 0;
-    sliceParam->slice_vertical_position = 0;
+    sliceParam->slice_horizontal_position = firstMcu % mcusPerRow;
+    sliceParam->slice_vertical_position = firstMcu / mcusPerRow;
+    sliceParam->num_mcus = numMcus;
+
+    return YAMI_SUCCESS;
+}
+
+YamiStatus VaapiDecoderJPEG::fillSliceParam()
+{
+    using namespace ::YamiParser::JPEG;
+
+    const ScanHeader::Shared scan = m_impl->scanHeader();
+    const FrameHeader::Shared frame = m_impl->frameHeader();
+    const Slice& slice = m_impl->slice();
 
     int width = frame->imageWidth;
     int height = frame->imageHeight;
@@ -264,7 +332,33 @@ YamiStatus VaapiDecoderJPEG::fillSliceParam()
         codedHeight = (height + maxVSample - 1) / maxVSample;
     }
 
-    sliceParam->num_mcus = codedWidth * codedHeight;
+    const uint32_t numMcus = codedWidth * codedHeight;
+    const uint32_t interval = m_impl->restartInterval();
+    const std::vector<uint32_t>& offsets = m_impl->restartOffsets();
+
+    //one slice per restart interval, but only when the markers agree with
+    //DRI. Otherwise the driver gets the whole scan and handles RSTn itself.
+    bool split = codedWidth > 0 && interval && !offsets.empty()
+        && offsets.size() == (numMcus + interval - 1) / interval - 1;
+    for (size_t i(0); split && i < offsets.size(); ++i)
+        split = slice.data[offsets[i] + 1] == M_RST0 + (i & 7);
+
+    if (!split)
+        return fillSliceParam(slice.start, slice.length, 0, numMcus, std::max(codedWidth, 1));
+
+    const uint32_t end = slice.start + slice.length;
+    uint32_t start = slice.start;
+    for (size_t i(0); i <= offsets.size(); ++i) {
+        const uint32_t next = (i < offsets.size()) ? offsets[i] : end;
+        const uint32_t firstMcu = i * interval;
+        if (next <= start || next > end)
+            return YAMI_FAIL;
+        YamiStatus status = fillSliceParam(start, next - start, firstMcu,
+            std::min(interval, numMcus - firstMcu), codedWidth);
+        if (status != YAMI_SUCCESS)
+            return status;
+        start = next + 2;
+    }
 
     return YAMI_SUCCESS;
 }
@@ -278,19 +372,29 @@ YamiStatus VaapiDecoderJPEG::loadQuantizationTables()
     if (!m_picture->editIqMatrix(vaIqMatrix))
         return YAMI_FAIL;
 
+    //most mjpeg streams use the same tables for all frames
+    if (m_iqMatrixValid && m_iqMatrixHash == m_impl->quantTablesHash()) {
+        *vaIqMatrix = m_iqMatrix;
+        return YAMI_SUCCESS;
+    }
+
+    memset(&m_iqMatrix, 0, sizeof(m_iqMatrix));
     size_t numTables = std::min(
-        N_ELEMENTS(vaIqMatrix->quantiser_table), size_t(NUM_QUANT_TBLS));
+        N_ELEMENTS(m_iqMatrix.quantiser_table), size_t(NUM_QUANT_TBLS));
 
     for (size_t i(0); i < numTables; ++i) {
         const QuantTable::Shared& quantTable = m_impl->quantTables()[i];
-        vaIqMatrix->load_quantiser_table[i] = bool(quantTable);
+        m_iqMatrix.load_quantiser_table[i] = bool(quantTable);
         if (!quantTable)
             continue;
         assert(quantTable->precision == 0);
         for (uint32_t j(0); j < DCTSIZE2; ++j)
-            vaIqMatrix->quantiser_table[i][j] = quantTable->values[j];
+            m_iqMatrix.quantiser_table[i][j] = quantTable->values[j];
     }
+    m_iqMatrixHash = m_impl->quantTablesHash();
+    m_iqMatrixValid = true;
 
+    *vaIqMatrix = m_iqMatrix;
     return YAMI_SUCCESS;
 }
 
@@ -303,37 +407,47 @@ YamiStatus VaapiDecoderJPEG::loadHuffmanTables()
     if (!m_picture->editHufTable(vaHuffmanTable))
         return YAMI_FAIL;
 
+    if (m_huffmanTableValid && m_huffmanTableHash == m_impl->huffTablesHash()) {
+        *vaHuffmanTable = m_huffmanTable;
+        return YAMI_SUCCESS;
+    }
+
+    memset(&m_huffmanTable, 0, sizeof(m_huffmanTable));
     size_t numTables = std::min(
-        N_ELEMENTS(vaHuffmanTable->huffman_table), size_t(NUM_HUFF_TBLS));
+        N_ELEMENTS(m_huffmanTable.huffman_table), size_t(NUM_HUFF_TBLS));
 
     for (size_t i(0); i < numTables; ++i) {
         const HuffTable::Shared& dcTable = m_impl->dcHuffmanTables()[i];
         const HuffTable::Shared& acTable = m_impl->acHuffmanTables()[i];
         bool valid = bool(dcTable) && bool(acTable);
-        vaHuffmanTable->load_huffman_table[i] = valid;
+        m_huffmanTable.load_huffman_table[i] = valid;
         if (!valid)
             continue;
 
         // Load DC Table
-        memcpy(vaHuffmanTable->huffman_table[i].num_dc_codes,
+        memcpy(m_huffmanTable.huffman_table[i].num_dc_codes,
             &dcTable->codes[0],
-            sizeof(vaHuffmanTable->huffman_table[i].num_dc_codes));
-        memcpy(vaHuffmanTable->huffman_table[i].dc_values,
+            sizeof(m_huffmanTable.huffman_table[i].num_dc_codes));
+        memcpy(m_huffmanTable.huffman_table[i].dc_values,
             &dcTable->values[0],
-            sizeof(vaHuffmanTable->huffman_table[i].dc_values));
+            sizeof(m_huffmanTable.huffman_table[i].dc_values));
 
         // Load AC Table
-        memcpy(vaHuffmanTable->huffman_table[i].num_ac_codes,
+        memcpy(m_huffmanTable.huffman_table[i].num_ac_codes,
             &acTable->codes[0],
-            sizeof(vaHuffmanTable->huffman_table[i].num_ac_codes));
-        memcpy(vaHuffmanTable->huffman_table[i].ac_values,
+            sizeof(m_huffmanTable.huffman_table[i].num_ac_codes));
+        memcpy(m_huffmanTable.huffman_table[i].ac_values,
             &acTable->values[0],
-            sizeof(vaHuffmanTable->huffman_table[i].ac_values));
+            sizeof(m_huffmanTable.huffman_table[i].ac_values));
 
-        memset(vaHuffmanTable->huffman_table[i].pad,
-                0, sizeof(vaHuffmanTable->huffman_table[i].pad));
+        memset(m_huffmanTable.huffman_table[i].pad,
+                0, sizeof(m_huffmanTable.huffman_table[i].pad));
     }
 
+    m_huffmanTableHash = m_impl->huffTablesHash();
+    m_huffmanTableValid = true;
+
+    *vaHuffmanTable = m_huffmanTable;
     return YAMI_SUCCESS;
 }
 
@@ -472,6 +586,8 @@ YamiStatus VaapiDecoderJPEG::reset(VideoConfigBuffer* buffer)
     m_picture.reset();
 
     m_impl.reset();
+    m_iqMatrixValid = false;
+    m_huffmanTableValid = false;
 
     return VaapiDecoderBase::reset(buffer);
 }
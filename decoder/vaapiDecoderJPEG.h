@@ -41,6 +41,8 @@ private:
 
     YamiStatus fillPictureParam();
     YamiStatus fillSliceParam();
+    YamiStatus fillSliceParam(uint32_t offset, uint32_t size,
+        uint32_t firstMcu, uint32_t numMcus, uint32_t mcusPerRow);
 
     YamiStatus loadQuantizationTables();
     YamiStatus loadHuffmanTables();
@@ -52,6 +54,14 @@ private:
     SharedPtr<VaapiDecoderJPEG::Impl> m_impl;
     PicturePtr m_picture;
 
+    //va tables of last frame, rebuilt only when parsed tables changed
+    VAIQMatrixBufferJPEGBaseline m_iqMatrix;
+    bool m_iqMatrixValid;
+    uint64_t m_iqMatrixHash;
+    VAHuffmanTableBufferJPEGBaseline m_huffmanTable;
+    bool m_huffmanTableValid;
+    uint64_t m_huffmanTableHash;
+
     /**
      * VaapiDecoderFactory registration result. This decoder is registered in
      * vaapidecoder_host.cpp
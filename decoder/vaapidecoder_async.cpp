@@ -0,0 +1,377 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "vaapidecoder_async.h"
+
+#include "common/Functional.h"
+#include "common/log.h"
+
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace YamiMediaCodec {
+
+using std::bind;
+using std::ref;
+
+/* frames given to client hold a tracker, so the decoder can retry a waiting
+ * input when one comes back. stop() detaches the decoder from tracker,
+ * frames released after it only give the surface back.
+ */
+class VaapiDecoderAsync::FrameTracker {
+public:
+    explicit FrameTracker(VaapiDecoderAsync* owner)
+        : m_owner(owner)
+    {
+    }
+    void notify()
+    {
+        AutoLock lock(m_lock);
+        if (m_owner)
+            m_owner->onFrameReturned();
+    }
+    void detach()
+    {
+        AutoLock lock(m_lock);
+        m_owner = NULL;
+    }
+
+private:
+    Lock m_lock;
+    VaapiDecoderAsync* m_owner;
+    DISALLOW_COPY_AND_ASSIGN(FrameTracker);
+};
+
+struct VaapiDecoderAsync::FrameReturner {
+    FrameReturner(const SharedPtr<VideoFrame>& frame, const SharedPtr<FrameTracker>& tracker)
+        : m_frame(frame)
+        , m_tracker(tracker)
+    {
+    }
+    void operator()(VideoFrame*)
+    {
+        //give the surface back before we wake up the decoder
+        m_frame.reset();
+        m_tracker->notify();
+    }
+
+private:
+    SharedPtr<VideoFrame> m_frame;
+    SharedPtr<FrameTracker> m_tracker;
+};
+
+VaapiDecoderAsync::VaapiDecoderAsync(IVideoDecoder* decoder)
+    : m_decoder(decoder)
+    , m_listener(NULL)
+    , m_thread("yami_async_decoder")
+    , m_eventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , m_generation(0)
+    , m_decoding(false)
+    , m_waitSurface(false)
+    , m_surfaceReturned(false)
+    , m_formatValid(false)
+{
+    if (m_eventFd < 0)
+        ERROR("create eventfd failed");
+    memset(&m_format, 0, sizeof(m_format));
+    memset(&m_clientFormat, 0, sizeof(m_clientFormat));
+}
+
+VaapiDecoderAsync::~VaapiDecoderAsync()
+{
+    stop();
+    if (m_eventFd >= 0)
+        close(m_eventFd);
+}
+
+YamiStatus VaapiDecoderAsync::start(VideoConfigBuffer* buffer)
+{
+    if (!m_thread.start()) {
+        ERROR("start decoder thread failed");
+        return YAMI_FAIL;
+    }
+    {
+        AutoLock lock(m_lock);
+        m_tracker.reset(new FrameTracker(this));
+    }
+    YamiStatus status = YAMI_FAIL;
+    m_thread.send(bind(&VaapiDecoderAsync::startJob, this, buffer, ref(status)));
+    if (status != YAMI_SUCCESS)
+        stop();
+    return status;
+}
+
+void VaapiDecoderAsync::startJob(VideoConfigBuffer* buffer, YamiStatus& status)
+{
+    status = m_decoder->start(buffer);
+    updateFormat();
+}
+
+void VaapiDecoderAsync::stop()
+{
+    SharedPtr<FrameTracker> tracker;
+    std::deque<Input> input;
+    std::deque<SharedPtr<VideoFrame> > output;
+    {
+        AutoLock lock(m_lock);
+        tracker = m_tracker;
+        m_input.swap(input);
+        m_output.swap(output);
+        m_generation++;
+    }
+    if (!tracker)
+        return;
+    tracker->detach();
+    //frames in output are released after we unlock, they may call back to us.
+    output.clear();
+
+    m_thread.send(bind(&VaapiDecoderAsync::stopJob, this));
+    m_thread.stop();
+
+    AutoLock lock(m_lock);
+    m_tracker.reset();
+    m_decoding = false;
+    m_waitSurface = false;
+}
+
+void VaapiDecoderAsync::stopJob()
+{
+    m_decoder->stop();
+    updateFormat();
+}
+
+void VaapiDecoderAsync::flush()
+{
+    std::deque<Input> input;
+    std::deque<SharedPtr<VideoFrame> > output;
+    {
+        AutoLock lock(m_lock);
+        if (!m_tracker)
+            return;
+        m_input.swap(input);
+        m_output.swap(output);
+        m_generation++;
+    }
+    output.clear();
+    m_thread.send(bind(&VaapiDecoderAsync::flushJob, this));
+}
+
+void VaapiDecoderAsync::flushJob()
+{
+    m_decoder->flush();
+    std::deque<SharedPtr<VideoFrame> > output;
+    {
+        AutoLock lock(m_lock);
+        //frames delivered by a decodeJob ran before us
+        m_output.swap(output);
+        m_waitSurface = false;
+    }
+}
+
+YamiStatus VaapiDecoderAsync::decode(VideoDecodeBuffer* buffer)
+{
+    if (!buffer)
+        return YAMI_INVALID_PARAM;
+
+    Input input;
+    input.eos = !buffer->data || !buffer->size;
+    if (!input.eos)
+        input.data.assign(buffer->data, buffer->data + buffer->size);
+    input.timeStamp = buffer->timeStamp;
+    input.flag = buffer->flag;
+
+    AutoLock lock(m_lock);
+    if (!m_tracker) {
+        ERROR("decode before start()");
+        return YAMI_FAIL;
+    }
+    m_input.push_back(Input());
+    m_input.back().data.swap(input.data);
+    m_input.back().eos = input.eos;
+    m_input.back().timeStamp = input.timeStamp;
+    m_input.back().flag = input.flag;
+    if (!m_decoding && !m_waitSurface) {
+        m_decoding = true;
+        m_thread.post(bind(&VaapiDecoderAsync::decodeJob, this));
+    }
+    return YAMI_SUCCESS;
+}
+
+bool VaapiDecoderAsync::popInput(Input& input, uint32_t& generation)
+{
+    AutoLock lock(m_lock);
+    if (m_input.empty() || m_waitSurface) {
+        m_decoding = false;
+        return false;
+    }
+    Input& front = m_input.front();
+    input.data.swap(front.data);
+    input.eos = front.eos;
+    input.timeStamp = front.timeStamp;
+    input.flag = front.flag;
+    m_input.pop_front();
+    generation = m_generation;
+    m_surfaceReturned = false;
+    return true;
+}
+
+void VaapiDecoderAsync::decodeJob()
+{
+    Input input;
+    uint32_t generation;
+    while (popInput(input, generation)) {
+        YamiStatus status = decodeInput(input);
+        deliverOutput();
+        if (status == YAMI_DECODE_NO_SURFACE) {
+            AutoLock lock(m_lock);
+            //flushed while we were decoding
+            if (generation != m_generation)
+                continue;
+            m_input.push_front(Input());
+            Input& front = m_input.front();
+            front.data.swap(input.data);
+            front.eos = input.eos;
+            front.timeStamp = input.timeStamp;
+            front.flag = input.flag;
+            if (m_surfaceReturned)
+                continue;
+            DEBUG("no surface, wait for client to return a frame");
+            m_waitSurface = true;
+            m_decoding = false;
+            return;
+        }
+        if (status < YAMI_SUCCESS || status == YAMI_DECODE_INVALID_DATA) {
+            ERROR("decode failed, status = %d", status);
+            if (m_listener)
+                m_listener->onError(status, input.timeStamp);
+        }
+    }
+}
+
+YamiStatus VaapiDecoderAsync::decodeInput(Input& input)
+{
+    VideoDecodeBuffer buffer;
+    memset(&buffer, 0, sizeof(buffer));
+    if (!input.eos) {
+        buffer.data = &input.data[0];
+        buffer.size = input.data.size();
+    }
+    buffer.timeStamp = input.timeStamp;
+    buffer.flag = input.flag;
+
+    YamiStatus status = m_decoder->decode(&buffer);
+    if (status == YAMI_DECODE_FORMAT_CHANGE) {
+        //frames in old format go first
+        deliverOutput();
+        updateFormat();
+        if (m_listener)
+            m_listener->onFormatChange(m_decoder->getFormatInfo());
+        status = m_decoder->decode(&buffer);
+    }
+    updateFormat();
+    return status;
+}
+
+void VaapiDecoderAsync::deliverOutput()
+{
+    bool queued = false;
+    SharedPtr<VideoFrame> frame;
+    while ((frame = m_decoder->getOutput())) {
+        SharedPtr<VideoFrame> out(frame.get(), FrameReturner(frame, m_tracker));
+        if (m_listener) {
+            m_listener->onOutput(out);
+        }
+        else {
+            AutoLock lock(m_lock);
+            m_output.push_back(out);
+            queued = true;
+        }
+    }
+    if (queued && m_eventFd >= 0) {
+        uint64_t one = 1;
+        if (write(m_eventFd, &one, sizeof(one)) != sizeof(one))
+            ERROR("signal eventfd failed");
+    }
+}
+
+void VaapiDecoderAsync::updateFormat()
+{
+    const VideoFormatInfo* format = m_decoder->getFormatInfo();
+    AutoLock lock(m_lock);
+    m_formatValid = format != NULL;
+    if (format)
+        m_format = *format;
+}
+
+void VaapiDecoderAsync::onFrameReturned()
+{
+    AutoLock lock(m_lock);
+    m_surfaceReturned = true;
+    if (m_waitSurface) {
+        m_waitSurface = false;
+        if (!m_decoding) {
+            m_decoding = true;
+            m_thread.post(bind(&VaapiDecoderAsync::decodeJob, this));
+        }
+    }
+}
+
+SharedPtr<VideoFrame> VaapiDecoderAsync::getOutput()
+{
+    SharedPtr<VideoFrame> frame;
+    AutoLock lock(m_lock);
+    if (!m_output.empty()) {
+        frame = m_output.front();
+        m_output.pop_front();
+    }
+    return frame;
+}
+
+int VaapiDecoderAsync::getEventFd()
+{
+    return m_eventFd;
+}
+
+const VideoFormatInfo* VaapiDecoderAsync::getFormatInfo()
+{
+    AutoLock lock(m_lock);
+    if (!m_formatValid)
+        return NULL;
+    m_clientFormat = m_format;
+    return &m_clientFormat;
+}
+
+void VaapiDecoderAsync::setListener(IAsyncVideoDecoderListener* listener)
+{
+    m_listener = listener;
+}
+
+void VaapiDecoderAsync::setNativeDisplay(NativeDisplay* display)
+{
+    m_decoder->setNativeDisplay(display);
+}
+
+void VaapiDecoderAsync::setAllocator(SurfaceAllocator* allocator)
+{
+    m_decoder->setAllocator(allocator);
+}
+
+} //namespace YamiMediaCodec
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef vaapidecoder_async_h
+#define vaapidecoder_async_h
+
+#include "common/Thread.h"
+#include "common/lock.h"
+#include "VideoAsyncDecoderInterface.h"
+#include "VideoDecoderInterface.h"
+
+#include <deque>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+/**
+ * \class VaapiDecoderAsync
+ * \brief runs an #IVideoDecoder on its own thread, see #IAsyncVideoDecoder
+ *
+ * <pre>
+ * 1. decode() copies input to m_input and posts decodeJob() if it's not running.
+ * 2. decodeJob() feeds m_input to the decoder until it's empty, and delivers frames after each input.
+ * 3. YAMI_DECODE_FORMAT_CHANGE is reported to listener, then the same input is decoded again.
+ * 4. on YAMI_DECODE_NO_SURFACE the input is kept, and decodeJob() is posted again
+ *    when client releases one of our frames.
+ * </pre>
+ */
+class VaapiDecoderAsync : public IAsyncVideoDecoder {
+public:
+    /// takes ownership of @decoder
+    explicit VaapiDecoderAsync(IVideoDecoder* decoder);
+    virtual ~VaapiDecoderAsync();
+
+    virtual YamiStatus start(VideoConfigBuffer* buffer);
+    virtual void stop(void);
+    virtual void flush(void);
+    virtual YamiStatus decode(VideoDecodeBuffer* buffer);
+    virtual SharedPtr<VideoFrame> getOutput();
+    virtual int getEventFd();
+    virtual const VideoFormatInfo* getFormatInfo(void);
+    virtual void setListener(IAsyncVideoDecoderListener* listener);
+    virtual void setNativeDisplay(NativeDisplay* display);
+    virtual void setAllocator(SurfaceAllocator* allocator);
+
+private:
+    struct Input {
+        std::vector<uint8_t> data;
+        bool eos;
+        int64_t timeStamp;
+        uint32_t flag;
+    };
+    class FrameTracker;
+    struct FrameReturner;
+
+    //jobs run on m_thread
+    void startJob(VideoConfigBuffer* buffer, YamiStatus& status);
+    void stopJob();
+    void flushJob();
+    void decodeJob();
+
+    bool popInput(Input& input, uint32_t& generation);
+    YamiStatus decodeInput(Input& input);
+    void deliverOutput();
+    void updateFormat();
+    void onFrameReturned();
+
+    SharedPtr<IVideoDecoder> m_decoder;
+    IAsyncVideoDecoderListener* m_listener;
+    Thread m_thread;
+    SharedPtr<FrameTracker> m_tracker;
+    int m_eventFd;
+
+    Lock m_lock;
+    std::deque<Input> m_input;
+    //increased by flush and stop, so an input popped before can be dropped
+    uint32_t m_generation;
+    //decodeJob is posted or running
+    bool m_decoding;
+    //decodeJob stopped on YAMI_DECODE_NO_SURFACE
+    bool m_waitSurface;
+    //a frame came back while decodeJob was running
+    bool m_surfaceReturned;
+    std::deque<SharedPtr<VideoFrame> > m_output;
+    VideoFormatInfo m_format;
+    bool m_formatValid;
+    //copy of m_format for getFormatInfo(), only touched by client thread
+    VideoFormatInfo m_clientFormat;
+
+    DISALLOW_COPY_AND_ASSIGN(VaapiDecoderAsync);
+};
+
+} //namespace YamiMediaCodec
+
+#endif //vaapidecoder_async_h
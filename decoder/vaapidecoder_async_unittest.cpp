@@ -0,0 +1,295 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "common/unittest.h"
+
+// primary header
+#include "vaapidecoder_async.h"
+
+// library headers
+#include "common/lock.h"
+
+// system headers
+#include <deque>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+#define ASYNC_DECODER_TEST(name) \
+    TEST(AsyncDecoderTest, name)
+
+/* a decoder with @size frames, it outputs one frame per input and
+ * asks for a format change on first input. negative timestamp is invalid data.
+ */
+class MockDecoder : public IVideoDecoder {
+public:
+    MockDecoder(uint32_t size)
+        : m_frames(size)
+        , m_started(false)
+        , m_formatChanged(false)
+    {
+        for (uint32_t i = 0; i < size; i++)
+            m_free.push_back(&m_frames[i]);
+        memset(&m_format, 0, sizeof(m_format));
+    }
+    virtual YamiStatus start(VideoConfigBuffer*)
+    {
+        m_started = true;
+        return YAMI_SUCCESS;
+    }
+    virtual YamiStatus reset(VideoConfigBuffer*) { return YAMI_SUCCESS; }
+    virtual void stop() { m_started = false; }
+    virtual void flush() { m_output.clear(); }
+    virtual YamiStatus decode(VideoDecodeBuffer* buffer)
+    {
+        if (!buffer->data)
+            return YAMI_SUCCESS;
+        if (!m_formatChanged) {
+            m_formatChanged = true;
+            m_format.width = 320;
+            m_format.height = 240;
+            return YAMI_DECODE_FORMAT_CHANGE;
+        }
+        if (buffer->timeStamp < 0)
+            return YAMI_DECODE_INVALID_DATA;
+        VideoFrame* frame;
+        {
+            AutoLock lock(m_lock);
+            if (m_free.empty())
+                return YAMI_DECODE_NO_SURFACE;
+            frame = m_free.front();
+            m_free.pop_front();
+        }
+        frame->timeStamp = buffer->timeStamp;
+        m_output.push_back(SharedPtr<VideoFrame>(frame, Recycler(this)));
+        return YAMI_SUCCESS;
+    }
+    virtual SharedPtr<VideoFrame> getOutput()
+    {
+        SharedPtr<VideoFrame> frame;
+        if (!m_output.empty()) {
+            frame = m_output.front();
+            m_output.pop_front();
+        }
+        return frame;
+    }
+    virtual const VideoFormatInfo* getFormatInfo()
+    {
+        return m_formatChanged ? &m_format : NULL;
+    }
+    virtual void setNativeDisplay(NativeDisplay*) {}
+    virtual void setAllocator(SurfaceAllocator*) {}
+    virtual void releaseLock(bool) {}
+    virtual VADisplay getDisplayID() { return NULL; }
+
+private:
+    struct Recycler {
+        Recycler(MockDecoder* decoder)
+            : m_decoder(decoder)
+        {
+        }
+        void operator()(VideoFrame* frame)
+        {
+            AutoLock lock(m_decoder->m_lock);
+            m_decoder->m_free.push_back(frame);
+        }
+        MockDecoder* m_decoder;
+    };
+    std::vector<VideoFrame> m_frames;
+    Lock m_lock;
+    std::deque<VideoFrame*> m_free;
+    std::deque<SharedPtr<VideoFrame> > m_output;
+    VideoFormatInfo m_format;
+    bool m_started;
+    bool m_formatChanged;
+};
+
+class Listener : public IAsyncVideoDecoderListener {
+public:
+    Listener()
+        : m_formatChanges(0)
+    {
+    }
+    virtual void onOutput(const SharedPtr<VideoFrame>& frame)
+    {
+        AutoLock lock(m_lock);
+        m_frames.push_back(frame);
+    }
+    virtual void onFormatChange(const VideoFormatInfo* format)
+    {
+        AutoLock lock(m_lock);
+        EXPECT_EQ(320u, format->width);
+        m_formatChanges++;
+    }
+    virtual void onError(YamiStatus status, int64_t timeStamp)
+    {
+        AutoLock lock(m_lock);
+        EXPECT_EQ(YAMI_DECODE_INVALID_DATA, status);
+        m_errors.push_back(timeStamp);
+    }
+    //wait until we have @count frames, or timeout
+    bool waitFrames(size_t count)
+    {
+        for (int i = 0; i < 1000; i++) {
+            {
+                AutoLock lock(m_lock);
+                if (m_frames.size() >= count)
+                    return m_frames.size() == count;
+            }
+            usleep(1000);
+        }
+        return false;
+    }
+
+    Lock m_lock;
+    std::deque<SharedPtr<VideoFrame> > m_frames;
+    std::vector<int64_t> m_errors;
+    int m_formatChanges;
+};
+
+static YamiStatus decodeOne(IAsyncVideoDecoder& decoder, int64_t timeStamp)
+{
+    uint8_t data[16] = { 0 };
+    VideoDecodeBuffer buffer;
+    memset(&buffer, 0, sizeof(buffer));
+    buffer.data = data;
+    buffer.size = sizeof(data);
+    buffer.timeStamp = timeStamp;
+    return decoder.decode(&buffer);
+}
+
+static bool waitEvent(int fd)
+{
+    struct pollfd p;
+    p.fd = fd;
+    p.events = POLLIN;
+    if (poll(&p, 1, 1000) != 1)
+        return false;
+    uint64_t count;
+    return read(fd, &count, sizeof(count)) == sizeof(count);
+}
+
+ASYNC_DECODER_TEST(EventFdQueue)
+{
+    VaapiDecoderAsync decoder(new MockDecoder(8));
+    VideoConfigBuffer config;
+    memset(&config, 0, sizeof(config));
+
+    EXPECT_EQ(YAMI_FAIL, decodeOne(decoder, 0));
+    ASSERT_EQ(YAMI_SUCCESS, decoder.start(&config));
+    EXPECT_FALSE(decoder.getFormatInfo());
+
+    for (int i = 0; i < 3; i++)
+        EXPECT_EQ(YAMI_SUCCESS, decodeOne(decoder, i));
+    std::vector<SharedPtr<VideoFrame> > frames;
+    while (frames.size() < 3) {
+        ASSERT_TRUE(waitEvent(decoder.getEventFd()));
+        SharedPtr<VideoFrame> frame;
+        while ((frame = decoder.getOutput()))
+            frames.push_back(frame);
+    }
+    for (int i = 0; i < 3; i++)
+        EXPECT_EQ(i, frames[i]->timeStamp);
+
+    const VideoFormatInfo* format = decoder.getFormatInfo();
+    ASSERT_TRUE(format);
+    EXPECT_EQ(240u, format->height);
+    decoder.stop();
+}
+
+ASYNC_DECODER_TEST(WaitSurface)
+{
+    VaapiDecoderAsync decoder(new MockDecoder(2));
+    Listener listener;
+    decoder.setListener(&listener);
+    VideoConfigBuffer config;
+    memset(&config, 0, sizeof(config));
+    ASSERT_EQ(YAMI_SUCCESS, decoder.start(&config));
+
+    for (int i = 0; i < 5; i++)
+        EXPECT_EQ(YAMI_SUCCESS, decodeOne(decoder, i));
+    //we hold all surfaces, decoder waits
+    ASSERT_TRUE(listener.waitFrames(2));
+    usleep(10 * 1000);
+    EXPECT_TRUE(listener.waitFrames(2));
+
+    //every frame we give back lets one more input go
+    for (size_t i = 3; i <= 5; i++) {
+        {
+            AutoLock lock(listener.m_lock);
+            listener.m_frames.pop_front();
+        }
+        ASSERT_TRUE(listener.waitFrames(2)) << i;
+        AutoLock lock(listener.m_lock);
+        EXPECT_EQ((int64_t)i - 1, listener.m_frames.back()->timeStamp);
+    }
+    EXPECT_EQ(1, listener.m_formatChanges);
+    decoder.stop();
+    //frames released after stop only go back to the decoder
+    listener.m_frames.clear();
+}
+
+ASYNC_DECODER_TEST(Error)
+{
+    VaapiDecoderAsync decoder(new MockDecoder(8));
+    Listener listener;
+    decoder.setListener(&listener);
+    VideoConfigBuffer config;
+    memset(&config, 0, sizeof(config));
+    ASSERT_EQ(YAMI_SUCCESS, decoder.start(&config));
+
+    decodeOne(decoder, 0);
+    decodeOne(decoder, -1);
+    decodeOne(decoder, 2);
+    ASSERT_TRUE(listener.waitFrames(2));
+    AutoLock lock(listener.m_lock);
+    ASSERT_EQ(1u, listener.m_errors.size());
+    EXPECT_EQ(-1, listener.m_errors[0]);
+}
+
+ASYNC_DECODER_TEST(FlushWhileWaiting)
+{
+    VaapiDecoderAsync decoder(new MockDecoder(1));
+    Listener listener;
+    decoder.setListener(&listener);
+    VideoConfigBuffer config;
+    memset(&config, 0, sizeof(config));
+    ASSERT_EQ(YAMI_SUCCESS, decoder.start(&config));
+
+    for (int i = 0; i < 4; i++)
+        decodeOne(decoder, i);
+    ASSERT_TRUE(listener.waitFrames(1));
+    decoder.flush();
+    {
+        AutoLock lock(listener.m_lock);
+        listener.m_frames.clear();
+    }
+
+    //pending input is gone, new input decodes
+    decodeOne(decoder, 10);
+    ASSERT_TRUE(listener.waitFrames(1));
+    AutoLock lock(listener.m_lock);
+    EXPECT_EQ(10, listener.m_frames.front()->timeStamp);
+}
+
+}
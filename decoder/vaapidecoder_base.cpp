@@ -19,7 +19,9 @@
 #endif
 
 #include "vaapidecoder_base.h"
+#include "common/KeepAliveCache.h"
 #include "common/log.h"
+#include "common/utils.h"
 #include "vaapi/vaapisurfaceallocator.h"
 #include "vaapi/vaapicontext.h"
 #include "vaapi/vaapidisplay.h"
@@ -29,6 +31,7 @@
 #include <stdlib.h> // for setenv
 #include <va/va_backend.h>
 #include <unistd.h>
+#include <inttypes.h>
 
 namespace YamiMediaCodec{
 typedef VaapiDecoderBase::PicturePtr PicturePtr;
@@ -38,11 +41,38 @@ inline void unrefAllocator(SurfaceAllocator* allocator)
     allocator->unref(allocator);
 }
 
+//members are released in reverse order: context first, allocator after the surfaces.
+struct VaapiDecSession {
+    DisplayPtr display;
+    SharedPtr<SurfaceAllocator> allocator;
+    DecSurfacePoolPtr pool;
+    ContextPtr context;
+};
+
+typedef KeepAliveCache<VaapiDecSessionKey, VaapiDecSession> SessionCache;
+
+static SessionCache* s_sessionCache;
+static pthread_once_t s_sessionCacheOnce = PTHREAD_ONCE_INIT;
+
+static void createSessionCache()
+{
+    s_sessionCache = new SessionCache;
+}
+
+static SessionCache& getSessionCache()
+{
+    pthread_once(&s_sessionCacheOnce, createSessionCache);
+    return *s_sessionCache;
+}
+
 VaapiDecoderBase::VaapiDecoderBase()
     : m_VAStarted(false)
     , m_currentPTS(INVALID_PTS)
+    , m_sessionRestored(false)
+    , m_startTime(getSystemTime())
 {
     INFO("base: construct()");
+    memset(&m_sessionKey, 0, sizeof(m_sessionKey));
     m_externalDisplay.handle = 0,
     m_externalDisplay.type = NATIVE_DISPLAY_AUTO,
     memset(&m_videoFormatInfo, 0, sizeof(VideoFormatInfo));
@@ -310,9 +340,95 @@ YamiStatus VaapiDecoderBase::ensureSurfacePool()
     return YAMI_SUCCESS;
 }
 
+void VaapiDecoderBase::setSessionCacheLimits(uint32_t ttl, uint32_t maxSize)
+{
+    getSessionCache().setLimits(ttl, maxSize);
+}
+
+void VaapiDecoderBase::releaseSessionCache()
+{
+    //sessions hold their displays, release them first
+    getSessionCache().clear();
+    VaapiDisplay::releaseCache();
+}
+
+void VaapiDecoderBase::getSessionKey(VaapiDecSessionKey& key, VAProfile profile) const
+{
+    const VideoFormatInfo& info = m_videoFormatInfo;
+    memset(&key, 0, sizeof(key));
+    key.display = m_display->getID();
+    key.profile = profile;
+    key.width = info.width;
+    key.height = info.height;
+    key.surfaceWidth = info.surfaceWidth;
+    key.surfaceHeight = info.surfaceHeight;
+    key.surfaceNumber = info.surfaceNumber;
+    key.fourcc = info.fourcc;
+}
+
+bool VaapiDecoderBase::restoreSession(VAProfile profile)
+{
+    if (!isSurfaceGeometryChanged() || m_externalAllocator)
+        return false;
+    SessionCache& cache = getSessionCache();
+    if (!cache.enabled())
+        return false;
+    if (!m_display)
+        m_display = VaapiDisplay::create(m_externalDisplay);
+    if (!m_display)
+        return false;
+
+    VaapiDecSessionKey key;
+    getSessionKey(key, profile);
+    SharedPtr<VaapiDecSession> session;
+    if (!cache.take(key, session))
+        return false;
+
+    VideoFormatInfo& info = m_videoFormatInfo;
+    m_config.width = info.surfaceWidth;
+    m_config.height = info.surfaceHeight;
+    m_config.surfaceNumber = info.surfaceNumber;
+    m_config.fourcc = info.fourcc;
+    m_config.profile = profile;
+
+    m_display = session->display;
+    m_allocator = session->allocator;
+    m_surfacePool = session->pool;
+    m_context = session->context;
+    m_sessionKey = key;
+    m_sessionRestored = true;
+    DEBUG("reuse cached session (%dx%d)", info.width, info.height);
+    return true;
+}
+
+void VaapiDecoderBase::cacheSession()
+{
+    VaapiDisplay::keepAlive(m_display);
+
+    VaapiDecSessionKey key = m_sessionKey;
+    memset(&m_sessionKey, 0, sizeof(m_sessionKey));
+    //no key for sessions from setupVA(),
+    //and if client still holds some surfaces, we can't hand them to the next session
+    if (!key.display || !m_context || !m_surfacePool || m_externalAllocator
+        || !m_surfacePool->isIdle())
+        return;
+    SessionCache& cache = getSessionCache();
+    if (!cache.enabled())
+        return;
+    SharedPtr<VaapiDecSession> session(new VaapiDecSession);
+    session->display = m_display;
+    session->allocator = m_allocator;
+    session->pool = m_surfacePool;
+    session->context = m_context;
+    cache.put(key, session);
+}
+
 YamiStatus VaapiDecoderBase::ensureProfile(VAProfile profile)
 {
     YamiStatus status;
+    if (restoreSession(profile))
+        return YAMI_SUCCESS;
+
     status = ensureSurfacePool();
     if (status != YAMI_SUCCESS)
         return status;
@@ -350,6 +466,8 @@ YamiStatus VaapiDecoderBase::ensureProfile(VAProfile profile)
         ERROR("create context failed");
         return YAMI_FAIL;
     }
+    getSessionKey(m_sessionKey, profile);
+    m_sessionRestored = false;
     return YAMI_SUCCESS;
 }
 
@@ -357,6 +475,8 @@ YamiStatus VaapiDecoderBase::terminateVA(void)
 {
     INFO("base: terminate VA");
     m_output.clear();
+    cacheSession();
+    m_startTime = getSystemTime();
     m_config.resetConfig();
     m_surfacePool.reset();
     m_allocator.reset();
@@ -409,6 +529,11 @@ private:
 
 YamiStatus VaapiDecoderBase::outputPicture(const PicturePtr& picture)
 {
+    if (m_startTime) {
+        INFO("startup latency: %" PRIu64 " ms, %s session", getSystemTime() - m_startTime,
+            m_sessionRestored ? "cached" : "new");
+        m_startTime = 0;
+    }
     SurfacePtr surface = picture->getSurface();
     SharedPtr<VideoFrame> frame(surface->m_frame.get(), VideoFrameRecycler(surface));
     frame->timeStamp = picture->m_timeStamp;
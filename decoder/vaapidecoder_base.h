@@ -63,6 +63,31 @@ struct VideoDecoderConfig {
     }
 };
 
+/// what a cached decoding session (context, config and surface pool) can be reused for
+struct VaapiDecSessionKey {
+    VADisplay display;
+    VAProfile profile;
+    /// picture size, the context is created with it
+    uint32_t width;
+    uint32_t height;
+    uint32_t surfaceWidth;
+    uint32_t surfaceHeight;
+    uint32_t surfaceNumber;
+    uint32_t fourcc;
+
+    bool operator==(const VaapiDecSessionKey& other) const
+    {
+        return display == other.display
+            && profile == other.profile
+            && width == other.width
+            && height == other.height
+            && surfaceWidth == other.surfaceWidth
+            && surfaceHeight == other.surfaceHeight
+            && surfaceNumber == other.surfaceNumber
+            && fourcc == other.fourcc;
+    }
+};
+
 class VaapiDecoderBase:public IVideoDecoder {
   public:
     typedef SharedPtr<VaapiDecPicture> PicturePtr;
@@ -87,6 +112,11 @@ class VaapiDecoderBase:public IVideoDecoder {
 
     //do not use this, we will remove this in near future
     virtual VADisplay getDisplayID();
+
+    /// overrides YAMI_CACHE_TTL (ms) and YAMI_CACHE_SIZE for decoding sessions
+    static void setSessionCacheLimits(uint32_t ttl, uint32_t maxSize);
+    /// release cached sessions and idle displays, see releaseVideoDecoderCache()
+    static void releaseSessionCache();
   protected:
       YamiStatus setupVA(uint32_t numSurface, VAProfile profile);
       YamiStatus terminateVA(void);
@@ -130,6 +160,16 @@ class VaapiDecoderBase:public IVideoDecoder {
       YamiStatus ensureSurfacePool();
       VideoDecoderConfig m_config;
 
+      //reuse context and surfaces of a previous session, see KeepAliveCache
+      void getSessionKey(VaapiDecSessionKey& key, VAProfile profile) const;
+      bool restoreSession(VAProfile profile);
+      void cacheSession();
+      VaapiDecSessionKey m_sessionKey;
+      bool m_sessionRestored;
+
+      //for startup latency, from construction or last stop()/reset() to first output
+      uint64_t m_startTime;
+
       struct VideoFrameRecycler;
 
 #ifdef __ENABLE_DEBUG__
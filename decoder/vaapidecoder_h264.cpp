@@ -66,14 +66,22 @@ public:
     }
     VaapiDecPictureH264() {}
 
-    PicturePtr allocPicture()
+    //picture and its shared pointer control block come from arena
+    static PicturePtr create(const FreeListPtr& arena, const ContextPtr& context,
+        const SurfacePtr& surface, int64_t timeStamp)
     {
-        PicturePtr picture(
-            new VaapiDecPictureH264(m_context, m_surface, m_timeStamp));
+        PicturePtr picture = allocShared<VaapiDecPictureH264>(arena, context,
+            surface, timeStamp);
         assert(picture);
+        picture->m_arena = arena;
         return picture;
     }
 
+    PicturePtr allocPicture()
+    {
+        return create(m_arena, m_context, m_surface, m_timeStamp);
+    }
+
     PicturePtr allocField(bool isBottomField)
     {
         PicturePtr field = allocPicture();
@@ -128,6 +136,7 @@ public:
     bool m_hasMmco5;
     bool m_isSecondField;
     PicturePtr m_complementField;
+    FreeListPtr m_arena;
 };
 
 static bool isISlice(uint32_t sliceType)
@@ -1131,6 +1140,10 @@ VaapiDecoderH264::VaapiDecoderH264()
     , m_dpb(bind(&VaapiDecoderH264::outputPicture, this, _1))
     , m_nalLengthSize(0)
     , m_contextChanged(false)
+    , m_usedSliceHeaders(0)
+    , m_pictureArena(new FreeList)
+    , m_sliceBlock(NULL)
+    , m_sliceBlockSize(0)
 {
 }
 
@@ -1211,9 +1224,8 @@ YamiStatus VaapiDecoderH264::start(VideoConfigBuffer* buffer)
 
 YamiStatus VaapiDecoderH264::decodeSps(NalUnit* nalu)
 {
-    SharedPtr<SPS> sps(new SPS());
+    SharedPtr<SPS> sps;
 
-    memset(sps.get(), 0, sizeof(SPS));
     if (!m_parser.parseSps(sps, nalu)) {
         return YAMI_DECODE_INVALID_DATA;
     }
@@ -1223,7 +1235,7 @@ YamiStatus VaapiDecoderH264::decodeSps(NalUnit* nalu)
 
 YamiStatus VaapiDecoderH264::decodePps(NalUnit* nalu)
 {
-    SharedPtr<PPS> pps(new PPS());
+    SharedPtr<PPS> pps;
 
     if (!m_parser.parsePps(pps, nalu)) {
         return YAMI_DECODE_INVALID_DATA;
@@ -1479,7 +1491,8 @@ bool VaapiDecoderH264::fillSlice(const PicturePtr& picture,
                                  const NalUnit* const nalu)
 {
     VASliceParameterBufferH264* sliceParam;
-    if (!picture->newSlice(sliceParam, nalu->m_data, nalu->m_size))
+    if (!picture->newSlice(sliceParam, nalu->m_data, nalu->m_size,
+            m_sliceBlock, m_sliceBlockSize))
         return false;
 
     sliceParam->slice_data_bit_offset
@@ -1508,6 +1521,8 @@ bool VaapiDecoderH264::fillSlice(const PicturePtr& picture,
 YamiStatus VaapiDecoderH264::decodeCurrent()
 {
     YamiStatus status = YAMI_SUCCESS;
+    //slice headers of the last picture are free from here
+    m_usedSliceHeaders = 0;
     if (!m_currPic)
         return status;
 
@@ -1677,8 +1692,8 @@ YamiStatus VaapiDecoderH264::createPicture(const SliceHeader* const slice,
         m_currSurface = createSurface(slice);
         if (!m_currSurface)
             return YAMI_DECODE_NO_SURFACE;
-        m_currPic.reset(
-            new VaapiDecPictureH264(m_context, m_currSurface, m_currentPTS));
+        m_currPic = VaapiDecPictureH264::create(m_pictureArena, m_context,
+            m_currSurface, m_currentPTS);
     }
 
     m_currPic->m_picOutputFlag = true;
@@ -1689,8 +1704,8 @@ YamiStatus VaapiDecoderH264::createPicture(const SliceHeader* const slice,
     m_currPic->m_picStructure = picStructure;
 
     if (isIdr(m_currPic)) {
-        m_prevPic.reset(
-            new VaapiDecPictureH264(m_context, m_currSurface, m_currentPTS));
+        m_prevPic = VaapiDecPictureH264::create(m_pictureArena, m_context,
+            m_currSurface, m_currentPTS);
     }
 
     if (nalu->nal_ref_idc) {
@@ -1706,14 +1721,21 @@ YamiStatus VaapiDecoderH264::createPicture(const SliceHeader* const slice,
     return status;
 }
 
+VaapiDecoderH264::SliceHeader* VaapiDecoderH264::nextSliceHeader()
+{
+    if (m_usedSliceHeaders == m_sliceHeaders.size())
+        m_sliceHeaders.push_back(SliceHeader());
+    SliceHeader* slice = &m_sliceHeaders[m_usedSliceHeaders];
+    *slice = SliceHeader();
+    return slice;
+}
+
 YamiStatus VaapiDecoderH264::decodeSlice(NalUnit* nalu)
 {
-    SharedPtr<SliceHeader> currSlice(new SliceHeader);
-    SliceHeader* slice = currSlice.get();
+    //the header is only kept in the arena if the slice is added to a picture
+    SliceHeader* slice = nextSliceHeader();
     YamiStatus status;
 
-    *slice = SliceHeader();
-
     if (!slice->parseHeader(&m_parser, nalu))
         return YAMI_DECODE_INVALID_DATA;
 
@@ -1748,6 +1770,10 @@ YamiStatus VaapiDecoderH264::decodeSlice(NalUnit* nalu)
     if (!fillSlice(m_currPic, slice, nalu))
         return YAMI_FAIL;
 
+    //decodeCurrent() freed the arena under the first slice of a picture
+    SliceHeader& kept = m_sliceHeaders[m_usedSliceHeaders++];
+    if (&kept != slice)
+        std::swap(kept, *slice);
     return status;
 }
 
@@ -1797,6 +1823,13 @@ void VaapiDecoderH264::flush(void)
     VaapiDecoderBase::flush();
 }
 
+bool VaapiDecoderH264::endSliceBlock()
+{
+    m_sliceBlock = NULL;
+    m_sliceBlockSize = 0;
+    return !m_currPic || m_currPic->closeSliceBatch();
+}
+
 YamiStatus VaapiDecoderH264::decode(VideoDecodeBuffer* buffer)
 {
     if (!buffer || !buffer->data) {
@@ -1813,24 +1846,31 @@ YamiStatus VaapiDecoderH264::decode(VideoDecodeBuffer* buffer)
     }
     m_currentPTS = buffer->timeStamp;
 
-    int32_t size;
     NalUnit nalu;
     YamiStatus lastError = YAMI_SUCCESS;
     YamiStatus status = YAMI_SUCCESS;
-    const uint8_t* nal;
     NalReader nr(buffer->data, buffer->size, m_nalLengthSize);
+    nr.readAll(m_nals);
+    m_sliceBlock = buffer->data;
+    m_sliceBlockSize = buffer->size;
 
-    while (nr.read(nal, size)) {
-        if (nalu.parseNalUnit(nal, size))
+    for (size_t i = 0; i < m_nals.size(); i++) {
+        const NalIndexEntry& entry = m_nals[i];
+        if (nalu.parseNalUnit(buffer->data + entry.offset, entry.size))
             status = decodeNalu(&nalu);
         if (status != YAMI_SUCCESS) {
             //we will continue decode if decodeNalu return YAMI_DECODE_INVALID_DATA
             //but we will return the error at end of fucntion
             lastError = status;
-            if (status != YAMI_DECODE_INVALID_DATA)
+            if (status != YAMI_DECODE_INVALID_DATA) {
+                endSliceBlock();
                 return status;
+            }
         }
     }
+    //buffer->data is not valid after return
+    if (!endSliceBlock())
+        return YAMI_FAIL;
     if (buffer->flag & VIDEO_DECODE_BUFFER_FLAG_FRAME_END) {
         //send current buffer to libva
         decodeCurrent();
@@ -18,10 +18,13 @@
 #define vaapidecoder_h264_h
 
 #include "codecparsers/h264Parser.h"
+#include "common/FreeList.h"
 #include "common/Functional.h"
+#include "common/nalreader.h"
 #include "vaapidecoder_base.h"
 #include "vaapidecpicture.h"
 
+#include <deque>
 #include <set>
 
 namespace YamiMediaCodec {
@@ -46,6 +49,7 @@ public:
 private:
     friend class FactoryTest<IVideoDecoder, VaapiDecoderH264>;
     friend class VaapiDecoderH264Test;
+    friend class VaapiDecoderH264NullTest;
 
     class DPB {
         typedef VaapiDecoderH264::RefSet RefSet;
@@ -156,6 +160,8 @@ private:
     YamiStatus decodeCurrent();
     YamiStatus outputPicture(const PicturePtr&);
     SurfacePtr createSurface(const SliceHeader* const);
+    SliceHeader* nextSliceHeader();
+    bool endSliceBlock();
 
     YamiParser::H264::Parser m_parser;
     PicturePtr m_currPic;
@@ -167,6 +173,14 @@ private:
     uint32_t m_nalLengthSize;
     SurfacePtr m_currSurface;
     bool m_contextChanged;
+    //slice headers of the current picture, reused once it is decoded
+    std::deque<SliceHeader> m_sliceHeaders;
+    size_t m_usedSliceHeaders;
+    FreeListPtr m_pictureArena;
+    //nal units of the input buffer, slices are batched while it is valid
+    NalIndex m_nals;
+    const uint8_t* m_sliceBlock;
+    uint32_t m_sliceBlockSize;
 
     /**
      * VaapiDecoderFactory registration result. This decoder is registered in
@@ -36,6 +36,10 @@
 
 // library headers
 #include "common/Array.h"
+#if __ENABLE_NULL_DRIVER__
+#include "VideoDecoderHost.h"
+#include "vaapi/VaapiNullDisplayTest.h"
+#endif
 
 namespace YamiMediaCodec {
 
@@ -174,4 +178,130 @@ VAAPIDECODER_H264_TEST(Decode_Simple)
     EXPECT_TRUE(bool(decoder.getOutput()));
 }
 
+#if __ENABLE_NULL_DRIVER__
+class VaapiDecoderH264NullTest : public NullDisplayTest {
+protected:
+    void start(VaapiDecoderH264& decoder)
+    {
+        NativeDisplay native = { (intptr_t)m_vaDisplay, NATIVE_DISPLAY_VA };
+        VideoConfigBuffer configBuffer;
+        memset(&configBuffer, 0, sizeof(configBuffer));
+        configBuffer.profile = VAProfileNone;
+        decoder.setNativeDisplay(&native);
+        ASSERT_EQ(YAMI_SUCCESS, decoder.start(&configBuffer));
+    }
+
+    /* g_SimpleH264 is sps, pps and one idr slice, this repeats the slice
+     * with a 3 bytes start code, every copy is a new picture */
+    void makeStream(std::vector<uint8_t>& stream, uint32_t pictures)
+    {
+        stream.assign(g_SimpleH264.begin(), g_SimpleH264.end());
+        for (uint32_t i = 1; i < pictures; i++)
+            stream.insert(stream.end(), g_SimpleH264.begin() + SLICE_OFFSET, g_SimpleH264.end());
+    }
+
+    void decodeStream(VaapiDecoderH264& decoder, std::vector<uint8_t>& stream)
+    {
+        VideoDecodeBuffer buffer;
+        memset(&buffer, 0, sizeof(buffer));
+        buffer.data = &stream[0];
+        buffer.size = stream.size();
+        YamiStatus status = decoder.decode(&buffer);
+        if (status == YAMI_DECODE_FORMAT_CHANGE)
+            status = decoder.decode(&buffer);
+        EXPECT_EQ(YAMI_SUCCESS, status);
+        //return surfaces like a client does
+        while (decoder.getOutput())
+            ;
+    }
+
+    size_t getSliceHeaders(const VaapiDecoderH264& decoder)
+    {
+        return decoder.m_sliceHeaders.size();
+    }
+
+    uint32_t getPictureHeapAllocs(const VaapiDecoderH264& decoder)
+    {
+        return decoder.m_pictureArena->getHeapAllocs();
+    }
+
+    static const uint32_t SLICE_OFFSET = 34;
+    static const uint32_t SLICE_SIZE = 998 - SLICE_OFFSET - 3;
+};
+
+#define VAAPIDECODER_H264_NULL_TEST(name) \
+    TEST_F(VaapiDecoderH264NullTest, name)
+
+VAAPIDECODER_H264_NULL_TEST(SliceDataPerPicture)
+{
+    const uint32_t pictures = 4;
+    std::vector<uint8_t> stream;
+    makeStream(stream, pictures);
+
+    VaapiDecoderH264 decoder;
+    start(decoder);
+    decodeStream(decoder, stream);
+    ASSERT_EQ(YAMI_SUCCESS, decoder.decode(NULL));
+
+    //every picture uploads its own slice, not the whole buffer
+    NullDriverStats stats = getStats();
+    EXPECT_EQ(pictures, stats.count[NullDriverStats::EndPicture]);
+    EXPECT_EQ((uint64_t)SLICE_SIZE * pictures, stats.renderedSliceBytes);
+}
+
+VAAPIDECODER_H264_NULL_TEST(ArenaSteadyState)
+{
+    std::vector<uint8_t> stream;
+    makeStream(stream, 4);
+
+    VaapiDecoderH264 decoder;
+    start(decoder);
+    decodeStream(decoder, stream);
+    //one slice of the current picture and the first slice of the next one
+    size_t sliceHeaders = getSliceHeaders(decoder);
+    EXPECT_GE(2u, sliceHeaders);
+    uint32_t heapAllocs = getPictureHeapAllocs(decoder);
+    for (int i = 0; i < 8; i++) {
+        decodeStream(decoder, stream);
+        //slice headers are reused for every picture
+        EXPECT_EQ(sliceHeaders, getSliceHeaders(decoder));
+        //released pictures come back from the arena
+        EXPECT_EQ(heapAllocs, getPictureHeapAllocs(decoder));
+    }
+    EXPECT_EQ(YAMI_SUCCESS, decoder.decode(NULL));
+}
+
+VAAPIDECODER_H264_NULL_TEST(RestoreSession)
+{
+    std::vector<uint8_t> stream;
+    makeStream(stream, 2);
+    VaapiDecoderBase::setSessionCacheLimits(60 * 1000, 4);
+    {
+        VaapiDecoderH264 decoder;
+        start(decoder);
+        decodeStream(decoder, stream);
+        //flush returns all surfaces, so the session can be cached on stop
+        EXPECT_EQ(YAMI_SUCCESS, decoder.decode(NULL));
+        EXPECT_TRUE(bool(decoder.getOutput()));
+    }
+    NullDriverStats stats = getStats();
+    EXPECT_LT(0u, stats.liveSurfaces);
+    {
+        VaapiDecoderH264 decoder;
+        start(decoder);
+        decodeStream(decoder, stream);
+        EXPECT_EQ(YAMI_SUCCESS, decoder.decode(NULL));
+    }
+    //no new context and surfaces for the second decoder
+    NullDriverStats restored = getStats();
+    EXPECT_EQ(stats.count[NullDriverStats::CreateContext], restored.count[NullDriverStats::CreateContext]);
+    EXPECT_EQ(stats.count[NullDriverStats::CreateSurfaces], restored.count[NullDriverStats::CreateSurfaces]);
+    EXPECT_EQ(stats.liveSurfaces, restored.liveSurfaces);
+
+    releaseVideoDecoderCache();
+    EXPECT_EQ(0u, getStats().liveSurfaces);
+    VaapiDecoderBase::setSessionCacheLimits(0, 4);
+}
+#endif
+
 }
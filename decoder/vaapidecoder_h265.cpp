@@ -430,7 +430,9 @@ VaapiDecoderH265::VaapiDecoderH265():
     m_nalLengthSize(0),
     m_newStream(true),
     m_endOfSequence(false),
-    m_dpb(bind(&VaapiDecoderH265::outputPicture, this, _1))
+    m_dpb(bind(&VaapiDecoderH265::outputPicture, this, _1)),
+    m_sliceBlock(NULL),
+    m_sliceBlockSize(0)
 {
     m_parser.reset(new Parser());
     m_prevSlice.reset(new SliceHeader());
@@ -870,7 +872,8 @@ bool VaapiDecoderH265::fillSlice(const PicturePtr& picture,
 {
     const SliceHeader* slice = theSlice;
     VASliceParameterBufferHEVC* sliceParam;
-    if (!picture->newSlice(sliceParam, nalu->m_data, nalu->m_size))
+    if (!picture->newSlice(sliceParam, nalu->m_data, nalu->m_size,
+            m_sliceBlock, m_sliceBlockSize))
         return false;
     sliceParam->slice_data_byte_offset =
         slice->getSliceDataByteOffset();
@@ -1161,6 +1164,13 @@ void VaapiDecoderH265::flush(void)
     flush(true);
 }
 
+bool VaapiDecoderH265::endSliceBlock()
+{
+    m_sliceBlock = NULL;
+    m_sliceBlockSize = 0;
+    return !m_current || m_current->closeSliceBatch();
+}
+
 YamiStatus VaapiDecoderH265::decode(VideoDecodeBuffer* buffer)
 {
     if (!buffer || !buffer->data) {
@@ -1170,23 +1180,30 @@ YamiStatus VaapiDecoderH265::decode(VideoDecodeBuffer* buffer)
     m_currentPTS = buffer->timeStamp;
 
     NalReader nr(buffer->data, buffer->size, m_nalLengthSize);
-    const uint8_t* nal;
-    int32_t size;
+    nr.readAll(m_nals);
+    m_sliceBlock = buffer->data;
+    m_sliceBlockSize = buffer->size;
     YamiStatus lastError = YAMI_SUCCESS;
     YamiStatus status;
-    while (nr.read(nal, size)) {
+    for (size_t i = 0; i < m_nals.size(); i++) {
+        const NalIndexEntry& entry = m_nals[i];
         NalUnit nalu;
-        if (nalu.parseNaluHeader(nal, size)) {
+        if (nalu.parseNaluHeader(buffer->data + entry.offset, entry.size)) {
             status = decodeNalu(&nalu);
             if (status != YAMI_SUCCESS) {
                 //we will continue decode if decodeNalu return YAMI_DECODE_INVALID_DATA
                 //but we will return the error at end of fucntion
                 lastError = status;
-                if (status != YAMI_DECODE_INVALID_DATA)
+                if (status != YAMI_DECODE_INVALID_DATA) {
+                    endSliceBlock();
                     return status;
+                }
             }
         }
     }
+    //buffer->data is not valid after return
+    if (!endSliceBlock())
+        return YAMI_FAIL;
 
     if (buffer->flag & VIDEO_DECODE_BUFFER_FLAG_FRAME_END) {
         //send current buffer to libva
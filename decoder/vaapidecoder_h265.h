@@ -18,6 +18,7 @@
 #define vaapidecoder_h265_h
 
 #include "common/Functional.h"
+#include "common/nalreader.h"
 #include "vaapidecoder_base.h"
 #include "vaapidecpicture.h"
 
@@ -143,6 +144,7 @@ private:
     YamiStatus decodeCurrent();
     YamiStatus outputPicture(const PicturePtr&);
     void flush(bool discardOutput);
+    bool endSliceBlock();
 
     SharedPtr<Parser> m_parser;
     PicturePtr  m_current;
@@ -156,6 +158,10 @@ private:
     DPB         m_dpb;
     std::map<int32_t, uint8_t> m_pocToIndex;
     SharedPtr<SliceHeader> m_prevSlice;
+    //nal units of the input buffer, slices are batched while it is valid
+    NalIndex m_nals;
+    const uint8_t* m_sliceBlock;
+    uint32_t m_sliceBlockSize;
 
     /**
      * VaapiDecoderFactory registration result. This decoder is registered in
@@ -20,6 +20,8 @@
 
 #include "common/log.h"
 #include "VideoDecoderHost.h"
+#include "vaapidecoder_async.h"
+#include "vaapidecoder_base.h"
 #include "vaapidecoder_factory.h"
 
 #if __BUILD_FAKE_DECODER__
@@ -99,6 +101,24 @@ void releaseVideoDecoder(IVideoDecoder * p)
     delete p;
 }
 
+IAsyncVideoDecoder *createAsyncVideoDecoder(const char *mimeType)
+{
+    IVideoDecoder* decoder = createVideoDecoder(mimeType);
+    if (!decoder)
+        return NULL;
+    return new VaapiDecoderAsync(decoder);
+}
+
+void releaseAsyncVideoDecoder(IAsyncVideoDecoder * p)
+{
+    delete p;
+}
+
+void releaseVideoDecoderCache()
+{
+    VaapiDecoderBase::releaseSessionCache();
+}
+
 std::vector<std::string> getVideoDecoderMimeTypes()
 {
     return VaapiDecoderFactory::keys();
@@ -53,7 +53,7 @@ private:
     YamiStatus decode(uint8_t*, uint32_t, uint64_t);
     bool ensureSlice(PicturePtr&, void*, int);
     bool ensurePicture(PicturePtr&);
-    bool makeBitPlanes(PicturePtr&, VAPictureParameterBufferVC1*);
+    bool makeBitPlanes(PicturePtr&);
     YamiParser::VC1::Parser m_parser;
 
     const static uint32_t VC1_MAX_REFRENCE_SURFACE_NUMBER = 2;
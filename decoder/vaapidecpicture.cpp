@@ -26,13 +26,40 @@ namespace YamiMediaCodec{
 VaapiDecPicture::VaapiDecPicture(const ContextPtr& context,
                                  const SurfacePtr& surface, int64_t timeStamp)
     :VaapiPicture(context, surface, timeStamp)
+    , m_batchBlock(NULL)
+    , m_batchBegin(NULL)
+    , m_batchEnd(NULL)
+    , m_batchParamSize(0)
 {
 }
 
 VaapiDecPicture::VaapiDecPicture()
+    : m_batchBlock(NULL)
+    , m_batchBegin(NULL)
+    , m_batchEnd(NULL)
+    , m_batchParamSize(0)
 {
 }
 
+bool VaapiDecPicture::closeSliceBatch()
+{
+    if (!m_batchBlock)
+        return true;
+    BufObjectPtr data = createBufferObject(VASliceDataBufferType,
+        m_batchEnd - m_batchBegin, m_batchBegin, NULL);
+    BufObjectPtr param;
+    uint32_t count = m_batchParams.size() / m_batchParamSize;
+    if (count)
+        param = VaapiBuffer::createArray(m_context, VASliceParameterBufferType,
+            m_batchParamSize, count, &m_batchParams[0]);
+    bool ret = addObject(m_slices, param, data);
+    m_batchBlock = NULL;
+    m_batchBegin = NULL;
+    m_batchEnd = NULL;
+    m_batchParams.clear();
+    return ret;
+}
+
 bool VaapiDecPicture::decode()
 {
     return render();
@@ -40,6 +67,8 @@ bool VaapiDecPicture::decode()
 
 bool VaapiDecPicture::doRender()
 {
+    if (!closeSliceBatch())
+        return false;
     RENDER_OBJECT(m_picture);
     RENDER_OBJECT(m_probTable);
     RENDER_OBJECT(m_iqMatrix);
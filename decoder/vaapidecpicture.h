@@ -44,6 +44,16 @@ public:
     template <class T>
     bool newSlice(T*& sliceParam, const void* sliceData, uint32_t sliceSize);
 
+    /* Slices inside [block, block + blockSize) are batched: the bytes from
+     * the first to the last slice of the batch go to one slice data buffer
+     * and their parameters to one slice parameter buffer, both created by
+     * closeSliceBatch(). sliceParam stays valid until the next newSlice()
+     * call. Call closeSliceBatch() before block is freed. */
+    template <class T>
+    bool newSlice(T*& sliceParam, const void* sliceData, uint32_t sliceSize,
+        const void* block, uint32_t blockSize);
+    bool closeSliceBatch();
+
     bool decode();
 
 protected:
@@ -58,6 +68,16 @@ private:
     BufObjectPtr m_hufTable;
     BufObjectPtr m_probTable;
     std::vector<std::pair<BufObjectPtr, BufObjectPtr> > m_slices;
+
+    //a larger gap between two slices starts a new batch
+    static const uint32_t MAX_BATCH_GAP = 256;
+
+    //slices of the open batch, they are uploaded by closeSliceBatch()
+    const void* m_batchBlock;
+    const uint8_t* m_batchBegin;
+    const uint8_t* m_batchEnd;
+    std::vector<uint8_t> m_batchParams;
+    uint32_t m_batchParamSize;
 };
 
 template<class T>
@@ -100,6 +120,9 @@ bool VaapiDecPicture::editProbTable(T*& probTable)
 template <class T>
 bool VaapiDecPicture::newSlice(T*& sliceParam, const void* sliceData, uint32_t sliceSize)
 {
+    //keep slice order
+    if (!closeSliceBatch())
+        return false;
     BufObjectPtr data = createBufferObject(VASliceDataBufferType, sliceSize, sliceData, NULL);
     BufObjectPtr param = createBufferObject(VASliceParameterBufferType, sliceParam);
 
@@ -113,5 +136,33 @@ bool VaapiDecPicture::newSlice(T*& sliceParam, const void* sliceData, uint32_t s
 
     return false;
 }
+
+template <class T>
+bool VaapiDecPicture::newSlice(T*& sliceParam, const void* sliceData, uint32_t sliceSize,
+    const void* block, uint32_t blockSize)
+{
+    const uint8_t* data = static_cast<const uint8_t*>(sliceData);
+    const uint8_t* begin = static_cast<const uint8_t*>(block);
+    if (!begin || data < begin || data + sliceSize > begin + blockSize)
+        return newSlice(sliceParam, sliceData, sliceSize);
+
+    //only slices following each other closely share the data buffer
+    if (block != m_batchBlock || m_batchParamSize != sizeof(T)
+        || data < m_batchEnd || data > m_batchEnd + MAX_BATCH_GAP) {
+        if (!closeSliceBatch())
+            return false;
+        m_batchBlock = block;
+        m_batchBegin = data;
+        m_batchParamSize = sizeof(T);
+    }
+    m_batchEnd = data + sliceSize;
+    size_t offset = m_batchParams.size();
+    m_batchParams.resize(offset + sizeof(T));
+    sliceParam = reinterpret_cast<T*>(&m_batchParams[offset]);
+    sliceParam->slice_data_size = sliceSize;
+    sliceParam->slice_data_offset = data - m_batchBegin;
+    sliceParam->slice_data_flag = VA_SLICE_DATA_FLAG_ALL;
+    return true;
+}
 }
 #endif //#ifndef vaapidecpicture_h
@@ -40,29 +40,41 @@ YamiStatus VaapiDecSurfacePool::putSurface(SurfaceAllocParams* param, intptr_t s
     return p->putSurface(surface);
 }
 
-YamiStatus VaapiDecSurfacePool::getSurface(intptr_t* surface)
+bool VaapiDecSurfacePool::popIndex(uint32_t& index)
+{
+    if (!m_freed->pop(index))
+        return false;
+    __atomic_store_n(&m_used[index], 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+YamiStatus VaapiDecSurfacePool::putIndex(uint32_t index)
 {
-    AutoLock lock(m_lock);
+    if (!__atomic_exchange_n(&m_used[index], 0, __ATOMIC_RELAXED)) {
+        ERROR("put wrong surface, id = %p", (void*)m_surfaceIds[index]);
+        return YAMI_INVALID_PARAM;
+    }
+    m_freed->push(index);
+    return YAMI_SUCCESS;
+}
 
-    if (m_freed.empty())
+YamiStatus VaapiDecSurfacePool::getSurface(intptr_t* surface)
+{
+    uint32_t index;
+    if (!popIndex(index))
         return YAMI_DECODE_NO_SURFACE;
-    *surface = m_freed.front();
-    m_used.insert(*surface);
-    m_freed.pop_front();
+    *surface = m_surfaceIds[index];
     return YAMI_SUCCESS;
 }
 
 YamiStatus VaapiDecSurfacePool::putSurface(intptr_t surface)
 {
-    AutoLock lock(m_lock);
-
-    if (m_used.find(surface) == m_used.end()) {
+    SurfaceMap::const_iterator it = m_surfaceMap.find(surface);
+    if (it == m_surfaceMap.end()) {
         ERROR("put wrong surface, id = %p", (void*)surface);
         return YAMI_INVALID_PARAM;
     }
-    m_used.erase(surface);
-    m_freed.push_back(surface);
-    return YAMI_SUCCESS;
+    return putIndex(it->second);
 }
 
 DecSurfacePoolPtr VaapiDecSurfacePool::create(VideoConfigBuffer* config,
@@ -106,21 +118,24 @@ bool VaapiDecSurfacePool::init(VideoDecoderConfig* config,
         m_allocParams.getSurface = getSurface;
         m_allocParams.putSurface = putSurface;
         m_allocParams.user = this;
+        m_builtinGetter = true;
     }
 
     for (uint32_t i = 0; i < size; i++) {
         intptr_t s = m_allocParams.surfaces[i];
         SurfacePtr surface(new VaapiSurface(s, width, height, fourcc));
 
-        m_surfaceMap[s] = surface.get();
+        m_surfaceMap[s] = i;
         m_surfaces.push_back(surface);
-
-        m_freed.push_back(s);
+        m_surfaceIds.push_back(s);
     }
+    m_used.resize(size, 0);
+    m_freed.reset(new IndexFreeList(size, size));
     return true;
 }
 
 VaapiDecSurfacePool::VaapiDecSurfacePool()
+    : m_builtinGetter(false)
 {
     memset(&m_allocParams, 0, sizeof(m_allocParams));
 }
@@ -143,34 +158,56 @@ void VaapiDecSurfacePool::getSurfaceIDs(std::vector<VASurfaceID>& ids)
         ids.push_back(m_surfaces[i]->getID());
 }
 
+bool VaapiDecSurfacePool::isIdle()
+{
+    //surfaces from external getter are tracked by the allocator, not us
+    return m_builtinGetter && m_freed->size() == m_surfaces.size();
+}
+
 struct VaapiDecSurfacePool::SurfaceRecycler
 {
-    SurfaceRecycler(const DecSurfacePoolPtr& pool): m_pool(pool) {}
-    void operator()(VaapiSurface* surface)
+    SurfaceRecycler(const DecSurfacePoolPtr& pool, uint32_t index)
+        : m_pool(pool)
+        , m_index(index)
+    {
+    }
+    void operator()(VaapiSurface*)
     {
+        if (m_pool->m_builtinGetter) {
+            m_pool->putIndex(m_index);
+            return;
+        }
         SurfaceAllocParams& params = m_pool->m_allocParams;
-        params.putSurface(&params, (intptr_t)surface->getID());
+        params.putSurface(&params, m_pool->m_surfaceIds[m_index]);
     }
 
 private:
     DecSurfacePoolPtr m_pool;
+    uint32_t m_index;
 };
 
 SurfacePtr VaapiDecSurfacePool::acquire()
 {
     SurfacePtr surface;
-    intptr_t p;
-    YamiStatus status = m_allocParams.getSurface(&m_allocParams, &p);
-    if (status != YAMI_SUCCESS)
-        return surface;
-    //we only hold this lock after getSurface, since getSurface will do the lock
-    AutoLock lock(m_lock);
-    SurfaceMap::iterator it = m_surfaceMap.find(p);
-    if (it == m_surfaceMap.end()) {
-        ERROR("surface getter turn a invalid surface ptr, %p", (void*)p);
-        return surface;
+    uint32_t index;
+    if (m_builtinGetter) {
+        if (!popIndex(index))
+            return surface;
+    }
+    else {
+        intptr_t p;
+        YamiStatus status = m_allocParams.getSurface(&m_allocParams, &p);
+        if (status != YAMI_SUCCESS)
+            return surface;
+        //the map never changes after init, no lock needed
+        SurfaceMap::const_iterator it = m_surfaceMap.find(p);
+        if (it == m_surfaceMap.end()) {
+            ERROR("surface getter turn a invalid surface ptr, %p", (void*)p);
+            return surface;
+        }
+        index = it->second;
     }
-    surface.reset(it->second, SurfaceRecycler(shared_from_this()));
+    surface.reset(m_surfaces[index].get(), SurfaceRecycler(shared_from_this(), index));
     return surface;
 }
 
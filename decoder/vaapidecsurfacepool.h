@@ -20,14 +20,12 @@
 
 #include "common/condition.h"
 #include "common/common_def.h"
-#include "common/lock.h"
+#include "common/IndexFreeList.h"
 #include "vaapi/vaapiptrs.h"
 #include "VideoCommonDefs.h"
 #include "VideoDecoderDefs.h"
-#include <deque>
 #include <map>
 #include <vector>
-#include <set>
 #include <va/va.h>
 
 namespace YamiMediaCodec{
@@ -47,6 +45,8 @@ struct VideoDecoderConfig;
  *  if no flag is set, the buffer/surface can be reused -- associate with a new VaapiPicture
  * 2. the free surface is in a first-in-first-out queue to be friendly to graphics fence
  * 3. most functions in this class do not support multithread except recycle.
+ *    free surfaces are kept as indices of m_surfaces in a lock free list, surfaces acquired
+ *    from the built-in getter go back by index, only external getters need the id lookup.
  * 4. flush need called in decoder thread and it will make all following acuireWithWait return null surface.
  *    until all surface recycled.
  *</pre>
@@ -62,6 +62,8 @@ public:
     void getSurfaceIDs(std::vector<VASurfaceID>& ids);
     /// get a free surface
     SurfacePtr acquire();
+    /// all surfaces are back in pool
+    bool isIdle();
     ~VaapiDecSurfacePool();
 
 
@@ -74,18 +76,23 @@ private:
     static YamiStatus putSurface(SurfaceAllocParams* param, intptr_t surface);
     YamiStatus getSurface(intptr_t* surface);
     YamiStatus putSurface(intptr_t surface);
+    bool popIndex(uint32_t& index);
+    YamiStatus putIndex(uint32_t index);
 
     //following member only change in constructor.
     std::vector<SurfacePtr> m_surfaces;
+    std::vector<intptr_t> m_surfaceIds;
 
-    typedef std::map<intptr_t, VaapiSurface*> SurfaceMap;
+    //surface id to index in m_surfaces
+    typedef std::map<intptr_t, uint32_t> SurfaceMap;
     SurfaceMap m_surfaceMap;
 
-    //free and allocted.
-    std::deque<intptr_t> m_freed;
-    std::set<intptr_t> m_used;
+    //free indices, and a flag per surface set while it's out of m_freed.
+    SharedPtr<IndexFreeList> m_freed;
+    std::vector<uint32_t> m_used;
 
-    Lock m_lock;
+    //getSurface/putSurface are ours, acquire and recycle can skip the ids.
+    bool m_builtinGetter;
 
     //for external allocator
     SharedPtr<SurfaceAllocator> m_allocator;
@@ -53,6 +53,15 @@ uint32_t VaapiCodedBuffer::size()
     return size;
 }
 
+void VaapiCodedBuffer::reset()
+{
+    if (m_segments) {
+        m_buf->unmap();
+        m_segments = NULL;
+    }
+    m_flags = 0;
+}
+
 bool VaapiCodedBuffer::copyInto(void* data)
 {
     if (!data)
@@ -68,4 +77,66 @@ bool VaapiCodedBuffer::copyInto(void* data)
     }
     return true;
 }
+
+struct CodedBufferPool::Recycler {
+    Recycler(const SharedPtr<CodedBufferPool>& pool)
+        : m_pool(pool)
+    {
+    }
+    void operator()(VaapiCodedBuffer* buf) const
+    {
+        SharedPtr<CodedBufferPool> pool = m_pool.lock();
+        if (pool)
+            pool->recycle(buf);
+        else
+            delete buf;
+    }
+
+private:
+    WeakPtr<CodedBufferPool> m_pool;
+};
+
+CodedBufferPool::CodedBufferPool(const ContextPtr& context, uint32_t bufSize, uint32_t maxBuffers)
+    : m_context(context)
+    , m_bufSize(bufSize)
+    , m_maxBuffers(maxBuffers)
+{
+}
+
+CodedBufferPool::~CodedBufferPool()
+{
+    for (size_t i = 0; i < m_freed.size(); i++)
+        delete m_freed[i];
+}
+
+CodedBufferPtr CodedBufferPool::alloc()
+{
+    CodedBufferPtr coded;
+    VaapiCodedBuffer* buf = NULL;
+    {
+        AutoLock lock(m_lock);
+        if (!m_freed.empty()) {
+            buf = m_freed.back();
+            m_freed.pop_back();
+        }
+    }
+    if (!buf) {
+        BufObjectPtr obj = VaapiBuffer::create(m_context, VAEncCodedBufferType, m_bufSize);
+        if (!obj)
+            return coded;
+        buf = new VaapiCodedBuffer(obj);
+    }
+    coded.reset(buf, Recycler(shared_from_this()));
+    return coded;
+}
+
+void CodedBufferPool::recycle(VaapiCodedBuffer* buf)
+{
+    buf->reset();
+    AutoLock lock(m_lock);
+    if (m_freed.size() < m_maxBuffers)
+        m_freed.push_back(buf);
+    else
+        delete buf;
+}
 }
@@ -16,13 +16,16 @@
 #ifndef vaapicodedbuffer_h
 #define vaapicodedbuffer_h
 
+#include "common/lock.h"
 #include "vaapi/VaapiBuffer.h"
 #include "vaapi/vaapiptrs.h"
 #include <stdlib.h>
+#include <vector>
 
 namespace YamiMediaCodec{
 class VaapiCodedBuffer
 {
+    friend class CodedBufferPool;
 public:
     static CodedBufferPtr create(const ContextPtr&, uint32_t bufSize);
     ~VaapiCodedBuffer() {}
@@ -38,9 +41,38 @@ public:
 private:
     VaapiCodedBuffer(const BufObjectPtr& buf):m_buf(buf), m_segments(NULL), m_flags(0) {}
     bool map();
+    //unmap and clear flags, so we can use it for next frame
+    void reset();
     BufObjectPtr m_buf;
     VACodedBufferSegment* m_segments;
     uint32_t m_flags;
 };
+
+/**
+ * \class CodedBufferPool
+ * \brief recycles coded buffers of same size. Coded buffers are large,
+ * creating them for every frame costs driver allocations and page faults.
+ * Buffers return to the pool when last reference dropped, it happens when
+ * the picture is popped from output queue.
+ */
+class CodedBufferPool : public EnableSharedFromThis<CodedBufferPool>
+{
+public:
+    CodedBufferPool(const ContextPtr&, uint32_t bufSize, uint32_t maxBuffers);
+    ~CodedBufferPool();
+    CodedBufferPtr alloc();
+    uint32_t getBufSize() const { return m_bufSize; }
+
+private:
+    struct Recycler;
+    void recycle(VaapiCodedBuffer*);
+
+    ContextPtr m_context;
+    uint32_t m_bufSize;
+    uint32_t m_maxBuffers;
+    Lock m_lock;
+    std::vector<VaapiCodedBuffer*> m_freed;
+    DISALLOW_COPY_AND_ASSIGN(CodedBufferPool);
+};
 }
 #endif //vaapicodedbuffer_h
@@ -21,7 +21,9 @@
 #include "vaapiencoder_base.h"
 #include <assert.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <math.h>
+#include <time.h>
 #include "common/common_def.h"
 #include "common/utils.h"
 #include "common/scopedlogger.h"
@@ -45,10 +47,36 @@
 
 const uint32_t MaxOutputBuffer=5;
 namespace YamiMediaCodec{
+
+static uint64_t getMicroseconds()
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts))
+        return 0;
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 VaapiEncoderBase::VaapiEncoderBase():
     m_entrypoint(VAEntrypointEncSlice),
     m_maxOutputBuffer(MaxOutputBuffer),
-    m_maxCodedbufSize(0)
+    m_maxCodedbufSize(0),
+    m_inputFourcc(0),
+    m_inputWidth(0),
+    m_inputHeight(0),
+    m_pipelineCond(m_lock),
+    m_renderThread("yami_enc_render"),
+    m_syncThread("yami_enc_sync"),
+    m_pipelineDepth(0),
+    m_pipelineStarted(false),
+    m_renderPending(0),
+    m_synced(0),
+    m_pipelineStatus(YAMI_SUCCESS),
+    m_uploadTime(0),
+    m_renderTime(0),
+    m_syncTime(0),
+    m_uploadCount(0),
+    m_renderCount(0),
+    m_syncCount(0)
 {
     FUNC_ENTER();
     m_externalDisplay.handle = 0,
@@ -96,21 +124,29 @@ YamiStatus VaapiEncoderBase::start(void)
     FUNC_ENTER();
     if (!initVA())
         return YAMI_FAIL;
+    if (!startPipeline())
+        return YAMI_FAIL;
 
     return YAMI_SUCCESS;
 }
 
 void VaapiEncoderBase::flush(void)
 {
-    /* Current version of VaapiEncoderBase::flush is empty fucntion
-     * But we may add something in future.All derive class need call this in derive::flush()
+    /* All derive class need call this in derive::flush(),
+     * and call flushPipeline() before they touch encoding states.
      */
+    flushPipeline();
 }
 
 YamiStatus VaapiEncoderBase::stop(void)
 {
     FUNC_ENTER();
-    m_output.clear();
+    stopPipeline();
+    {
+        AutoLock l(m_lock);
+        m_output.clear();
+        m_synced = 0;
+    }
     cleanupVA();
     return YAMI_SUCCESS;
 }
@@ -121,6 +157,149 @@ bool VaapiEncoderBase::isBusy()
     return m_output.size() >= m_maxOutputBuffer;
 }
 
+bool VaapiEncoderBase::startPipeline()
+{
+    if (!m_pipelineDepth)
+        return true;
+    if (!m_renderThread.start() || !m_syncThread.start()) {
+        ERROR("failed to start encoder pipeline");
+        stopPipeline();
+        return false;
+    }
+    AutoLock l(m_lock);
+    m_pipelineStarted = true;
+    m_pipelineStatus = YAMI_SUCCESS;
+    return true;
+}
+
+void VaapiEncoderBase::stopPipeline()
+{
+    //render thread posts to sync thread, stop it first
+    m_renderThread.stop();
+    m_syncThread.stop();
+    AutoLock l(m_lock);
+    m_pipelineStarted = false;
+    m_renderPending = 0;
+}
+
+void VaapiEncoderBase::flushPipeline()
+{
+    AutoLock l(m_lock);
+    while (m_renderPending)
+        m_pipelineCond.wait();
+}
+
+YamiStatus VaapiEncoderBase::reserveInput()
+{
+    if (!m_pipelineStarted)
+        return isBusy() ? YAMI_ENCODE_IS_BUSY : YAMI_SUCCESS;
+
+    AutoLock l(m_lock);
+    while (m_pipelineStatus == YAMI_SUCCESS) {
+        //every queued input may need a surface and coded buffer
+        bool full = m_output.size() + m_renderPending >= m_maxOutputBuffer;
+        if (!full && m_renderPending < m_pipelineDepth) {
+            m_renderPending++;
+            return YAMI_SUCCESS;
+        }
+        //only client can make room by getOutput(), stop blocking
+        if (full && !m_renderPending && m_synced == m_output.size())
+            return YAMI_ENCODE_IS_BUSY;
+        m_pipelineCond.wait();
+    }
+    YamiStatus status = m_pipelineStatus;
+    m_pipelineStatus = YAMI_SUCCESS;
+    return status;
+}
+
+void VaapiEncoderBase::cancelInput()
+{
+    if (!m_pipelineStarted)
+        return;
+    AutoLock l(m_lock);
+    m_renderPending--;
+    m_pipelineCond.broadcast();
+}
+
+YamiStatus VaapiEncoderBase::submitInput(const SurfacePtr& surface, uint64_t timeStamp, bool forceKeyFrame, uint64_t uploadStart)
+{
+    {
+        AutoLock l(m_lock);
+        m_uploadTime += getMicroseconds() - uploadStart;
+        m_uploadCount++;
+    }
+    if (!m_pipelineStarted) {
+        uint64_t start = getMicroseconds();
+        YamiStatus status = doEncode(surface, timeStamp, forceKeyFrame);
+        AutoLock l(m_lock);
+        m_renderTime += getMicroseconds() - start;
+        m_renderCount++;
+        return status;
+    }
+    m_renderThread.post(std::bind(&VaapiEncoderBase::renderJob, this, surface, timeStamp, forceKeyFrame));
+    return YAMI_SUCCESS;
+}
+
+void VaapiEncoderBase::renderJob(const SurfacePtr& surface, uint64_t timeStamp, bool forceKeyFrame)
+{
+    uint64_t start = getMicroseconds();
+    YamiStatus status = doEncode(surface, timeStamp, forceKeyFrame);
+
+    AutoLock l(m_lock);
+    m_renderTime += getMicroseconds() - start;
+    m_renderCount++;
+    if (status != YAMI_SUCCESS) {
+        ERROR("encode frame %" PRIu64 " failed, status = %d", timeStamp, status);
+        if (m_pipelineStatus == YAMI_SUCCESS)
+            m_pipelineStatus = status;
+    }
+    m_renderPending--;
+    m_pipelineCond.broadcast();
+}
+
+void VaapiEncoderBase::pushOutput(const PicturePtr& picture)
+{
+    AutoLock l(m_lock);
+    m_output.push_back(picture);
+    if (m_pipelineStarted)
+        m_syncThread.post(std::bind(&VaapiEncoderBase::syncJob, this, picture));
+}
+
+void VaapiEncoderBase::syncJob(const PicturePtr& picture)
+{
+    uint64_t start = getMicroseconds();
+    if (!picture->sync())
+        ERROR("sync picture failed");
+    //map coded buffer here, so client only copies it
+    if (picture->m_codedBuffer)
+        picture->m_codedBuffer->size();
+
+    AutoLock l(m_lock);
+    m_syncTime += getMicroseconds() - start;
+    m_syncCount++;
+    m_synced++;
+    m_pipelineCond.broadcast();
+}
+
+void VaapiEncoderBase::waitOutput()
+{
+    if (!m_pipelineStarted)
+        return;
+    AutoLock l(m_lock);
+    while (m_output.empty() && m_renderPending)
+        m_pipelineCond.wait();
+}
+
+void VaapiEncoderBase::getPipelineStats(VideoParamsPipeline* pipeline)
+{
+    AutoLock l(m_lock);
+    pipeline->depth = m_pipelineDepth;
+    pipeline->frames = m_syncCount;
+    pipeline->uploadLatency = m_uploadCount ? m_uploadTime / m_uploadCount : 0;
+    pipeline->renderLatency = m_renderCount ? m_renderTime / m_renderCount : 0;
+    pipeline->syncLatency = m_syncCount ? m_syncTime / m_syncCount : 0;
+}
+
 YamiStatus VaapiEncoderBase::encode(VideoEncRawBuffer* inBuffer)
 {
     FUNC_ENTER();
@@ -149,24 +328,32 @@ YamiStatus VaapiEncoderBase::encode(VideoFrameRawData* frame)
 
     FUNC_ENTER();
 
-    if (isBusy())
-        return YAMI_ENCODE_IS_BUSY;
+    YamiStatus status = reserveInput();
+    if (status != YAMI_SUCCESS)
+        return status;
+    uint64_t start = getMicroseconds();
     SurfacePtr surface = createSurface(frame);
-    if (!surface)
+    if (!surface) {
+        cancelInput();
         return YAMI_OUT_MEMORY;
-    return doEncode(surface, frame->timeStamp, frame->flags & VIDEO_FRAME_FLAGS_KEY);
+    }
+    return submitInput(surface, frame->timeStamp, frame->flags & VIDEO_FRAME_FLAGS_KEY, start);
 }
 
 YamiStatus VaapiEncoderBase::encode(const SharedPtr<VideoFrame>& frame)
 {
     if (!frame)
         return YAMI_INVALID_PARAM;
-    if (isBusy())
-        return YAMI_ENCODE_IS_BUSY;
+    YamiStatus status = reserveInput();
+    if (status != YAMI_SUCCESS)
+        return status;
+    uint64_t start = getMicroseconds();
     SurfacePtr surface = createSurface(frame);
-    if (!surface)
+    if (!surface) {
+        cancelInput();
         return YAMI_INVALID_PARAM;
-    return doEncode(surface, frame->timeStamp, frame->flags & VIDEO_FRAME_FLAGS_KEY);
+    }
+    return submitInput(surface, frame->timeStamp, frame->flags & VIDEO_FRAME_FLAGS_KEY, start);
 }
 
 YamiStatus VaapiEncoderBase::getParameters(VideoParamConfigType type, Yami_PTR videoEncParams)
@@ -203,6 +390,14 @@ YamiStatus VaapiEncoderBase::getParameters(VideoParamConfigType type, Yami_PTR v
 
         break;
     }
+    case VideoParamsTypePipeline: {
+        VideoParamsPipeline* pipeline = (VideoParamsPipeline*)videoEncParams;
+        if (pipeline->size == sizeof(VideoParamsPipeline)) {
+            getPipelineStats(pipeline);
+            ret = YAMI_SUCCESS;
+        }
+        break;
+    }
     default:
         ret = YAMI_SUCCESS;
         break;
@@ -273,6 +468,14 @@ YamiStatus VaapiEncoderBase::setParameters(VideoParamConfigType type, Yami_PTR v
             else
                 ret = YAMI_INVALID_PARAM;
         } break;
+    case VideoParamsTypePipeline: {
+        VideoParamsPipeline* pipeline = (VideoParamsPipeline*)videoEncParams;
+        //threads start in start(), depth can't change after it
+        if (pipeline->size == sizeof(VideoParamsPipeline) && !m_pipelineStarted)
+            m_pipelineDepth = pipeline->depth;
+        else
+            ret = YAMI_INVALID_PARAM;
+    } break;
     default:
         ret = YAMI_INVALID_PARAM;
         break;
@@ -356,6 +559,33 @@ SurfacePtr VaapiEncoderBase::createNewSurface(uint32_t fourcc)
     return surface;
 }
 
+SurfacePtr VaapiEncoderBase::createInputSurface(uint32_t fourcc)
+{
+    uint32_t width = m_videoParamCommon.resolution.width;
+    uint32_t height = m_videoParamCommon.resolution.height;
+    if (!m_inputPool || fourcc != m_inputFourcc
+        || width != m_inputWidth || height != m_inputHeight) {
+        //a surface is busy until its picture leaves output queue
+        std::deque<SurfacePtr> surfaces;
+        for (uint32_t i = 0; i < m_maxOutputBuffer; i++) {
+            SurfacePtr s = createNewSurface(fourcc);
+            if (!s)
+                return s;
+            surfaces.push_back(s);
+        }
+        m_inputPool.reset(new VideoPool<VaapiSurface>(surfaces));
+        m_inputFourcc = fourcc;
+        m_inputWidth = width;
+        m_inputHeight = height;
+    }
+    SurfacePtr surface = m_inputPool->alloc();
+    if (!surface) {
+        DEBUG("input surface pool exhausted, create a new one");
+        surface = createNewSurface(fourcc);
+    }
+    return surface;
+}
+
 SurfacePtr VaapiEncoderBase::createSurface()
 {
     SurfacePtr s;
@@ -397,19 +627,12 @@ SurfacePtr VaapiEncoderBase::createSurface(VideoFrameRawData* frame)
 {
     uint32_t fourcc = frame->fourcc;
 
-    SurfacePtr surface = createNewSurface(fourcc);
+    //driver likes nv12 more, convert to it during upload
+    SurfacePtr surface = createInputSurface(ImageCopier::getDestFourcc(fourcc));
     SurfacePtr nil;
     if (!surface)
         return nil;
 
-    uint32_t width[3];
-    uint32_t height[3];
-    uint32_t planes;
-    if (!getPlaneResolution(fourcc, frame->width, frame->height, width, height, planes)) {
-        ERROR("invalid input format");
-        return nil;
-    }
-
     VAImage image;
     VADisplay display = m_display->getID();
     uint8_t* dest = mapSurfaceToImage(display, surface->getID(), image);
@@ -418,13 +641,33 @@ SurfacePtr VaapiEncoderBase::createSurface(VideoFrameRawData* frame)
         return nil;
     }
     uint8_t* src = reinterpret_cast<uint8_t*>(frame->handle);
-    if (!copyImage(dest, image.offsets, image.pitches, src,
-            frame->offset, frame->pitch, width, height, planes)) {
+    bool copied;
+    if (ImageCopier::isSupported(fourcc, image.format.fourcc)) {
+        ImageLayout srcLayout, destLayout;
+        srcLayout.fourcc = fourcc;
+        destLayout.fourcc = image.format.fourcc;
+        for (uint32_t i = 0; i < 3; i++) {
+            srcLayout.offsets[i] = frame->offset[i];
+            srcLayout.pitches[i] = frame->pitch[i];
+            destLayout.offsets[i] = image.offsets[i];
+            destLayout.pitches[i] = image.pitches[i];
+        }
+        copied = m_copier.copy(dest, destLayout, src, srcLayout, frame->width, frame->height);
+    }
+    else {
+        uint32_t width[3];
+        uint32_t height[3];
+        uint32_t planes;
+        copied = fourcc == image.format.fourcc
+            && getPlaneResolution(fourcc, frame->width, frame->height, width, height, planes)
+            && copyImage(dest, image.offsets, image.pitches, src,
+                   frame->offset, frame->pitch, width, height, planes);
+    }
+    unmapImage(display, image);
+    if (!copied) {
         ERROR("failed to copy image");
-        unmapImage(display, image);
         return nil;
     }
-    unmapImage(display, image);
     return surface;
 }
 
@@ -434,6 +677,13 @@ SurfacePtr VaapiEncoderBase::createSurface(const SharedPtr<VideoFrame>& frame)
     return surface;
 }
 
+CodedBufferPtr VaapiEncoderBase::createCodedBuffer()
+{
+    if (!m_codedBufferPool || m_codedBufferPool->getBufSize() != m_maxCodedbufSize)
+        m_codedBufferPool.reset(new CodedBufferPool(m_context, m_maxCodedbufSize, m_maxOutputBuffer));
+    return m_codedBufferPool->alloc();
+}
+
 void VaapiEncoderBase::fill(VAEncMiscParameterHRD* hrd) const
 {
     if (m_videoParamsHRD.bufferSize && m_videoParamsHRD.initBufferFullness) {
@@ -556,6 +806,8 @@ VideoProfile VaapiEncoderBase::profile() const
 
 void VaapiEncoderBase::cleanupVA()
 {
+    m_codedBufferPool.reset();
+    m_inputPool.reset();
     m_pool.reset();
     m_alloc.reset();
     m_context.reset();
@@ -662,8 +914,19 @@ YamiStatus VaapiEncoderBase::checkEmpty(VideoEncOutputBuffer* outBuffer, bool* o
 
 void VaapiEncoderBase::getPicture(PicturePtr &outPicture)
 {
+    if (m_pipelineStarted) {
+        AutoLock l(m_lock);
+        while (!m_synced)
+            m_pipelineCond.wait();
+        outPicture = m_output.front();
+        return;
+    }
+    uint64_t start = getMicroseconds();
     outPicture = m_output.front();
     outPicture->sync();
+    AutoLock l(m_lock);
+    m_syncTime += getMicroseconds() - start;
+    m_syncCount++;
 }
 
 YamiStatus VaapiEncoderBase::checkCodecData(VideoEncOutputBuffer* outBuffer)
@@ -671,6 +934,9 @@ YamiStatus VaapiEncoderBase::checkCodecData(VideoEncOutputBuffer* outBuffer)
     if (outBuffer->format != OUTPUT_CODEC_DATA) {
         AutoLock l(m_lock);
         m_output.pop_front();
+        if (m_synced)
+            m_synced--;
+        m_pipelineCond.broadcast();
     }
     return YAMI_SUCCESS;
 }
@@ -682,6 +948,8 @@ YamiStatus VaapiEncoderBase::getOutput(VideoEncOutputBuffer* outBuffer, bool wit
     PicturePtr picture;
     YamiStatus ret;
     FUNC_ENTER();
+    if (withWait)
+        waitOutput();
     ret = checkEmpty(outBuffer, &isEmpty);
     if (isEmpty)
         return ret;
@@ -708,6 +976,8 @@ YamiStatus VaapiEncoderBase::getOutput(VideoEncOutputBuffer* outBuffer, VideoEnc
     YamiStatus ret;
     FUNC_ENTER();
 
+    if (withWait)
+        waitOutput();
     ret = checkEmpty(outBuffer, &isEmpty);
     if (isEmpty)
         return ret;
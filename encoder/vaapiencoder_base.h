@@ -19,9 +19,14 @@
 
 #include "VideoEncoderDefs.h"
 #include "VideoEncoderInterface.h"
+#include "common/ImageCopy.h"
+#include "common/Thread.h"
+#include "common/condition.h"
 #include "common/lock.h"
 #include "common/log.h"
 #include "common/surfacepool.h"
+#include "common/videopool.h"
+#include "vaapicodedbuffer.h"
 #include "vaapiencpicture.h"
 #include "vaapilayerid.h"
 #include "vaapi/VaapiBuffer.h"
@@ -91,6 +96,7 @@ protected:
     SurfacePtr createSurface();
     SurfacePtr createSurface(VideoFrameRawData* frame);
     SurfacePtr createSurface(const SharedPtr<VideoFrame>& frame);
+    CodedBufferPtr createCodedBuffer();
 
     template <class Pic>
     bool output(const SharedPtr<Pic>&);
@@ -166,6 +172,12 @@ protected:
     }
 
     bool isBusy();
+    /* wait for inputs queued to render thread. Derived flush(), setParameters() and
+     * getParameters() call this before they touch encoding states or take a lock
+     * doEncode() needs */
+    void flushPipeline();
+    //derived destructors call this, queued doEncode() calls need the derived part
+    void stopPipeline();
 
     bool mapToRange(uint32_t& value,
         uint32_t min, uint32_t max,
@@ -189,15 +201,57 @@ protected:
 private:
     bool initVA();
     void cleanupVA();
+    SurfacePtr createInputSurface(uint32_t fourcc);
     NativeDisplay m_externalDisplay;
 
     SharedPtr<SurfacePool> m_pool;
+    //surfaces to upload VideoFrameRawData, rebuilt when fourcc or resolution changed
+    SharedPtr<VideoPool<VaapiSurface> > m_inputPool;
+    uint32_t m_inputFourcc;
+    uint32_t m_inputWidth;
+    uint32_t m_inputHeight;
+    ImageCopier m_copier;
+    SharedPtr<CodedBufferPool> m_codedBufferPool;
     SharedPtr<SurfaceAllocator> m_alloc;
 
+    /* pipeline, enabled by VideoParamsTypePipeline.
+     * upload: caller thread, encode() copies input to a surface and queues it to render thread.
+     * render: m_renderThread calls doEncode(), pictures goes to m_output and sync thread.
+     * sync: m_syncThread waits the picture and maps coded buffer, getOutput() only copies.
+     */
+    bool startPipeline();
+    YamiStatus reserveInput();
+    void cancelInput();
+    YamiStatus submitInput(const SurfacePtr&, uint64_t timeStamp, bool forceKeyFrame, uint64_t uploadStart);
+    void renderJob(const SurfacePtr&, uint64_t timeStamp, bool forceKeyFrame);
+    void syncJob(const PicturePtr&);
+    void pushOutput(const PicturePtr&);
+    void waitOutput();
+    void getPipelineStats(VideoParamsPipeline*);
+
     Lock m_lock;
     typedef std::deque<PicturePtr> OutputQueue;
     OutputQueue m_output;
 
+    Condition m_pipelineCond;
+    Thread m_renderThread;
+    Thread m_syncThread;
+    uint32_t m_pipelineDepth;
+    bool m_pipelineStarted;
+    //inputs queued to or running in render thread
+    uint32_t m_renderPending;
+    //pictures at the front of m_output which are synced
+    uint32_t m_synced;
+    //first error from render thread, returned by next encode()
+    YamiStatus m_pipelineStatus;
+    //time spent in each stage, in microseconds
+    uint64_t m_uploadTime;
+    uint64_t m_renderTime;
+    uint64_t m_syncTime;
+    uint32_t m_uploadCount;
+    uint32_t m_renderCount;
+    uint32_t m_syncCount;
+
     bool updateMaxOutputBufferCount() {
         if (m_maxOutputBuffer < m_videoParamCommon.leastInputCount + 3)
             m_maxOutputBuffer = m_videoParamCommon.leastInputCount + 3;
@@ -210,10 +264,9 @@ bool VaapiEncoderBase::output(const SharedPtr<Pic>& pic)
 {
     bool ret;
     PicturePtr picture;
-    AutoLock l(m_lock);
     picture = DynamicPointerCast<VaapiEncPicture>(pic);
     if (picture) {
-        m_output.push_back(picture);
+        pushOutput(picture);
         ret = true;
     } else {
         ERROR("output need a subclass of VaapiEncPicutre");
@@ -24,6 +24,7 @@
 #include "common/scopedlogger.h"
 #include "common/common_def.h"
 #include "common/Functional.h"
+#include "common/utils.h"
 #include "vaapi/vaapicontext.h"
 #include "vaapi/vaapidisplay.h"
 #include "vaapicodedbuffer.h"
@@ -172,34 +173,13 @@ static uint8_t h264_get_profile_idc(VideoProfile profile)
 BOOL
 bit_writer_put_ue(BitWriter *bitwriter, uint32_t value)
 {
-    uint32_t  size_in_bits = 0;
-    uint32_t  tmp_value = ++value;
-
-    while (tmp_value) {
-        ++size_in_bits;
-        tmp_value >>= 1;
-    }
-    if (size_in_bits > 1
-        && !bitwriter->writeBits(0, size_in_bits - 1))
-        return FALSE;
-    if (!bitwriter->writeBits(value, size_in_bits))
-        return FALSE;
-    return TRUE;
+    return bitwriter->writeUe(value);
 }
 
 BOOL
 bit_writer_put_se(BitWriter *bitwriter, int32_t value)
 {
-    uint32_t new_val;
-
-    if (value <= 0)
-        new_val = -(value<<1);
-    else
-        new_val = (value<<1) - 1;
-
-    if (!bit_writer_put_ue(bitwriter, new_val))
-        return FALSE;
-    return TRUE;
+    return bitwriter->writeSe(value);
 }
 
 
@@ -573,6 +553,25 @@ bit_writer_write_pps(
     return TRUE;
 }
 
+/* hash of what bit_writer_write_pps writes, per picture fields are left out */
+static uint64_t hashPPS(const VAEncPictureParameterBufferH264* const pic)
+{
+    VAEncPictureParameterBufferH264 key;
+
+    memset(&key, 0, sizeof(key));
+    key.pic_parameter_set_id = pic->pic_parameter_set_id;
+    key.seq_parameter_set_id = pic->seq_parameter_set_id;
+    key.num_ref_idx_l0_active_minus1 = pic->num_ref_idx_l0_active_minus1;
+    key.num_ref_idx_l1_active_minus1 = pic->num_ref_idx_l1_active_minus1;
+    key.pic_init_qp = pic->pic_init_qp;
+    key.chroma_qp_index_offset = pic->chroma_qp_index_offset;
+    key.second_chroma_qp_index_offset = pic->second_chroma_qp_index_offset;
+    key.pic_fields = pic->pic_fields;
+    key.pic_fields.bits.idr_pic_flag = 0;
+    key.pic_fields.bits.reference_pic_flag = 0;
+    return hashBytes(&key, sizeof(key));
+}
+
 class VaapiEncStreamHeaderH264
 {
     typedef std::vector<uint8_t> Header;
@@ -582,6 +581,7 @@ public:
     {
         ASSERT(m_sei.empty());
         BitWriter bs;
+        bs.setEmulationPrevention(true);
         bit_writer_write_sei(&bs, seqParam, temporalLayerNum, svctFrameRate);
         bsToHeader(m_sei, bs);
     }
@@ -590,6 +590,7 @@ public:
     {
         ASSERT(m_sps.empty());
         BitWriter bs;
+        bs.setEmulationPrevention(true);
         bit_writer_write_sps (&bs, sequence, profile);
         bsToHeader(m_sps, bs);
     }
@@ -611,10 +612,20 @@ public:
     {
         ASSERT(m_sps.size() && m_pps.empty());
         BitWriter bs;
+        bs.setEmulationPrevention(true);
         bit_writer_write_pps (&bs, picParam);
         bsToHeader(m_pps, bs);
     }
 
+    bool hasPPS() const { return !m_pps.empty(); }
+
+    /* drop pps and codec config, keep sei and sps */
+    void resetPPS()
+    {
+        m_pps.clear();
+        m_headers.clear();
+    }
+
     void generateCodecConfig(bool isAVCc)
     {
         ASSERT(m_sps.size() && (m_sps.size() > 4)&& m_pps.size() && m_headers.empty());
@@ -649,29 +660,6 @@ private:
         param.insert(param.end(), codedData, codedData + codedBytes);
     }
 
-    void appendHeaderWithEmulation(Header& h)
-    {
-        Header::iterator s = h.begin();
-        Header::iterator e;
-        uint8_t zeros[] = {0, 0};
-        uint8_t emulation[] = {0, 0, 3};
-        do {
-            e = std::search(s, h.end(), zeros, zeros + N_ELEMENTS(zeros));
-            m_headers.insert(m_headers.end(), s, e);
-            if (e == h.end())
-                break;
-
-            s = e + N_ELEMENTS(zeros);
-
-            /* only when bitstream contains 0x000000/0x000001/0x000002/0x000003
-               need to insert emulation prevention byte 0x03 */
-            if (*s <= 3)
-                m_headers.insert(m_headers.end(), emulation, emulation + N_ELEMENTS(emulation));
-            else
-                m_headers.insert(m_headers.end(), zeros, zeros + N_ELEMENTS(zeros));
-         } while (1);
-    }
-
     void generateCodecConfigAnnexB()
     {
         std::vector<Header*> headers;
@@ -682,7 +670,7 @@ private:
         uint8_t sync[] = {0, 0, 0, 1};
         for (size_t i = 0; i < headers.size(); i++) {
             m_headers.insert(m_headers.end(), sync, sync + N_ELEMENTS(sync));
-            appendHeaderWithEmulation(*headers[i]);
+            m_headers.insert(m_headers.end(), headers[i]->begin(), headers[i]->end());
         }
     }
 
@@ -831,6 +819,8 @@ VaapiEncoderH264::VaapiEncoderH264()
     , m_keyPeriod(30)
     , m_ppsQp(26)
     , m_idrNum(0)
+    , m_sequenceHeaderHash(0)
+    , m_pictureHeaderHash(0)
 {
     m_videoParamCommon.profile = VAProfileH264Main;
     m_videoParamCommon.level = 40;
@@ -852,6 +842,7 @@ VaapiEncoderH264::VaapiEncoderH264()
 VaapiEncoderH264::~VaapiEncoderH264()
 {
     FUNC_ENTER();
+    stopPipeline();
 }
 
 bool VaapiEncoderH264::ensureCodedBufferSize()
@@ -1073,6 +1064,7 @@ void VaapiEncoderH264::flush()
     YamiStatus ret;
 
     FUNC_ENTER();
+    flushPipeline();
 
     if (!m_reorderFrameList.empty()) {
         changeLastBFrameToPFrame();
@@ -1100,6 +1092,7 @@ YamiStatus VaapiEncoderH264::stop()
 YamiStatus VaapiEncoderH264::setParameters(VideoParamConfigType type, Yami_PTR videoEncParams)
 {
     YamiStatus status = YAMI_INVALID_PARAM;
+    flushPipeline();
     AutoLock locker(m_paramLock);
 
     FUNC_ENTER();
@@ -1132,6 +1125,7 @@ YamiStatus VaapiEncoderH264::setParameters(VideoParamConfigType type, Yami_PTR v
 YamiStatus VaapiEncoderH264::getParameters(VideoParamConfigType type, Yami_PTR videoEncParams)
 {
     YamiStatus status = YAMI_INVALID_PARAM;
+    flushPipeline();
     AutoLock locker(m_paramLock);
 
     FUNC_ENTER();
@@ -1227,7 +1221,7 @@ YamiStatus VaapiEncoderH264::encodeAllFrames()
     while (m_reorderState == VAAPI_ENC_REORD_DUMP_FRAMES) {
         if (!m_maxCodedbufSize)
             ensureCodedBufferSize();
-        CodedBufferPtr codedBuffer = VaapiCodedBuffer::create(m_context, m_maxCodedbufSize);
+        CodedBufferPtr codedBuffer = createCodedBuffer();
         if (!codedBuffer)
             return YAMI_OUT_MEMORY;
         PicturePtr picture = m_reorderFrameList.front();
@@ -1536,17 +1530,43 @@ bool VaapiEncoderH264::fill(VAEncPictureParameterBufferH264* picParam, const Pic
 
 bool VaapiEncoderH264::ensureSequenceHeader(const PicturePtr& picture,const VAEncSequenceParameterBufferH264* const sequence)
 {
+    uint64_t hash = hashBytes(sequence, sizeof(*sequence));
+    VideoProfile videoProfile = profile();
+    hash = hashBytes(&videoProfile, sizeof(videoProfile), hash);
+    if (m_isSvcT) {
+        hash = hashBytes(&m_temporalLayerNum, sizeof(m_temporalLayerNum), hash);
+        if (!m_svctFrameRate.empty())
+            hash = hashBytes(&m_svctFrameRate[0],
+                m_svctFrameRate.size() * sizeof(m_svctFrameRate[0]), hash);
+    }
+
+    //same sequence, keep sei and sps from last idr
+    if (m_headers && hash == m_sequenceHeaderHash)
+        return true;
+
     m_headers.reset(new VaapiEncStreamHeaderH264());
     if (m_isSvcT)
         m_headers->setSEI(sequence, m_temporalLayerNum, m_svctFrameRate);
     m_headers->setSPS(sequence, profile());
+    m_sequenceHeaderHash = hash;
     return true;
 }
 
 bool VaapiEncoderH264::ensurePictureHeader(const PicturePtr& picture, const VAEncPictureParameterBufferH264* const picParam)
 {
-    m_headers->addPPS(picParam);
-    m_headers->generateCodecConfig(m_streamFormat == AVC_STREAM_FORMAT_AVCC);
+    uint64_t hash = hashPPS(picParam);
+    hash = hashBytes(&m_streamFormat, sizeof(m_streamFormat), hash);
+
+    if (!m_headers->hasPPS() || hash != m_pictureHeaderHash) {
+        if (m_headers->hasPPS()) {
+            //pictures in flight may still hold the old headers
+            m_headers.reset(new VaapiEncStreamHeaderH264(*m_headers));
+            m_headers->resetPPS();
+        }
+        m_headers->addPPS(picParam);
+        m_headers->generateCodecConfig(m_streamFormat == AVC_STREAM_FORMAT_AVCC);
+        m_pictureHeaderHash = hash;
+    }
     picture->m_headers = m_headers;
     return true;
 }
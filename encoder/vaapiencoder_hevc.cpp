@@ -24,6 +24,7 @@
 #include "common/scopedlogger.h"
 #include "common/common_def.h"
 #include "common/Functional.h"
+#include "common/utils.h"
 #include "vaapi/vaapicontext.h"
 #include "vaapi/vaapidisplay.h"
 #include "vaapicodedbuffer.h"
@@ -163,34 +164,13 @@ static uint8_t hevc_get_profile_idc(VideoProfile profile)
 static BOOL
 bit_writer_put_ue(BitWriter *bitwriter, uint32_t value)
 {
-    uint32_t  size_in_bits = 0;
-    uint32_t  tmp_value = ++value;
-
-    while (tmp_value) {
-        ++size_in_bits;
-        tmp_value >>= 1;
-    }
-    if (size_in_bits > 1
-        && !bitwriter->writeBits(0, size_in_bits - 1))
-        return FALSE;
-    if (!bitwriter->writeBits(value, size_in_bits))
-        return FALSE;
-    return TRUE;
+    return bitwriter->writeUe(value);
 }
 
 static BOOL
 bit_writer_put_se(BitWriter *bitwriter, int32_t value)
 {
-    uint32_t new_val;
-
-    if (value <= 0)
-        new_val = -(value<<1);
-    else
-        new_val = (value<<1) - 1;
-
-    if (!bit_writer_put_ue(bitwriter, new_val))
-        return FALSE;
-    return TRUE;
+    return bitwriter->writeSe(value);
 }
 
 static BOOL
@@ -307,6 +287,7 @@ public:
     {
         ASSERT(m_vps.empty());
         BitWriter bs;
+        bs.setEmulationPrevention(true);
         bit_writer_write_vps (&bs, sequence);
         bsToHeader(m_vps, bs);
     }
@@ -315,6 +296,7 @@ public:
     {
         ASSERT(m_vps.size() && m_sps.empty());
         BitWriter bs;
+        bs.setEmulationPrevention(true);
         bit_writer_write_sps (&bs, sequence);
         bsToHeader(m_sps, bs);
     }
@@ -323,10 +305,20 @@ public:
     {
         ASSERT(m_sps.size() && m_pps.empty());
         BitWriter bs;
+        bs.setEmulationPrevention(true);
         bit_writer_write_pps (&bs, picParam);
         bsToHeader(m_pps, bs);
     }
 
+    bool hasPPS() const { return !m_pps.empty(); }
+
+    /* drop pps and codec config, keep vps and sps */
+    void resetPPS()
+    {
+        m_pps.clear();
+        m_headers.clear();
+    }
+
     void generateCodecConfig()
     {
         std::vector<Header*> headers;
@@ -339,7 +331,7 @@ public:
         uint8_t sync[] = {0, 0, 0, 1};
         for (size_t i = 0; i < headers.size(); i++) {
             m_headers.insert(m_headers.end(), sync, sync + N_ELEMENTS(sync));
-            appendHeaderWithEmulation(*headers[i]);
+            m_headers.insert(m_headers.end(), headers[i]->begin(), headers[i]->end());
         }
     }
 
@@ -738,28 +730,6 @@ private:
         param.insert(param.end(), codedData, codedData + codedBytes);
     }
 
-    void appendHeaderWithEmulation(Header& h)
-    {
-        Header::iterator s = h.begin();
-        Header::iterator e;
-        uint8_t zeros[] = {0, 0};
-        uint8_t emulation[] = {0, 0, 3};
-        do {
-            e = std::search(s, h.end(), zeros, zeros + N_ELEMENTS(zeros));
-            m_headers.insert(m_headers.end(), s, e);
-            if (e == h.end())
-                break;
-
-            s = e + N_ELEMENTS(zeros);
-
-            /* only when bitstream contains 0x000000/0x000001/0x000002/0x000003
-               need to insert emulation prevention byte 0x03 */
-            if (*s <= 3)
-                m_headers.insert(m_headers.end(), emulation, emulation + N_ELEMENTS(emulation));
-            else
-                m_headers.insert(m_headers.end(), zeros, zeros + N_ELEMENTS(zeros));
-         } while (1);
-    }
 
     Header m_vps;
     Header m_sps;
@@ -859,7 +829,9 @@ VaapiEncoderHEVC::VaapiEncoderHEVC():
     m_minTbSize(4),
     m_maxTbSize(32),
     m_reorderState(VAAPI_ENC_REORD_WAIT_FRAMES),
-    m_keyPeriod(30)
+    m_keyPeriod(30),
+    m_sequenceHeaderHash(0),
+    m_pictureHeaderHash(0)
 {
     m_videoParamCommon.profile = VAProfileHEVCMain;
     m_videoParamCommon.level = 51;
@@ -873,6 +845,7 @@ VaapiEncoderHEVC::VaapiEncoderHEVC():
 VaapiEncoderHEVC::~VaapiEncoderHEVC()
 {
     FUNC_ENTER();
+    stopPipeline();
 }
 
 bool VaapiEncoderHEVC::ensureCodedBufferSize()
@@ -972,6 +945,9 @@ void VaapiEncoderHEVC::resetParams ()
     setShortRfs();
 
     resetGopStart();
+
+    //vps and sps also depend on the values above
+    m_headers.reset();
 }
 
 YamiStatus VaapiEncoderHEVC::getMaxOutSize(uint32_t* maxSize)
@@ -998,6 +974,7 @@ void VaapiEncoderHEVC::flush()
     YamiStatus ret;
 
     FUNC_ENTER();
+    flushPipeline();
 
     if (!m_reorderFrameList.empty()) {
         changeLastBFrameToPFrame();
@@ -1024,6 +1001,7 @@ YamiStatus VaapiEncoderHEVC::stop()
 YamiStatus VaapiEncoderHEVC::setParameters(VideoParamConfigType type, Yami_PTR videoEncParams)
 {
     YamiStatus status = YAMI_INVALID_PARAM;
+    flushPipeline();
     AutoLock locker(m_paramLock);
 
     FUNC_ENTER();
@@ -1048,6 +1026,7 @@ YamiStatus VaapiEncoderHEVC::setParameters(VideoParamConfigType type, Yami_PTR v
 YamiStatus VaapiEncoderHEVC::getParameters(VideoParamConfigType type, Yami_PTR videoEncParams)
 {
     YamiStatus status = YAMI_INVALID_PARAM;
+    flushPipeline();
     AutoLock locker(m_paramLock);
 
     FUNC_ENTER();
@@ -1122,7 +1101,7 @@ YamiStatus VaapiEncoderHEVC::encodeAllFrames()
         if (!m_maxCodedbufSize)
             ensureCodedBufferSize();
         ASSERT(m_maxCodedbufSize);
-        CodedBufferPtr codedBuffer = VaapiCodedBuffer::create(m_context, m_maxCodedbufSize);
+        CodedBufferPtr codedBuffer = createCodedBuffer();
         if (!codedBuffer)
             return YAMI_OUT_MEMORY;
         DEBUG("m_reorderFrameList size: %zu\n", m_reorderFrameList.size());
@@ -1495,18 +1474,54 @@ bool VaapiEncoderHEVC::fill(VAEncPictureParameterBufferHEVC* picParam, const Pic
     return TRUE;
 }
 
+/* hash of what bit_writer_write_pps writes, per picture fields are left out */
+static uint64_t hashPPS(const VAEncPictureParameterBufferHEVC* const pic)
+{
+    VAEncPictureParameterBufferHEVC key;
+
+    memset(&key, 0, sizeof(key));
+    key.num_ref_idx_l0_default_active_minus1 = pic->num_ref_idx_l0_default_active_minus1;
+    key.num_ref_idx_l1_default_active_minus1 = pic->num_ref_idx_l1_default_active_minus1;
+    key.pic_init_qp = pic->pic_init_qp;
+    key.diff_cu_qp_delta_depth = pic->diff_cu_qp_delta_depth;
+    key.pps_cb_qp_offset = pic->pps_cb_qp_offset;
+    key.pps_cr_qp_offset = pic->pps_cr_qp_offset;
+    key.pic_fields = pic->pic_fields;
+    key.pic_fields.bits.idr_pic_flag = 0;
+    key.pic_fields.bits.coding_type = 0;
+    key.pic_fields.bits.reference_pic_flag = 0;
+    return hashBytes(&key, sizeof(key));
+}
+
 bool VaapiEncoderHEVC::ensureSequenceHeader(const PicturePtr& picture,const VAEncSequenceParameterBufferHEVC* const sequence)
 {
+    uint64_t hash = hashBytes(sequence, sizeof(*sequence));
+
+    //same sequence, keep vps and sps from last intra picture
+    if (m_headers && hash == m_sequenceHeaderHash)
+        return true;
+
     m_headers.reset(new VaapiEncStreamHeaderHEVC(this));
     m_headers->setVPS(sequence);
     m_headers->setSPS(sequence);
+    m_sequenceHeaderHash = hash;
     return true;
 }
 
 bool VaapiEncoderHEVC::ensurePictureHeader(const PicturePtr& picture, const VAEncPictureParameterBufferHEVC* const picParam)
 {
-    m_headers->addPPS(picParam);
-    m_headers->generateCodecConfig();
+    uint64_t hash = hashPPS(picParam);
+
+    if (!m_headers->hasPPS() || hash != m_pictureHeaderHash) {
+        if (m_headers->hasPPS()) {
+            //pictures in flight may still hold the old headers
+            m_headers.reset(new VaapiEncStreamHeaderHEVC(*m_headers));
+            m_headers->resetPPS();
+        }
+        m_headers->addPPS(picParam);
+        m_headers->generateCodecConfig();
+        m_pictureHeaderHash = hash;
+    }
     picture->m_headers = m_headers;
     return true;
 }
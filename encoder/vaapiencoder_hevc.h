@@ -162,6 +162,9 @@ private:
 
     ShortRFS m_shortRFS;
     StreamHeaderPtr m_headers;
+    //parameter sets are only rebuilt when these change
+    uint64_t m_sequenceHeaderHash;
+    uint64_t m_pictureHeaderHash;
     Lock m_paramLock; // locker for parameters update, for example: m_sps/m_pps/m_maxCodedbufSize (width/height etc)
 
     /**
@@ -297,6 +297,7 @@ YamiStatus VaapiEncoderJpeg::setParameters(VideoParamConfigType type, Yami_PTR v
 {
     YamiStatus status = YAMI_SUCCESS;
     FUNC_ENTER();
+    flushPipeline();
     if (!videoEncParams)
         return YAMI_INVALID_PARAM;
 
@@ -327,6 +328,7 @@ YamiStatus VaapiEncoderJpeg::setParameters(VideoParamConfigType type, Yami_PTR v
 YamiStatus VaapiEncoderJpeg::getParameters(VideoParamConfigType type, Yami_PTR videoEncParams)
 {
     FUNC_ENTER();
+    flushPipeline();
     if (!videoEncParams)
         return YAMI_INVALID_PARAM;
 
@@ -337,7 +339,7 @@ YamiStatus VaapiEncoderJpeg::doEncode(const SurfacePtr& surface, uint64_t timeSt
 {
     FUNC_ENTER();
     YamiStatus ret;
-    CodedBufferPtr codedBuffer = VaapiCodedBuffer::create(m_context, m_maxCodedbufSize);
+    CodedBufferPtr codedBuffer = createCodedBuffer();
     PicturePtr picture(new VaapiEncPictureJPEG(m_context, surface, timeStamp));
     picture->m_codedBuffer = codedBuffer;
     ret = encodePicture(picture);
@@ -29,7 +29,7 @@ public:
     typedef SharedPtr<VaapiEncPictureJPEG> PicturePtr;
 
     VaapiEncoderJpeg();
-    virtual ~VaapiEncoderJpeg() { }
+    virtual ~VaapiEncoderJpeg() { stopPipeline(); }
     virtual YamiStatus start();
     virtual void flush();
     virtual YamiStatus stop();
@@ -37,8 +37,12 @@
 // library headers
 #include "common/Array.h"
 #include "common/utils.h"
+#if __ENABLE_NULL_DRIVER__
+#include "vaapi/VaapiNullDisplayTest.h"
+#endif
 
 // system headers
+#include <string.h>
 #include <string>
 #include <vector>
 
@@ -272,6 +276,33 @@ VAAPIENCODER_JPEG_TEST(QualityParamSetGet) {
     }
 }
 
+VAAPIENCODER_JPEG_TEST(PipelineParamSetGet) {
+    VaapiEncoderJpeg encoder;
+    VideoParamsPipeline pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.size = sizeof(VideoParamsPipeline);
+
+    // disabled by default, no frame encoded
+    EXPECT_EQ(YAMI_SUCCESS,
+        encoder.getParameters(VideoParamsTypePipeline, &pipeline));
+    EXPECT_EQ(0u, pipeline.depth);
+    EXPECT_EQ(0u, pipeline.frames);
+    EXPECT_EQ(0u, pipeline.renderLatency);
+
+    pipeline.depth = 3;
+    EXPECT_EQ(YAMI_SUCCESS,
+        encoder.setParameters(VideoParamsTypePipeline, &pipeline));
+    pipeline.depth = 0;
+    EXPECT_EQ(YAMI_SUCCESS,
+        encoder.getParameters(VideoParamsTypePipeline, &pipeline));
+    EXPECT_EQ(3u, pipeline.depth);
+
+    // wrong size
+    pipeline.size = 0;
+    EXPECT_EQ(YAMI_INVALID_PARAM,
+        encoder.setParameters(VideoParamsTypePipeline, &pipeline));
+}
+
 class SimpleDataTest
     : public VaapiEncoderJpegTest
     , public ::testing::WithParamInterface<const char*>
@@ -376,4 +407,121 @@ INSTANTIATE_TEST_CASE_P(
     // "YV12", "UYVY", "RGBX", "BGRX", "BGRA", "RGBA"
 );
 
+#if __ENABLE_NULL_DRIVER__
+class VaapiEncoderJpegNullTest : public NullDisplayTest {
+protected:
+    //10x10 NV12 jpeg encoder on the null display, with pipeline depth
+    void start(VaapiEncoderJpeg& encoder, uint32_t depth)
+    {
+        NativeDisplay native = { (intptr_t)m_vaDisplay, NATIVE_DISPLAY_VA };
+        encoder.setNativeDisplay(&native);
+
+        VideoParamsCommon parameters;
+        memset(&parameters, 0, sizeof(parameters));
+        parameters.size = sizeof(VideoParamsCommon);
+        ASSERT_EQ(YAMI_SUCCESS, encoder.getParameters(VideoParamsTypeCommon, &parameters));
+        parameters.resolution.width = 10;
+        parameters.resolution.height = 10;
+        ASSERT_EQ(YAMI_SUCCESS, encoder.setParameters(VideoParamsTypeCommon, &parameters));
+
+        VideoParamsPipeline pipeline;
+        memset(&pipeline, 0, sizeof(pipeline));
+        pipeline.size = sizeof(VideoParamsPipeline);
+        pipeline.depth = depth;
+        ASSERT_EQ(YAMI_SUCCESS, encoder.setParameters(VideoParamsTypePipeline, &pipeline));
+        ASSERT_EQ(YAMI_SUCCESS, encoder.start());
+
+        uint32_t size;
+        encoder.getMaxOutSize(&size);
+        m_outData.resize(size);
+    }
+
+    YamiStatus encode(VaapiEncoderJpeg& encoder)
+    {
+        VideoFrameRawData frame;
+        memset(&frame, 0, sizeof(frame));
+        EXPECT_TRUE(fillFrameRawData(&frame, VA_FOURCC_NV12, 10, 10,
+            const_cast<uint8_t*>(g_SimpleSmallNV12.data())));
+        return encoder.encode(&frame);
+    }
+
+    YamiStatus getOutput(VaapiEncoderJpeg& encoder, bool withWait)
+    {
+        VideoEncOutputBuffer output;
+        memset(&output, 0, sizeof(output));
+        output.data = &m_outData[0];
+        output.bufferSize = m_outData.size();
+        output.format = OUTPUT_EVERYTHING;
+        return encoder.getOutput(&output, withWait);
+    }
+
+    uint32_t getEncodedFrames(VaapiEncoderJpeg& encoder)
+    {
+        VideoParamsPipeline pipeline;
+        memset(&pipeline, 0, sizeof(pipeline));
+        pipeline.size = sizeof(VideoParamsPipeline);
+        EXPECT_EQ(YAMI_SUCCESS, encoder.getParameters(VideoParamsTypePipeline, &pipeline));
+        return pipeline.frames;
+    }
+
+    std::vector<uint8_t> m_outData;
+};
+
+#define VAAPIENCODER_JPEG_NULL_TEST(name) \
+    TEST_F(VaapiEncoderJpegNullTest, name)
+
+VAAPIENCODER_JPEG_NULL_TEST(PipelineBusy)
+{
+    VaapiEncoderJpeg encoder;
+    start(encoder, 2);
+
+    //encode() blocks for the pipeline, busy only when finished frames fill the output queue
+    uint32_t queued = 0;
+    YamiStatus status;
+    while ((status = encode(encoder)) == YAMI_SUCCESS)
+        queued++;
+    EXPECT_EQ(YAMI_ENCODE_IS_BUSY, status);
+    ASSERT_LT(0u, queued);
+    EXPECT_EQ(queued, getEncodedFrames(encoder));
+
+    //one output makes room for one input
+    EXPECT_EQ(YAMI_SUCCESS, getOutput(encoder, false));
+    EXPECT_EQ(YAMI_SUCCESS, encode(encoder));
+    EXPECT_EQ(YAMI_ENCODE_IS_BUSY, encode(encoder));
+
+    for (uint32_t i = 0; i < queued; i++)
+        EXPECT_EQ(YAMI_SUCCESS, getOutput(encoder, true));
+    EXPECT_EQ(YAMI_ENCODE_BUFFER_NO_MORE, getOutput(encoder, false));
+    EXPECT_EQ(YAMI_SUCCESS, encoder.stop());
+}
+
+VAAPIENCODER_JPEG_NULL_TEST(PipelineSetParameters)
+{
+    VaapiEncoderJpeg encoder;
+    start(encoder, 2);
+    EXPECT_EQ(YAMI_SUCCESS, encode(encoder));
+    EXPECT_EQ(YAMI_SUCCESS, encode(encoder));
+
+    //waits for the queued frames, they are ready after it
+    VideoParamsQualityLevel quality;
+    memset(&quality, 0, sizeof(quality));
+    quality.size = sizeof(VideoParamsQualityLevel);
+    quality.level = 90;
+    EXPECT_EQ(YAMI_SUCCESS, encoder.setParameters(VideoParamsTypeQualityLevel, &quality));
+    EXPECT_EQ(YAMI_SUCCESS, getOutput(encoder, false));
+    EXPECT_EQ(YAMI_SUCCESS, getOutput(encoder, false));
+    EXPECT_EQ(YAMI_SUCCESS, encoder.stop());
+}
+
+VAAPIENCODER_JPEG_NULL_TEST(PipelineReleaseWithoutStop)
+{
+    //queued frames are encoded before the encoder is gone
+    VaapiEncoderJpeg* encoder = new VaapiEncoderJpeg;
+    start(*encoder, 4);
+    for (int i = 0; i < 4; i++)
+        EXPECT_EQ(YAMI_SUCCESS, encode(*encoder));
+    delete encoder;
+}
+#endif
+
 }
@@ -181,6 +181,7 @@ VaapiEncoderVP8::VaapiEncoderVP8():
 
 VaapiEncoderVP8::~VaapiEncoderVP8()
 {
+    stopPipeline();
 }
 
 YamiStatus VaapiEncoderVP8::getMaxOutSize(uint32_t* maxSize)
@@ -229,6 +230,7 @@ YamiStatus VaapiEncoderVP8::start()
 void VaapiEncoderVP8::flush()
 {
     FUNC_ENTER();
+    flushPipeline();
     m_frameCount = 0;
     m_last.reset();
     m_golden.reset();
@@ -246,6 +248,7 @@ YamiStatus VaapiEncoderVP8::setParameters(VideoParamConfigType type, Yami_PTR vi
 {
     YamiStatus status = YAMI_SUCCESS;
     FUNC_ENTER();
+    flushPipeline();
     if (!videoEncParams)
         return YAMI_INVALID_PARAM;
 
@@ -260,6 +263,7 @@ YamiStatus VaapiEncoderVP8::setParameters(VideoParamConfigType type, Yami_PTR vi
 YamiStatus VaapiEncoderVP8::getParameters(VideoParamConfigType type, Yami_PTR videoEncParams)
 {
     FUNC_ENTER();
+    flushPipeline();
     if (!videoEncParams)
         return YAMI_INVALID_PARAM;
 
@@ -285,7 +289,7 @@ YamiStatus VaapiEncoderVP8::doEncode(const SurfacePtr& surface, uint64_t timeSta
 
     m_qIndex = (initQP() > minQP() && initQP() < maxQP()) ? initQP() : VP8_DEFAULT_QP;
 
-    CodedBufferPtr codedBuffer = VaapiCodedBuffer::create(m_context, m_maxCodedbufSize);
+    CodedBufferPtr codedBuffer = createCodedBuffer();
     if (!codedBuffer)
         return YAMI_OUT_MEMORY;
     picture->m_codedBuffer = codedBuffer;
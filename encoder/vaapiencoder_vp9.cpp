@@ -68,7 +68,7 @@ VaapiEncoderVP9::VaapiEncoderVP9()
     m_maxOutputBuffer = kMaxReferenceFrames;
 }
 
-VaapiEncoderVP9::~VaapiEncoderVP9() {}
+VaapiEncoderVP9::~VaapiEncoderVP9() { stopPipeline(); }
 
 YamiStatus VaapiEncoderVP9::getMaxOutSize(uint32_t* maxSize)
 {
@@ -113,6 +113,7 @@ YamiStatus VaapiEncoderVP9::start()
 void VaapiEncoderVP9::flush()
 {
     FUNC_ENTER();
+    flushPipeline();
     m_frameCount = 0;
     m_reference.clear();
     VaapiEncoderBase::flush();
@@ -129,6 +130,7 @@ YamiStatus VaapiEncoderVP9::setParameters(VideoParamConfigType type,
 {
     YamiStatus status = YAMI_INVALID_PARAM;
 
+    flushPipeline();
     if (!videoEncParams)
         return YAMI_INVALID_PARAM;
     switch (type) {
@@ -149,6 +151,7 @@ YamiStatus VaapiEncoderVP9::getParameters(VideoParamConfigType type,
 {
     YamiStatus status = YAMI_INVALID_PARAM;
 
+    flushPipeline();
     if (!videoEncParams)
         return status;
     switch (type) {
@@ -181,8 +184,7 @@ YamiStatus VaapiEncoderVP9::doEncode(const SurfacePtr& surface,
 
     m_frameCount++;
 
-    CodedBufferPtr codedBuffer
-        = VaapiCodedBuffer::create(m_context, m_maxCodedbufSize);
+    CodedBufferPtr codedBuffer = createCodedBuffer();
     if (!codedBuffer)
         return YAMI_OUT_MEMORY;
     picture->m_codedBuffer = codedBuffer;
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VIDEO_ASYNC_DECODER_INTERFACE_H_
+#define VIDEO_ASYNC_DECODER_INTERFACE_H_
+// config.h should NOT be included in header file, especially for the header file used by external
+
+#include <VideoDecoderDefs.h>
+
+namespace YamiMediaCodec {
+/**
+ * \class IAsyncVideoDecoderListener
+ * \brief receives events from #IAsyncVideoDecoder
+ *
+ * all functions are called on the decoder's worker thread, they should return quickly.
+ */
+class IAsyncVideoDecoderListener {
+public:
+    virtual ~IAsyncVideoDecoderListener() {}
+    /// a decoded frame, release it to give the surface back to decoder
+    virtual void onOutput(const SharedPtr<VideoFrame>& frame) = 0;
+    /** \brief stream format changed, @param[in] format is only valid in this call.
+    * client can reconfigure its allocator here, the decoder continues with the same input after return.
+    */
+    virtual void onFormatChange(const VideoFormatInfo* format) = 0;
+    /// decoding of the input with @param[in] timeStamp failed with @param[in] status, the input is dropped
+    virtual void onError(YamiStatus status, int64_t timeStamp) = 0;
+};
+
+/**
+ * \class IAsyncVideoDecoder
+ * \brief asynchronous video decoding interface of libyami
+ *
+ * #decode only queues a copy of input and returns, parsing and va submission run on a worker
+ * thread of the decoder. Decoded frames go to the listener if one is set, else they are queued
+ * for #getOutput, and the fd from #getEventFd becomes readable.
+ * when decoder runs out of surfaces, it waits until client releases a frame.
+ */
+class IAsyncVideoDecoder {
+public:
+    virtual ~IAsyncVideoDecoder() {}
+    /// start the worker thread and configure decoder, see IVideoDecoder::start
+    virtual YamiStatus start(VideoConfigBuffer* buffer) = 0;
+    /// discard pending input and stop the worker thread
+    virtual void stop(void) = 0;
+    /// discard pending input and queued frames, it returns after the worker is flushed
+    virtual void flush(void) = 0;
+    /// queue a copy of @param[in] buffer, send empty data (buffer.data=NULL, buffer.size=0) to indicate EOS
+    virtual YamiStatus decode(VideoDecodeBuffer* buffer) = 0;
+
+    /// get a queued frame, it never blocks. returns NULL when nothing is queued or a listener is set.
+    virtual SharedPtr<VideoFrame> getOutput() = 0;
+    /** \brief an eventfd signalled when frames are queued for #getOutput.
+    * client reads the fd to clear it, and then calls #getOutput until it returns NULL.
+    */
+    virtual int getEventFd() = 0;
+
+    /// latest stream information parsed by the worker, NULL before the format is known
+    virtual const VideoFormatInfo* getFormatInfo(void) = 0;
+
+    /// following functions need to be called before #start
+    virtual void setListener(IAsyncVideoDecoderListener* listener) = 0;
+    virtual void setNativeDisplay(NativeDisplay* display = NULL) = 0;
+    virtual void setAllocator(SurfaceAllocator* allocator) = 0;
+};
+}
+#endif /* VIDEO_ASYNC_DECODER_INTERFACE_H_ */
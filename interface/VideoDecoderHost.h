@@ -21,6 +21,7 @@
 #include <string>
 #include <vector>
 #include <VideoDecoderInterface.h>
+#include <VideoAsyncDecoderInterface.h>
 
 /** \file VideoDecoderHost.h
 */
@@ -31,11 +32,23 @@
 YamiMediaCodec::IVideoDecoder *createVideoDecoder(const char *mimeType);
 /// \brief destroy the decoder
 void releaseVideoDecoder(YamiMediaCodec::IVideoDecoder * p);
+/** \fn IAsyncVideoDecoder *createAsyncVideoDecoder(const char *mimeType)
+* \brief create a decoder basing on given mimetype, it decodes on its own thread
+*/
+YamiMediaCodec::IAsyncVideoDecoder *createAsyncVideoDecoder(const char *mimeType);
+/// \brief destroy the async decoder
+void releaseAsyncVideoDecoder(YamiMediaCodec::IAsyncVideoDecoder * p);
 /** \fn void getVideoDecoderMimeTypes()
  * \brief return the MimeTypes enabled in the current build
 */
 std::vector<std::string> getVideoDecoderMimeTypes();
 
+/** \fn void releaseVideoDecoderCache()
+ * \brief release the idle displays and decoding sessions kept by YAMI_CACHE_TTL,
+ * the cache has no timer, call this to free them, and before the application exits
+*/
+void releaseVideoDecoderCache();
+
 typedef YamiMediaCodec::IVideoDecoder *(*YamiCreateVideoDecoderFuncPtr) (const char *mimeType);
 typedef void (*YamiReleaseVideoDecoderFuncPtr)(YamiMediaCodec::IVideoDecoder * p);
 #endif                          /* VIDEO_DECODER_HOST_H_ */
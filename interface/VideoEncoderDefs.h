@@ -214,7 +214,9 @@ typedef enum {
     //format related
     VideoConfigTypeAVCStreamFormat,
 
-    VideoParamsConfigExtension
+    VideoParamsConfigExtension,
+
+    VideoParamsTypePipeline
 } VideoParamConfigType;
 
 typedef struct VideoParamConfigSet {
@@ -275,6 +277,22 @@ typedef struct VideoParamsQualityLevel {
     uint32_t level;
 } VideoParamsQualityLevel;
 
+/* encoder runs input upload, va submission and bitstream readout as
+ * three stages connected by queues, @depth is the maximum number of
+ * frames submitted but not synced yet. 0 disables the pipeline, encode()
+ * and getOutput() run on the caller thread.
+ * the latencies are average time(in microseconds) a frame spent in each stage,
+ * they are only returned by getParameters.
+ */
+typedef struct VideoParamsPipeline {
+    uint32_t size;
+    uint32_t depth;
+    uint32_t frames;
+    uint32_t uploadLatency;
+    uint32_t renderLatency;
+    uint32_t syncLatency;
+} VideoParamsPipeline;
+
 typedef struct VideoConfigFrameRate {
     uint32_t size;
     VideoFrameRate frameRate;
@@ -26,7 +26,6 @@
 #include <string.h>
 #include <unistd.h>
 #include <linux/videodev2.h>
-#include <sys/prctl.h>
 
 #include "v4l2_encode.h"
 #include "v4l2_decode.h"
@@ -75,6 +74,9 @@ V4l2CodecBase::V4l2CodecBase()
     , m_svct(false)
     , m_isThumbnailMode(false)
     , m_hasEvent(false)
+    , m_eosPending(false)
+    , m_eosPulseResult(false)
+    , m_eosPulseIndex(0)
     , m_inputThreadCond(m_frameLock[INPUT])
     , m_outputThreadCond(m_frameLock[OUTPUT])
     , m_eosState(EosStateNormal)
@@ -91,6 +93,8 @@ V4l2CodecBase::V4l2CodecBase()
     m_streamOn[OUTPUT] = false;
     m_threadOn[INPUT] = false;
     m_threadOn[OUTPUT] = false;
+    m_workScheduled[INPUT] = false;
+    m_workScheduled[OUTPUT] = false;
     m_threadCond[INPUT] = &m_inputThreadCond;
     m_threadCond[OUTPUT] = &m_outputThreadCond;
 
@@ -156,116 +160,122 @@ bool V4l2CodecBase::close()
     return true;
 }
 
-void V4l2CodecBase::workerThread()
+void V4l2CodecBase::schedule(int thread)
+{
+    AutoLock locker(m_workerLock);
+    if (!m_threadOn[thread] || m_workScheduled[thread])
+        return;
+    m_workScheduled[thread] = true;
+    m_worker[thread].post(std::bind(&V4l2CodecBase::workerJob, this, thread));
+}
+
+void V4l2CodecBase::workerJob(int thread)
 {
     bool ret = true;
-    int thread = -1;
+    bool eosDone = false;
     uint32_t index = 0xffffffff;
 
     {
-        AutoLock locker(m_codecLock);
-        if (m_streamOn[INPUT] && !m_threadOn[INPUT])
-            thread = INPUT;
-        else if (m_streamOn[OUTPUT] && !m_threadOn[OUTPUT])
-            thread = OUTPUT;
-        else {
-            ERROR("fail to create v4l2 work thread, unexpected status");
+        AutoLock locker(m_workerLock);
+        if (!m_threadOn[thread])
             return;
-        }
-        INFO("create work thread for %s", THREAD_NAME(thread));
-        prctl(PR_SET_NAME, THREAD_NAME(thread)) ;
-        m_threadOn[thread] = true;
+        m_workScheduled[thread] = false;
     }
 
-    while (m_streamOn[thread]) {
+    if (!m_streamOn[thread]) {
+        // VDA flush goes here, clear frames
         {
             AutoLock locker(m_frameLock[thread]);
+            m_framesTodo[thread].clear();
+            m_framesDone[thread].clear();
+            if (thread == INPUT) {
+                m_eosPending = false;
+                flush();
+            }
+            DEBUG("%s worker exit", THREAD_NAME(thread));
+        }
+        AutoLock locker(m_workerLock);
+        m_threadOn[thread] = false;
+        return;
+    }
+
+    {
+        AutoLock locker(m_frameLock[thread]);
+        if (thread == INPUT && m_eosPending) {
+            // wait until EOS is processed on OUTPUT port
+            if (m_eosState == EosStateInput)
+                return;
+            DEBUG("flush-debug flush done, INPUT thread continue");
+            setEosState(EosStateNormal);
+            m_eosPending = false;
+            eosDone = true;
+            ret = m_eosPulseResult;
+            index = m_eosPulseIndex;
+        } else {
             //ack i/o thread that it is safe to release the buffer queue
             if (m_reqBufState[thread] == RBS_Request) {
                 m_reqBufState[thread] = RBS_Acknowledge;
                 m_threadCond[thread]->signal();
             }
-            // wait until i/o thead has released the buffer queue
-            while (m_reqBufState[thread] == RBS_Acknowledge) {
-                m_threadCond[thread]->wait();
-            }
-        }
-        {
-            AutoLock locker(m_frameLock[thread]);
+            // i/o thread schedules us again after it has released the buffer queue
+            if (m_reqBufState[thread] == RBS_Acknowledge)
+                return;
             if (m_framesTodo[thread].empty()) {
                 DEBUG("%s thread wait because m_framesTodo is empty", THREAD_NAME(thread));
-                m_threadCond[thread]->wait(); // wait if no todo frame is available
-                continue;
+                return; // scheduled again when a todo frame is available
             }
             index = (uint32_t)(m_framesTodo[thread].front());
         }
+    }
 
-
-        // for decode, outputPulse may update index
+    // for decode, outputPulse may update index
+    if (!eosDone)
         ret = (thread == INPUT) ? inputPulse(index) : outputPulse(index);
 
-        {
-            AutoLock locker(m_frameLock[thread]);
-            // wait until EOS is processed on OUTPUT port
-            if (thread == INPUT && m_eosState == EosStateInput) {
-                m_threadCond[!thread]->signal();
-                while (m_eosState == EosStateInput) {
-                    m_threadCond[thread]->wait();
-                }
-                DEBUG("flush-debug flush done, INPUT thread continue");
-                setEosState(EosStateNormal);
-            }
-
-            if (ret) {
-                if (thread == OUTPUT) {
-                    // decoder output is in random order
-                    // encoder output is FIFO for now since we does additional copy in v4l2_encode; it can be random order if we use a pool for coded buffer.
-                    std::list<int>::iterator itList = std::find(m_framesTodo[OUTPUT].begin(), m_framesTodo[OUTPUT].end(), index);
-                    ASSERT(itList != m_framesTodo[OUTPUT].end());
-                    m_framesTodo[OUTPUT].erase(itList);
-                } else
-                    m_framesTodo[thread].pop_front();
-
-                m_framesDone[thread].push_back(index);
-                setDeviceEvent(0);
-                #ifdef __ENABLE_DEBUG__
-                m_frameCount[thread]++;
-                DEBUG("m_frameCount[%s]: %d", THREAD_NAME(thread), m_frameCount[thread]);
-                #endif
-                DEBUG("%s thread wake up %s thread after process one frame", THREAD_NAME(thread), THREAD_NAME(!thread));
-                m_threadCond[!thread]->signal(); // encode/getOutput one frame success, wakeup the other thread
-            } else {
-                if (thread == OUTPUT && m_eosState == EosStateOutput) {
-                    m_threadCond[!thread]->signal();
-                    DEBUG("flush-debug, wakeup INPUT thread out of EOS waiting");
-                }
-                DEBUG("%s thread wait because operation on yami fails", THREAD_NAME(thread));
-                m_threadCond[thread]->wait(); // wait if encode/getOutput fail (encode hw is busy or no available output)
-            }
-        }//protected by mLock
-        DEBUG("fd: %d", m_fd[0]);
-    }
-
-    // VDA flush goes here, clear frames
     {
         AutoLock locker(m_frameLock[thread]);
-        m_framesTodo[thread].clear();
-        m_framesDone[thread].clear();
-        if (thread == INPUT) {
-            flush();
+        if (thread == INPUT && m_eosState == EosStateInput) {
+            // continue in the job scheduled by OUTPUT port after EOS is processed
+            m_eosPending = true;
+            m_eosPulseResult = ret;
+            m_eosPulseIndex = index;
+            m_threadCond[!thread]->signal();
+            schedule(!thread);
+            return;
         }
-        DEBUG("%s worker thread exit", THREAD_NAME(thread));
-    }
-
-    m_threadOn[thread] = false;
-}
 
-static void* _workerThread(void *arg)
-{
-    V4l2CodecBase *v4l2Codec = static_cast<V4l2CodecBase*>(arg);
-    pthread_detach(pthread_self());
-    v4l2Codec->workerThread();
-    return NULL;
+        if (ret) {
+            if (thread == OUTPUT) {
+                // decoder output is in random order
+                // encoder output is FIFO for now since we does additional copy in v4l2_encode; it can be random order if we use a pool for coded buffer.
+                std::list<int>::iterator itList = std::find(m_framesTodo[OUTPUT].begin(), m_framesTodo[OUTPUT].end(), index);
+                ASSERT(itList != m_framesTodo[OUTPUT].end());
+                m_framesTodo[OUTPUT].erase(itList);
+            } else
+                m_framesTodo[thread].pop_front();
+
+            m_framesDone[thread].push_back(index);
+            setDeviceEvent(0);
+            #ifdef __ENABLE_DEBUG__
+            m_frameCount[thread]++;
+            DEBUG("m_frameCount[%s]: %d", THREAD_NAME(thread), m_frameCount[thread]);
+            #endif
+            DEBUG("%s thread wake up %s thread after process one frame", THREAD_NAME(thread), THREAD_NAME(!thread));
+            m_threadCond[!thread]->signal(); // encode/getOutput one frame success, wakeup the other thread
+            schedule(!thread);
+            // continue with next frame in a new job, so other streams get the worker in between
+            schedule(thread);
+        } else {
+            if (thread == OUTPUT && m_eosState == EosStateOutput) {
+                m_threadCond[!thread]->signal();
+                schedule(!thread);
+                DEBUG("flush-debug, wakeup INPUT thread out of EOS waiting");
+            }
+            // scheduled again when encode/getOutput may succeed (encode hw is busy or no available output)
+            DEBUG("%s thread wait because operation on yami fails", THREAD_NAME(thread));
+        }
+    }//protected by mLock
+    DEBUG("fd: %d", m_fd[0]);
 }
 
 #if defined(__ENABLE_DEBUG__)
@@ -334,10 +344,18 @@ int32_t V4l2CodecBase::ioctl(int command, void* arg)
             }
 
             m_streamOn[port] = true;
-            if (pthread_create(&m_worker[port], NULL, _workerThread, this) != 0) {
+            if (!m_worker[port].start()) {
                 ret = -1;
-                ERROR("fail to create input worker thread");
+                ERROR("fail to start %s worker", THREAD_NAME(port));
+                break;
+            }
+            INFO("start worker for %s", THREAD_NAME(port));
+            {
+                AutoLock locker(m_workerLock);
+                m_threadOn[port] = true;
             }
+            // frames queued before STREAMON
+            schedule(port);
         }
         break;
         case VIDIOC_STREAMOFF: {
@@ -356,8 +374,11 @@ int32_t V4l2CodecBase::ioctl(int command, void* arg)
                 }
                 DEBUG("%s port got STREAMOFF, wait until the worker thread exit/cleanup", THREAD_NAME(port));
                 m_threadCond[port]->broadcast();
+                schedule(port);
                 usleep(5000);
             }
+            // no job of this port is left after it
+            m_worker[port].stop();
         }
         break;
         case VIDIOC_REQBUFS: {
@@ -397,6 +418,7 @@ int32_t V4l2CodecBase::ioctl(int command, void* arg)
 
                 //try to wakeup workthread (workthread may not be active, after EOS for example)
                 m_threadCond[port]->signal();
+                schedule(port);
 
                 // wait until work thread doesn't work on current buffer queue
                 while (m_reqBufState[port] != RBS_Acknowledge) {
@@ -410,6 +432,7 @@ int32_t V4l2CodecBase::ioctl(int command, void* arg)
                 m_framesTodo[port].clear();
                 m_reqBufState[port] = (reqbufs->count > 0) ? RBS_FormatChanged : RBS_Released;
                 m_threadCond[port]->signal();
+                schedule(port);
             }
         }
         break;
@@ -437,6 +460,7 @@ int32_t V4l2CodecBase::ioctl(int command, void* arg)
                     m_reqBufState[port] == RBS_FormatChanged ){
                     m_framesTodo[port].push_back(qbuf->index);
                     m_threadCond[port]->signal();
+                    schedule(port);
                 } else {
                     ret = EAGAIN;
                 }
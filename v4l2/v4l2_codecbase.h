@@ -21,6 +21,7 @@
 #include <vector>
 #include <list>
 #include "common/condition.h"
+#include "common/ThreadPool.h"
 #include "VideoPostProcessHost.h"
 #include "VideoDecoderInterface.h"
 #if defined(__ENABLE_X11__)
@@ -100,7 +101,6 @@ class V4l2CodecBase {
 
     bool setDrmFd(int fd);
 
-    void workerThread();
     int32_t fd() { return m_fd[0];};
 
   protected:
@@ -145,7 +145,18 @@ class V4l2CodecBase {
   private:
     bool m_hasEvent;
 
-    pthread_t m_worker[2];
+    // process frames of one port, it runs on the shared thread pool and never blocks;
+    // it returns when it has to wait, and it is scheduled again when the waited condition is signaled
+    void workerJob(int port);
+    // post workerJob of port if it is not posted yet
+    void schedule(int port);
+    YamiMediaCodec::SerialQueue m_worker[2];
+    YamiMediaCodec::Lock m_workerLock; // lock for m_workScheduled and m_threadOn, always the last one we take
+    bool m_workScheduled[2];
+    // INPUT worker waits for EOS processing on OUTPUT port, with result of its last inputPulse
+    bool m_eosPending;
+    bool m_eosPulseResult;
+    uint32_t m_eosPulseIndex;
     // to be processed by codec.
     // encoder: (0:INPUT):filled with input frame data, input worker thread will send them to yami
     //          (1:OUTPUT): empty output buffer, output worker thread will fill it with coded data
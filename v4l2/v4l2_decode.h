@@ -20,7 +20,7 @@
 
 #include "v4l2_codecbase.h"
 #include "VideoDecoderInterface.h"
-#include "common/Thread.h"
+#include "common/ThreadPool.h"
 #include "common/Functional.h"
 #include <BufferPipe.h>
 
@@ -103,8 +103,8 @@ private:
     bool m_outputOn;
     v4l2_format m_outputFormat;
 
-    //decoder thread
-    Thread m_thread;
+    //decoder jobs, they run one by one on the shared thread pool
+    SerialQueue m_thread;
 
     enum State {
         kUnStarted, //decoder thread is not started.
@@ -34,6 +34,7 @@ v4l2_wrapper implements a wrapper library for yami encoder/decoder, it translate
 There are four threads in the wrapper library.
 Two threads for v4l2 interface: one for device pool (pool thread), one for device operation (device thread: deque, enque etc)
 Two threads are internal worker to drive data input (input thread) and output (output thread) respectively.
+   - They are not pthreads, but jobs posted to the shared ThreadPool (common/ThreadPool.h). A job returns instead of waiting, and is posted again when it is woken up.
    - Device thread owns yami encoder before input/output thread launch and after input/output thread exit . encoder->stop() defers to device _close() instead of STREAMOFF ioctl.
    - Dynamic encoder parameter change (bitrate/framerate etc) are accepted in device operation thread, and executed in input thread, with mutex lock
 Input thread keeps runing until: no input buffer available (from device enque buffer) or encode() fail (yami/dirver is busy).
@@ -5,6 +5,7 @@ include $(LOCAL_PATH)/../common.mk
 LOCAL_SRC_FILES := \
         vaapipicture.cpp \
         VaapiBuffer.cpp \
+        VaapiBufferPool.cpp \
         VaapiSurface.cpp\
         VaapiUtils.cpp \
         vaapidisplay.cpp \
@@ -20,9 +20,11 @@
 
 #include "VaapiBuffer.h"
 
+#include "VaapiBufferPool.h"
 #include "VaapiUtils.h"
 #include "vaapicontext.h"
 #include "vaapidisplay.h"
+#include <string.h>
 
 namespace YamiMediaCodec {
 
@@ -38,12 +40,21 @@ BufObjectPtr VaapiBuffer::create(const ContextPtr& context,
         return buf;
     }
     DisplayPtr display = context->getDisplay();
+    BufferPoolPtr pool = context->getBufferPool();
     VABufferID id;
-    VAStatus status = vaCreateBuffer(display->getID(), context->getID(),
-        type, size, 1, (void*)data, &id);
-    if (!checkVaapiStatus(status, "vaCreateBuffer"))
+    bool needFill;
+    if (!pool->acquire(type, size, data, id, needFill))
         return buf;
-    buf.reset(new VaapiBuffer(display, id, size));
+    buf.reset(new VaapiBuffer(display, pool, type, id, size));
+    if (needFill) {
+        void* dest = buf->map();
+        if (!dest) {
+            buf.reset();
+            return buf;
+        }
+        memcpy(dest, data, size);
+        buf->unmap();
+    }
     if (mapped) {
         *mapped = buf->map();
         if (!*mapped)
@@ -52,6 +63,36 @@ BufObjectPtr VaapiBuffer::create(const ContextPtr& context,
     return buf;
 }
 
+BufObjectPtr VaapiBuffer::createArray(const ContextPtr& context,
+    VABufferType type,
+    uint32_t elementSize,
+    uint32_t numElements,
+    const void* data)
+{
+    BufObjectPtr buf;
+    if (!elementSize || !numElements || !data || !context || !context->getDisplay()) {
+        ERROR("vaapibuffer: can't create buffer array");
+        return buf;
+    }
+    BufferPoolPtr pool = context->getBufferPool();
+    VABufferID id;
+    bool needFill;
+    if (!pool->acquire(type, elementSize, data, id, needFill, numElements))
+        return buf;
+    buf.reset(new VaapiBuffer(context->getDisplay(), pool, type, id, elementSize, numElements));
+    //a single element comes from the pool like any other buffer
+    if (needFill) {
+        void* dest = buf->map();
+        if (!dest) {
+            buf.reset();
+            return buf;
+        }
+        memcpy(dest, data, elementSize * numElements);
+        buf->unmap();
+    }
+    return buf;
+}
+
 void* VaapiBuffer::map()
 {
     if (!m_data) {
@@ -81,17 +122,21 @@ VABufferID VaapiBuffer::getID()
     return m_id;
 }
 
-VaapiBuffer::VaapiBuffer(const DisplayPtr& display, VABufferID id, uint32_t size)
+VaapiBuffer::VaapiBuffer(const DisplayPtr& display, const BufferPoolPtr& pool,
+    VABufferType type, VABufferID id, uint32_t size, uint32_t numElements)
     : m_display(display)
+    , m_pool(pool)
+    , m_type(type)
     , m_id(id)
     , m_data(NULL)
     , m_size(size)
+    , m_numElements(numElements)
 {
 }
 
 VaapiBuffer::~VaapiBuffer()
 {
     unmap();
-    checkVaapiStatus(vaDestroyBuffer(m_display->getID(), m_id), "vaDestroyBuffer");
+    m_pool->release(m_type, m_size, m_id, m_numElements);
 }
 }
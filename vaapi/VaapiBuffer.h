@@ -23,6 +23,13 @@
 #include <va/va.h>
 #include <stdint.h>
 
+//psb driver needs buffers to be rendered and destroyed one by one
+#if __PLATFORM_BYT__
+#define __PSB_RENDER_BUFFER_ONE_BY_ONE__ 1
+#else
+#define __PSB_RENDER_BUFFER_ONE_BY_ONE__ 0
+#endif
+
 namespace YamiMediaCodec {
 
 class VaapiBuffer {
@@ -37,6 +44,14 @@ public:
     static BufObjectPtr create(const ContextPtr&,
         VABufferType, T*& mapped);
 
+    /* one buffer holding numElements structures of elementSize bytes,
+     * like all slice parameters of a picture */
+    static BufObjectPtr createArray(const ContextPtr&,
+        VABufferType,
+        uint32_t elementSize,
+        uint32_t numElements,
+        const void* data);
+
     void* map();
     void unmap();
     uint32_t getSize();
@@ -44,11 +59,15 @@ public:
     ~VaapiBuffer();
 
 private:
-    VaapiBuffer(const DisplayPtr&, VABufferID id, uint32_t size);
+    VaapiBuffer(const DisplayPtr&, const BufferPoolPtr&,
+        VABufferType, VABufferID id, uint32_t size, uint32_t numElements = 1);
     DisplayPtr m_display;
+    BufferPoolPtr m_pool;
+    VABufferType m_type;
     VABufferID m_id;
     void* m_data;
     uint32_t m_size;
+    uint32_t m_numElements;
     DISALLOW_COPY_AND_ASSIGN(VaapiBuffer);
 };
 
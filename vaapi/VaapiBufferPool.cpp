@@ -0,0 +1,218 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "VaapiBufferPool.h"
+
+#include "VaapiBuffer.h"
+#include "VaapiUtils.h"
+#include "vaapidisplay.h"
+#include <string.h>
+
+namespace YamiMediaCodec {
+
+VaapiBufferPool::VaapiBufferPool(const DisplayPtr& display, VAContextID context)
+    : m_display(display)
+    , m_context(context)
+    , m_inPicture(false)
+    , m_closed(false)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+VaapiBufferPool::~VaapiBufferPool()
+{
+    close();
+}
+
+bool VaapiBufferPool::isPoolable(VABufferType type)
+{
+#if __PSB_RENDER_BUFFER_ONE_BY_ONE__
+    //psb driver destroys buffers in vaRenderPicture, nothing can be reused
+    return false;
+#else
+    //coded buffers are mapped by the client to read output
+    return type != VAEncCodedBufferType;
+#endif
+}
+
+//parameter buffers have fixed size, keep the exact size for them.
+//data buffers vary for every slice, round them to power of 2
+uint32_t VaapiBufferPool::getSizeClass(uint32_t size)
+{
+    const uint32_t EXACT_SIZE_LIMIT = 4096;
+    if (size <= EXACT_SIZE_LIMIT)
+        return size;
+    uint32_t sizeClass = EXACT_SIZE_LIMIT;
+    while (sizeClass < size && sizeClass < (1u << 31))
+        sizeClass <<= 1;
+    return sizeClass < size ? size : sizeClass;
+}
+
+bool VaapiBufferPool::acquire(VABufferType type, uint32_t size, const void* data,
+    VABufferID& id, bool& needFill, uint32_t numElements)
+{
+    AutoLock lock(m_lock);
+    needFill = false;
+    if (numElements != 1) {
+        VAStatus status = vaCreateBuffer(m_display->getID(), m_context,
+            type, size, numElements, (void*)data, &id);
+        if (!checkVaapiStatus(status, "vaCreateBuffer"))
+            return false;
+        m_stats.created++;
+        return true;
+    }
+    uint32_t allocSize = size;
+    if (isPoolable(type) && !m_closed) {
+        allocSize = getSizeClass(size);
+        Key key(type, allocSize);
+        FreeList::iterator it = m_free.find(key);
+        if ((it == m_free.end() || it->second.empty()) && !m_inFlight.empty()) {
+            reclaim();
+            it = m_free.find(key);
+        }
+        if (it != m_free.end() && !it->second.empty()) {
+            id = it->second.back();
+            it->second.pop_back();
+            m_stats.reused++;
+            needFill = data != NULL;
+            return true;
+        }
+    }
+    //the tail of a rounded buffer is left uninitialized, so only pass data for exact size
+    VAStatus status = vaCreateBuffer(m_display->getID(), m_context,
+        type, allocSize, 1, allocSize == size ? (void*)data : NULL, &id);
+    if (!checkVaapiStatus(status, "vaCreateBuffer"))
+        return false;
+    m_stats.created++;
+    needFill = (allocSize != size) && data;
+    return true;
+}
+
+void VaapiBufferPool::destroyBuffer(VABufferID id)
+{
+    checkVaapiStatus(vaDestroyBuffer(m_display->getID(), id), "vaDestroyBuffer");
+    m_stats.destroyed++;
+}
+
+void VaapiBufferPool::destroyBuffers(BufferList& buffers)
+{
+    for (size_t i = 0; i < buffers.size(); i++)
+        destroyBuffer(buffers[i].second);
+    buffers.clear();
+}
+
+void VaapiBufferPool::addToFreeList(const Key& key, VABufferID id)
+{
+    std::vector<VABufferID>& ids = m_free[key];
+    if (ids.size() < MAX_BUFFERS_PER_KEY)
+        ids.push_back(id);
+    else
+        destroyBuffer(id);
+}
+
+void VaapiBufferPool::release(VABufferType type, uint32_t size, VABufferID id, uint32_t numElements)
+{
+    AutoLock lock(m_lock);
+    if (!isPoolable(type) || m_closed || numElements != 1) {
+        destroyBuffer(id);
+        return;
+    }
+    Key key(type, getSizeClass(size));
+    //driver may still read this buffer in vaEndPicture
+    if (m_inPicture)
+        m_pending.push_back(std::make_pair(key, id));
+    //we do not know which picture used it, wait for the last one
+    else if (!m_inFlight.empty())
+        m_inFlight.back().buffers.push_back(std::make_pair(key, id));
+    else
+        addToFreeList(key, id);
+}
+
+//pictures of a context finish in order, so stop at the first busy one
+void VaapiBufferPool::reclaim()
+{
+    while (!m_inFlight.empty()) {
+        InFlight& picture = m_inFlight.front();
+        VASurfaceStatus status;
+        VAStatus vaStatus = vaQuerySurfaceStatus(m_display->getID(), picture.surface, &status);
+        if (vaStatus == VA_STATUS_SUCCESS) {
+            if (status & VASurfaceRendering)
+                break;
+            for (size_t i = 0; i < picture.buffers.size(); i++)
+                addToFreeList(picture.buffers[i].first, picture.buffers[i].second);
+        }
+        else {
+            //surface is gone, destroying is safe even if the gpu still reads
+            destroyBuffers(picture.buffers);
+        }
+        m_inFlight.pop_front();
+    }
+}
+
+void VaapiBufferPool::beginPicture()
+{
+    AutoLock lock(m_lock);
+    m_inPicture = true;
+}
+
+void VaapiBufferPool::endPicture(VASurfaceID surface)
+{
+    AutoLock lock(m_lock);
+    m_inPicture = false;
+    if (m_closed) {
+        destroyBuffers(m_pending);
+        return;
+    }
+    //even without buffers, it tells when buffers released later are unused
+    m_inFlight.push_back(InFlight());
+    m_inFlight.back().surface = surface;
+    m_inFlight.back().buffers.swap(m_pending);
+    //nobody waits for the oldest pictures, destroy their buffers like
+    //we did before pooling, the driver keeps them until it is done
+    while (m_inFlight.size() > MAX_PICTURES_IN_FLIGHT) {
+        destroyBuffers(m_inFlight.front().buffers);
+        m_inFlight.pop_front();
+    }
+}
+
+void VaapiBufferPool::close()
+{
+    AutoLock lock(m_lock);
+    m_closed = true;
+    FreeList::iterator it;
+    for (it = m_free.begin(); it != m_free.end(); ++it) {
+        for (size_t i = 0; i < it->second.size(); i++)
+            destroyBuffer(it->second[i]);
+    }
+    m_free.clear();
+    for (size_t i = 0; i < m_inFlight.size(); i++)
+        destroyBuffers(m_inFlight[i].buffers);
+    m_inFlight.clear();
+    if (!m_inPicture)
+        destroyBuffers(m_pending);
+}
+
+VaapiBufferPool::Stats VaapiBufferPool::getStats()
+{
+    AutoLock lock(m_lock);
+    return m_stats;
+}
+
+} //namespace YamiMediaCodec
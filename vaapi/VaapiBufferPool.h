@@ -0,0 +1,102 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VaapiBufferPool_h
+#define VaapiBufferPool_h
+
+#include "common/lock.h"
+#include "common/NonCopyable.h"
+#include "vaapiptrs.h"
+
+#include <va/va.h>
+#include <deque>
+#include <map>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+/* Recycles va buffers of a context, so we do not need
+ * vaCreateBuffer/vaDestroyBuffer for every slice of every picture.
+ * Buffers are keyed by type and size class.  The gpu may read a rendered
+ * buffer until its surface is ready, so buffers released while a picture is
+ * rendering (or while any picture is in flight) are only reused after
+ * vaQuerySurfaceStatus reports the surface ready. */
+class VaapiBufferPool {
+public:
+    struct Stats {
+        uint64_t created; /* vaCreateBuffer calls */
+        uint64_t destroyed; /* vaDestroyBuffer calls */
+        uint64_t reused; /* buffers served from the pool */
+    };
+
+    VaapiBufferPool(const DisplayPtr& display, VAContextID context);
+    ~VaapiBufferPool();
+
+    /* get a buffer of at least size bytes, needFill is true if data was not
+     * passed to the driver and caller must copy it into the buffer.
+     * Buffers of numElements > 1 have exact element size and count, they
+     * are created and destroyed directly */
+    bool acquire(VABufferType type, uint32_t size, const void* data, VABufferID& id, bool& needFill,
+        uint32_t numElements = 1);
+    void release(VABufferType type, uint32_t size, VABufferID id, uint32_t numElements = 1);
+
+    void beginPicture();
+    void endPicture(VASurfaceID surface);
+
+    /* destroy all cached buffers, later released buffers are destroyed directly */
+    void close();
+
+    Stats getStats();
+
+private:
+    typedef std::pair<VABufferType, uint32_t> Key;
+    typedef std::map<Key, std::vector<VABufferID> > FreeList;
+    typedef std::vector<std::pair<Key, VABufferID> > BufferList;
+
+    /* buffers of a picture the gpu may still be reading */
+    struct InFlight {
+        VASurfaceID surface;
+        BufferList buffers;
+    };
+
+    static bool isPoolable(VABufferType type);
+    static uint32_t getSizeClass(uint32_t size);
+    void destroyBuffer(VABufferID id);
+    void destroyBuffers(BufferList& buffers);
+    void addToFreeList(const Key& key, VABufferID id);
+    void reclaim();
+
+    static const uint32_t MAX_BUFFERS_PER_KEY = 64;
+    static const uint32_t MAX_PICTURES_IN_FLIGHT = 16;
+
+    Lock m_lock;
+    DisplayPtr m_display;
+    VAContextID m_context;
+    FreeList m_free;
+    BufferList m_pending;
+    std::deque<InFlight> m_inFlight;
+    bool m_inPicture;
+    bool m_closed;
+    Stats m_stats;
+
+    DISALLOW_COPY_AND_ASSIGN(VaapiBufferPool);
+};
+
+} //namespace YamiMediaCodec
+
+#endif //VaapiBufferPool_h
@@ -0,0 +1,288 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// The unittest header must be included before va_x11.h (which might be
+// included indirectly), see vaapidisplay_unittest.cpp for details.
+#include "vaapi/VaapiNullDisplayTest.h"
+
+// primary header
+#include "VaapiBufferPool.h"
+
+// library headers
+#include "common/common_def.h"
+#include "vaapi/VaapiBuffer.h"
+
+// system headers
+#include <string.h>
+#include <vector>
+
+namespace YamiMediaCodec {
+
+class VaapiBufferPoolTest : public NullDisplayTest {
+protected:
+    virtual void SetUp()
+    {
+        NullDisplayTest::SetUp();
+        m_context = createContext(VAProfileH264Main, VAEntrypointVLD, 1);
+        ASSERT_TRUE(bool(m_context));
+        m_surface = m_surfaces[0];
+    }
+
+    virtual void TearDown()
+    {
+        m_context.reset();
+        NullDisplayTest::TearDown();
+    }
+
+    //render buffer like VaapiPicture does, and release it before vaEndPicture
+    VABufferID renderPicture(BufObjectPtr& buffer)
+    {
+        VABufferID id = buffer->getID();
+        BufferPoolPtr pool = m_context->getBufferPool();
+        EXPECT_EQ(VA_STATUS_SUCCESS, vaBeginPicture(m_vaDisplay, m_context->getID(), m_surface));
+        pool->beginPicture();
+        EXPECT_EQ(VA_STATUS_SUCCESS, vaRenderPicture(m_vaDisplay, m_context->getID(), &id, 1));
+        buffer.reset();
+        EXPECT_EQ(VA_STATUS_SUCCESS, vaEndPicture(m_vaDisplay, m_context->getID()));
+        pool->endPicture(m_surface);
+        return id;
+    }
+
+    ContextPtr m_context;
+    VASurfaceID m_surface;
+};
+
+#define VAAPI_BUFFER_POOL_TEST(name) \
+    TEST_F(VaapiBufferPoolTest, name)
+
+#if __PSB_RENDER_BUFFER_ONE_BY_ONE__
+VAAPI_BUFFER_POOL_TEST(NotPooledOnPsb)
+{
+    const uint8_t data[] = { 0x00, 0x01, 0x02, 0x03 };
+    BufObjectPtr buf = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    ASSERT_TRUE(bool(buf));
+    buf.reset();
+    buf = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    VaapiBufferPool::Stats stats = m_context->getBufferPool()->getStats();
+    EXPECT_EQ(2u, stats.created);
+    EXPECT_EQ(1u, stats.destroyed);
+    EXPECT_EQ(0u, stats.reused);
+}
+#else
+VAAPI_BUFFER_POOL_TEST(Reuse)
+{
+    const uint32_t frames = 30;
+    const uint32_t slices = 8;
+    std::vector<uint8_t> data(100 * 1024);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = i & 0xff;
+
+    BufferPoolPtr pool = m_context->getBufferPool();
+    for (uint32_t f = 0; f < frames; f++) {
+        pool->beginPicture();
+        for (uint32_t s = 0; s < slices; s++) {
+            VASliceParameterBufferH264* param;
+            BufObjectPtr p = VaapiBuffer::create(m_context, VASliceParameterBufferType, param);
+            ASSERT_TRUE(bool(p));
+            //slice size changes for every slice, but stays in same size class
+            uint32_t size = data.size() - f * 16 - s;
+            BufObjectPtr d = VaapiBuffer::create(m_context, VASliceDataBufferType, size, &data[0]);
+            ASSERT_TRUE(bool(d));
+            ASSERT_EQ(0, memcmp(d->map(), &data[0], size));
+        }
+        pool->endPicture(m_surface);
+    }
+
+    //only the first picture creates buffers, later pictures reuse them
+    VaapiBufferPool::Stats stats = pool->getStats();
+    EXPECT_EQ(slices * 2, stats.created);
+    EXPECT_EQ(0u, stats.destroyed);
+    EXPECT_EQ((frames - 1) * slices * 2, stats.reused);
+    EXPECT_EQ(slices * 2, getStats().count[NullDriverStats::CreateBuffer]);
+    EXPECT_EQ(slices * 2, getStats().liveBuffers);
+
+    m_context.reset();
+    EXPECT_EQ(0u, getStats().liveBuffers);
+}
+
+VAAPI_BUFFER_POOL_TEST(ClearRecycled)
+{
+    VAPictureParameterBufferH264* param;
+    BufObjectPtr p = VaapiBuffer::create(m_context, VAPictureParameterBufferType, param);
+    ASSERT_TRUE(bool(p));
+    memset(param, 0xff, sizeof(*param));
+    p.reset();
+
+    p = VaapiBuffer::create(m_context, VAPictureParameterBufferType, param);
+    ASSERT_TRUE(bool(p));
+    EXPECT_EQ(1u, m_context->getBufferPool()->getStats().reused);
+    EXPECT_EQ(0u, param->num_ref_frames);
+}
+
+VAAPI_BUFFER_POOL_TEST(PendingUntilEndPicture)
+{
+    const uint8_t data[] = { 0x00, 0x01, 0x02, 0x03 };
+    BufferPoolPtr pool = m_context->getBufferPool();
+
+    pool->beginPicture();
+    BufObjectPtr first = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    VABufferID id = first->getID();
+    first.reset();
+    //driver may still use the released buffer before vaEndPicture
+    BufObjectPtr second = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    EXPECT_NE(id, second->getID());
+    second.reset();
+    pool->endPicture(m_surface);
+
+    BufObjectPtr third = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    EXPECT_EQ(2u, pool->getStats().created);
+    EXPECT_EQ(1u, pool->getStats().reused);
+}
+
+VAAPI_BUFFER_POOL_TEST(WaitForSurface)
+{
+    const uint8_t data[] = { 0x00, 0x01, 0x02, 0x03 };
+    BufferPoolPtr pool = m_context->getBufferPool();
+
+    BufObjectPtr buf = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    ASSERT_TRUE(bool(buf));
+    VABufferID id = renderPicture(buf);
+
+    //the surface is still rendering, the gpu may read the buffer
+    buf = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    ASSERT_TRUE(bool(buf));
+    EXPECT_NE(id, buf->getID());
+    EXPECT_EQ(0u, pool->getStats().reused);
+    buf.reset();
+
+    ASSERT_EQ(VA_STATUS_SUCCESS, vaSyncSurface(m_vaDisplay, m_surface));
+    buf = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    ASSERT_TRUE(bool(buf));
+    EXPECT_EQ(1u, pool->getStats().reused);
+    EXPECT_EQ(2u, pool->getStats().created);
+}
+
+VAAPI_BUFFER_POOL_TEST(ReleasedOutsidePictureWaits)
+{
+    const uint8_t data[] = { 0x00, 0x01, 0x02, 0x03 };
+    BufferPoolPtr pool = m_context->getBufferPool();
+
+    //like a vpp filter, referenced by a picture but released later
+    BufObjectPtr filter = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    BufObjectPtr buf = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    ASSERT_TRUE(filter && buf);
+    VABufferID id = filter->getID();
+    renderPicture(buf);
+    filter.reset();
+
+    buf = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    ASSERT_TRUE(bool(buf));
+    EXPECT_NE(id, buf->getID());
+    EXPECT_EQ(0u, pool->getStats().reused);
+    buf.reset();
+
+    ASSERT_EQ(VA_STATUS_SUCCESS, vaSyncSurface(m_vaDisplay, m_surface));
+    buf = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    EXPECT_EQ(1u, pool->getStats().reused);
+}
+
+#endif
+
+VAAPI_BUFFER_POOL_TEST(DestroyUnsyncedPictures)
+{
+    const uint8_t data[] = { 0x00, 0x01, 0x02, 0x03 };
+    const uint32_t pictures = 40;
+    for (uint32_t i = 0; i < pictures; i++) {
+        BufObjectPtr buf = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+        ASSERT_TRUE(bool(buf));
+        renderPicture(buf);
+    }
+    //nobody syncs, buffers of old pictures are destroyed instead of piling up
+    VaapiBufferPool::Stats stats = m_context->getBufferPool()->getStats();
+    EXPECT_EQ(pictures, stats.created);
+    EXPECT_EQ(0u, stats.reused);
+    EXPECT_GT(stats.destroyed, 0u);
+    EXPECT_EQ(stats.created - stats.destroyed, getStats().liveBuffers);
+    EXPECT_GT(pictures, getStats().liveBuffers);
+}
+
+VAAPI_BUFFER_POOL_TEST(CodedBufferNotPooled)
+{
+    BufObjectPtr coded = VaapiBuffer::create(m_context, VAEncCodedBufferType, 1024);
+    ASSERT_TRUE(bool(coded));
+    coded.reset();
+    EXPECT_EQ(1u, m_context->getBufferPool()->getStats().destroyed);
+    EXPECT_EQ(0u, getStats().liveBuffers);
+}
+
+VAAPI_BUFFER_POOL_TEST(ArrayNotPooled)
+{
+    VASliceParameterBufferH264 params[3];
+    memset(params, 0, sizeof(params));
+    for (int i = 0; i < 3; i++)
+        params[i].slice_data_offset = i * 100;
+
+    BufObjectPtr array = VaapiBuffer::createArray(m_context, VASliceParameterBufferType,
+        sizeof(params[0]), 3, params);
+    ASSERT_TRUE(bool(array));
+    EXPECT_EQ(0, memcmp(array->map(), params, sizeof(params)));
+    array.reset();
+
+    //a single element buffer must never get the array
+    VASliceParameterBufferH264* param;
+    BufObjectPtr single = VaapiBuffer::create(m_context, VASliceParameterBufferType, param);
+    ASSERT_TRUE(bool(single));
+    VaapiBufferPool::Stats stats = m_context->getBufferPool()->getStats();
+    EXPECT_EQ(2u, stats.created);
+    EXPECT_EQ(1u, stats.destroyed);
+    EXPECT_EQ(0u, stats.reused);
+}
+
+VAAPI_BUFFER_POOL_TEST(SingleElementArray)
+{
+    //reused and rounded up buffers are not filled by vaCreateBuffer
+    const uint32_t sizes[] = { sizeof(VASliceParameterBufferH264), 5000 };
+    for (size_t i = 0; i < N_ELEMENTS(sizes); i++) {
+        std::vector<uint8_t> data(sizes[i]);
+        for (int round = 0; round < 2; round++) {
+            for (size_t j = 0; j < data.size(); j++)
+                data[j] = j + round;
+            BufObjectPtr array = VaapiBuffer::createArray(m_context, VASliceParameterBufferType,
+                data.size(), 1, &data[0]);
+            ASSERT_TRUE(bool(array));
+            EXPECT_EQ(0, memcmp(array->map(), &data[0], data.size()));
+        }
+    }
+#if !__PSB_RENDER_BUFFER_ONE_BY_ONE__
+    EXPECT_EQ(2u, m_context->getBufferPool()->getStats().reused);
+#endif
+}
+
+VAAPI_BUFFER_POOL_TEST(OutliveContext)
+{
+    const uint8_t data[] = { 0x00, 0x01, 0x02, 0x03 };
+    BufObjectPtr buf = VaapiBuffer::create(m_context, VASliceDataBufferType, sizeof(data), data);
+    ASSERT_TRUE(bool(buf));
+    m_context.reset();
+    buf.reset();
+    EXPECT_EQ(0u, getStats().liveBuffers);
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VaapiNullDisplayTest_h
+#define VaapiNullDisplayTest_h
+
+#include "common/unittest.h"
+
+#include "vaapi/VaapiNullDriver.h"
+#include "vaapi/vaapicontext.h"
+#include "vaapi/vaapidisplay.h"
+
+#include <vector>
+
+namespace YamiMediaCodec {
+
+/* fixture for tests running on a null display, see VaapiNullDriver.h */
+class NullDisplayTest : public ::testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        m_vaDisplay = createNullDisplay();
+        ASSERT_TRUE(m_vaDisplay);
+        NativeDisplay native = { (intptr_t)m_vaDisplay, NATIVE_DISPLAY_VA };
+        m_display = VaapiDisplay::create(native);
+        ASSERT_TRUE(bool(m_display));
+    }
+
+    //derived fixtures must drop their contexts and buffers before this
+    virtual void TearDown()
+    {
+        if (!m_surfaces.empty())
+            vaDestroySurfaces(m_vaDisplay, &m_surfaces[0], m_surfaces.size());
+        m_surfaces.clear();
+        m_display.reset();
+        destroyNullDisplay(m_vaDisplay);
+    }
+
+    NullDriverStats getStats()
+    {
+        NullDriverStats stats;
+        EXPECT_TRUE(getNullDriverStats(m_vaDisplay, stats));
+        return stats;
+    }
+
+    //320x240 context with new render targets, they are kept in m_surfaces
+    ContextPtr createContext(VAProfile profile, VAEntrypoint entrypoint, uint32_t surfaces = 0)
+    {
+        ContextPtr context;
+        ConfigPtr config;
+        if (VaapiConfig::create(m_display, profile, entrypoint, NULL, 0, config) != YAMI_SUCCESS)
+            return context;
+        size_t first = m_surfaces.size();
+        if (surfaces) {
+            m_surfaces.resize(first + surfaces);
+            if (vaCreateSurfaces(m_vaDisplay, VA_RT_FORMAT_YUV420, 320, 240,
+                    &m_surfaces[first], surfaces, NULL, 0) != VA_STATUS_SUCCESS) {
+                m_surfaces.resize(first);
+                return context;
+            }
+        }
+        context = VaapiContext::create(config, 320, 240, VA_PROGRESSIVE,
+            surfaces ? &m_surfaces[first] : NULL, surfaces);
+        return context;
+    }
+
+    VADisplay m_vaDisplay;
+    DisplayPtr m_display;
+    std::vector<VASurfaceID> m_surfaces;
+};
+
+} //namespace YamiMediaCodec
+
+#endif //VaapiNullDisplayTest_h
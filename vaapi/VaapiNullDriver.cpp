@@ -0,0 +1,787 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "vaapi/VaapiNullDriver.h"
+
+#include "common/common_def.h"
+#include "common/lock.h"
+#include "common/log.h"
+#include "interface/VideoCommonDefs.h"
+#include <va/va_backend.h>
+#include <map>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#ifndef VA_DISPLAY_MAGIC
+#define VA_DISPLAY_MAGIC 0x56414430 /* VA@0 */
+#endif
+
+namespace YamiMediaCodec {
+
+struct NullSurface {
+    uint32_t fourcc;
+    VAImage layout;
+    std::vector<uint8_t> data;
+    /* rendered but not synced, work of the null driver only finishes when
+     * someone waits for it, so resources reused too early show up in tests */
+    bool rendering;
+};
+
+struct NullBuffer {
+    VABufferType type;
+    uint32_t size;
+    uint32_t numElements;
+    std::vector<uint8_t> data;
+    /* derived image buffer points to surface memory */
+    uint8_t* external;
+};
+
+struct NullConfig {
+    VAProfile profile;
+    VAEntrypoint entrypoint;
+};
+
+struct NullContext {
+    VAConfigID config;
+    VASurfaceID target;
+};
+
+struct NullDriver {
+    NullDriver()
+        : nextId(1)
+    {
+        memset(&stats, 0, sizeof(stats));
+    }
+    Lock lock;
+    uint32_t nextId;
+    std::map<VAConfigID, NullConfig> configs;
+    std::map<VAContextID, NullContext> contexts;
+    std::map<VASurfaceID, NullSurface*> surfaces;
+    std::map<VABufferID, NullBuffer*> buffers;
+    std::map<VAImageID, VAImage> images;
+    NullDriverStats stats;
+};
+
+static const VAProfile s_profiles[] = {
+    VAProfileMPEG2Simple,
+    VAProfileMPEG2Main,
+    VAProfileH264ConstrainedBaseline,
+    VAProfileH264Main,
+    VAProfileH264High,
+    VAProfileVC1Simple,
+    VAProfileVC1Main,
+    VAProfileVC1Advanced,
+    VAProfileJPEGBaseline,
+    VAProfileVP8Version0_3,
+#if VA_CHECK_VERSION(0, 37, 0)
+    VAProfileHEVCMain,
+    VAProfileHEVCMain10,
+    VAProfileVP9Profile0,
+#endif
+    VAProfileNone
+};
+
+static const VAEntrypoint s_entrypoints[] = {
+    VAEntrypointVLD,
+    VAEntrypointEncSlice,
+    VAEntrypointEncPicture,
+    VAEntrypointVideoProc
+};
+
+static const uint32_t s_fourccs[] = {
+    YAMI_FOURCC_NV12,
+    YAMI_FOURCC_I420,
+    YAMI_FOURCC_YV12,
+    YAMI_FOURCC_YUY2,
+    YAMI_FOURCC_422H,
+    YAMI_FOURCC_444P,
+    YAMI_FOURCC_Y800,
+    YAMI_FOURCC_P010,
+    YAMI_FOURCC_BGRA,
+    YAMI_FOURCC_BGRX,
+    YAMI_FOURCC_RGBA,
+    YAMI_FOURCC_RGBX
+};
+
+static uint64_t getNanoseconds()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+class ScopedCall {
+public:
+    ScopedCall(NullDriverStats& stats, NullDriverStats::Call call)
+        : m_stats(stats)
+        , m_call(call)
+        , m_start(getNanoseconds())
+    {
+    }
+    ~ScopedCall()
+    {
+        m_stats.count[m_call]++;
+        m_stats.nanoseconds[m_call] += getNanoseconds() - m_start;
+    }
+
+private:
+    NullDriverStats& m_stats;
+    NullDriverStats::Call m_call;
+    uint64_t m_start;
+    DISALLOW_COPY_AND_ASSIGN(ScopedCall);
+};
+
+#define NULL_DRIVER_LOCK()                                    \
+    NullDriver* drv = (NullDriver*)ctx->pDriverData; \
+    AutoLock locker(drv->lock)
+
+#define NULL_DRIVER_CALL(call) \
+    NULL_DRIVER_LOCK();        \
+    ScopedCall scopedCall(drv->stats, NullDriverStats::call)
+
+template <class Map>
+static typename Map::mapped_type* lookup(Map& m, typename Map::key_type id)
+{
+    typename Map::iterator it = m.find(id);
+    if (it == m.end())
+        return NULL;
+    return &it->second;
+}
+
+static uint32_t getFourccFromRtFormat(uint32_t rtFormat)
+{
+    switch (rtFormat) {
+    case VA_RT_FORMAT_YUV400:
+        return YAMI_FOURCC_Y800;
+    case VA_RT_FORMAT_YUV422:
+        return YAMI_FOURCC_422H;
+    case VA_RT_FORMAT_YUV444:
+        return YAMI_FOURCC_444P;
+#ifdef VA_RT_FORMAT_YUV420_10BPP
+    case VA_RT_FORMAT_YUV420_10BPP:
+        return YAMI_FOURCC_P010;
+#endif
+    case VA_RT_FORMAT_RGB32:
+        return YAMI_FOURCC_BGRA;
+    }
+    return YAMI_FOURCC_NV12;
+}
+
+/* fill format, pitches, offsets and data size for a fourcc */
+static bool getImageLayout(uint32_t fourcc, uint32_t width, uint32_t height, VAImage& image)
+{
+    uint32_t w = ALIGN16(width);
+    uint32_t h = ALIGN16(height);
+    uint32_t bitsPerPixel;
+
+    memset(&image, 0, sizeof(image));
+    switch (fourcc) {
+    case YAMI_FOURCC_NV12:
+    case YAMI_FOURCC_P010: {
+        uint32_t pitch = (fourcc == YAMI_FOURCC_NV12) ? w : w * 2;
+        image.num_planes = 2;
+        image.pitches[0] = image.pitches[1] = pitch;
+        image.offsets[1] = pitch * h;
+        image.data_size = pitch * h * 3 / 2;
+        bitsPerPixel = (fourcc == YAMI_FOURCC_NV12) ? 12 : 24;
+        break;
+    }
+    case YAMI_FOURCC_I420:
+    case YAMI_FOURCC_YV12:
+    case YAMI_FOURCC_422H:
+    case YAMI_FOURCC_444P: {
+        uint32_t chromaWidth = (fourcc == YAMI_FOURCC_444P) ? w : w / 2;
+        uint32_t chromaHeight = (fourcc == YAMI_FOURCC_I420 || fourcc == YAMI_FOURCC_YV12) ? h / 2 : h;
+        image.num_planes = 3;
+        image.pitches[0] = w;
+        image.pitches[1] = image.pitches[2] = chromaWidth;
+        image.offsets[1] = w * h;
+        image.offsets[2] = image.offsets[1] + chromaWidth * chromaHeight;
+        image.data_size = image.offsets[2] + chromaWidth * chromaHeight;
+        bitsPerPixel = image.data_size * 8 / (w * h);
+        break;
+    }
+    case YAMI_FOURCC_Y800:
+        image.num_planes = 1;
+        image.pitches[0] = w;
+        image.data_size = w * h;
+        bitsPerPixel = 8;
+        break;
+    case YAMI_FOURCC_YUY2:
+        image.num_planes = 1;
+        image.pitches[0] = w * 2;
+        image.data_size = w * 2 * h;
+        bitsPerPixel = 16;
+        break;
+    case YAMI_FOURCC_BGRA:
+    case YAMI_FOURCC_BGRX:
+    case YAMI_FOURCC_RGBA:
+    case YAMI_FOURCC_RGBX:
+        image.num_planes = 1;
+        image.pitches[0] = w * 4;
+        image.data_size = w * 4 * h;
+        bitsPerPixel = 32;
+        break;
+    default:
+        return false;
+    }
+    image.format.fourcc = fourcc;
+    image.format.byte_order = VA_LSB_FIRST;
+    image.format.bits_per_pixel = bitsPerPixel;
+    image.width = width;
+    image.height = height;
+    image.image_id = VA_INVALID_ID;
+    image.buf = VA_INVALID_ID;
+    return true;
+}
+
+static VABufferID newBuffer(NullDriver* drv, VABufferType type,
+    uint32_t size, uint32_t numElements, uint8_t* external)
+{
+    NullBuffer* buf = new NullBuffer;
+    buf->type = type;
+    buf->size = size;
+    buf->numElements = numElements;
+    buf->external = external;
+    if (!external) {
+        uint32_t total = size * numElements;
+        if (type == VAEncCodedBufferType)
+            total += sizeof(VACodedBufferSegment);
+        buf->data.resize(total ? total : 1);
+    }
+    VABufferID id = drv->nextId++;
+    drv->buffers[id] = buf;
+    drv->stats.liveBuffers++;
+    return id;
+}
+
+static void deleteBuffer(NullDriver* drv, std::map<VABufferID, NullBuffer*>::iterator it)
+{
+    delete it->second;
+    drv->buffers.erase(it);
+    drv->stats.liveBuffers--;
+}
+
+static VAStatus nullTerminate(VADriverContextP ctx)
+{
+    NULL_DRIVER_LOCK();
+    std::map<VASurfaceID, NullSurface*>::iterator s;
+    for (s = drv->surfaces.begin(); s != drv->surfaces.end(); ++s)
+        delete s->second;
+    drv->surfaces.clear();
+    while (!drv->buffers.empty())
+        deleteBuffer(drv, drv->buffers.begin());
+    drv->images.clear();
+    drv->contexts.clear();
+    drv->configs.clear();
+    drv->stats.liveSurfaces = 0;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullQueryConfigProfiles(VADriverContextP ctx,
+    VAProfile* profileList, int* numProfiles)
+{
+    for (size_t i = 0; i < N_ELEMENTS(s_profiles); i++)
+        profileList[i] = s_profiles[i];
+    *numProfiles = N_ELEMENTS(s_profiles);
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullQueryConfigEntrypoints(VADriverContextP ctx,
+    VAProfile profile, VAEntrypoint* entrypointList, int* numEntrypoints)
+{
+    for (size_t i = 0; i < N_ELEMENTS(s_entrypoints); i++)
+        entrypointList[i] = s_entrypoints[i];
+    *numEntrypoints = N_ELEMENTS(s_entrypoints);
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullGetConfigAttributes(VADriverContextP ctx,
+    VAProfile profile, VAEntrypoint entrypoint,
+    VAConfigAttrib* attribList, int numAttribs)
+{
+    for (int i = 0; i < numAttribs; i++) {
+        uint32_t& value = attribList[i].value;
+        switch (attribList[i].type) {
+        case VAConfigAttribRTFormat:
+            value = VA_RT_FORMAT_YUV420 | VA_RT_FORMAT_YUV422
+                | VA_RT_FORMAT_YUV444 | VA_RT_FORMAT_YUV400
+                | VA_RT_FORMAT_RGB32;
+#ifdef VA_RT_FORMAT_YUV420_10BPP
+            value |= VA_RT_FORMAT_YUV420_10BPP;
+#endif
+            break;
+        case VAConfigAttribRateControl:
+            value = VA_RC_CQP | VA_RC_CBR | VA_RC_VBR;
+            break;
+        case VAConfigAttribEncPackedHeaders:
+            value = VA_ENC_PACKED_HEADER_SEQUENCE | VA_ENC_PACKED_HEADER_PICTURE
+                | VA_ENC_PACKED_HEADER_SLICE | VA_ENC_PACKED_HEADER_MISC;
+            break;
+        case VAConfigAttribEncMaxRefFrames:
+            value = 1 | (1 << 16);
+            break;
+        case VAConfigAttribEncQualityRange:
+            value = 7;
+            break;
+        default:
+            value = VA_ATTRIB_NOT_SUPPORTED;
+            break;
+        }
+    }
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullCreateConfig(VADriverContextP ctx,
+    VAProfile profile, VAEntrypoint entrypoint,
+    VAConfigAttrib* attribList, int numAttribs, VAConfigID* configId)
+{
+    NULL_DRIVER_CALL(CreateConfig);
+    NullConfig config;
+    config.profile = profile;
+    config.entrypoint = entrypoint;
+    *configId = drv->nextId++;
+    drv->configs[*configId] = config;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullDestroyConfig(VADriverContextP ctx, VAConfigID configId)
+{
+    NULL_DRIVER_LOCK();
+    if (!drv->configs.erase(configId))
+        return VA_STATUS_ERROR_INVALID_CONFIG;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullQueryConfigAttributes(VADriverContextP ctx,
+    VAConfigID configId, VAProfile* profile, VAEntrypoint* entrypoint,
+    VAConfigAttrib* attribList, int* numAttribs)
+{
+    NULL_DRIVER_LOCK();
+    NullConfig* config = lookup(drv->configs, configId);
+    if (!config)
+        return VA_STATUS_ERROR_INVALID_CONFIG;
+    *profile = config->profile;
+    *entrypoint = config->entrypoint;
+    *numAttribs = 0;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullCreateSurfaces2(VADriverContextP ctx,
+    unsigned int format, unsigned int width, unsigned int height,
+    VASurfaceID* surfaces, unsigned int numSurfaces,
+    VASurfaceAttrib* attribList, unsigned int numAttribs)
+{
+    NULL_DRIVER_CALL(CreateSurfaces);
+    uint32_t fourcc = getFourccFromRtFormat(format);
+    for (unsigned int i = 0; i < numAttribs; i++) {
+        if (attribList[i].type == VASurfaceAttribPixelFormat
+            && (attribList[i].flags & VA_SURFACE_ATTRIB_SETTABLE))
+            fourcc = attribList[i].value.value.i;
+    }
+
+    VAImage layout;
+    if (!width || !height || !getImageLayout(fourcc, width, height, layout))
+        return VA_STATUS_ERROR_UNSUPPORTED_RT_FORMAT;
+    for (unsigned int i = 0; i < numSurfaces; i++) {
+        NullSurface* surface = new NullSurface;
+        surface->fourcc = fourcc;
+        surface->layout = layout;
+        surface->data.resize(layout.data_size);
+        surface->rendering = false;
+        surfaces[i] = drv->nextId++;
+        drv->surfaces[surfaces[i]] = surface;
+        drv->stats.liveSurfaces++;
+    }
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullCreateSurfaces(VADriverContextP ctx,
+    int width, int height, int format, int numSurfaces, VASurfaceID* surfaces)
+{
+    return nullCreateSurfaces2(ctx, format, width, height, surfaces, numSurfaces, NULL, 0);
+}
+
+static VAStatus nullDestroySurfaces(VADriverContextP ctx,
+    VASurfaceID* surfaceList, int numSurfaces)
+{
+    NULL_DRIVER_CALL(DestroySurfaces);
+    for (int i = 0; i < numSurfaces; i++) {
+        std::map<VASurfaceID, NullSurface*>::iterator it = drv->surfaces.find(surfaceList[i]);
+        if (it == drv->surfaces.end())
+            return VA_STATUS_ERROR_INVALID_SURFACE;
+        delete it->second;
+        drv->surfaces.erase(it);
+        drv->stats.liveSurfaces--;
+    }
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullCreateContext(VADriverContextP ctx,
+    VAConfigID configId, int pictureWidth, int pictureHeight, int flag,
+    VASurfaceID* renderTargets, int numRenderTargets, VAContextID* contextId)
+{
+    NULL_DRIVER_CALL(CreateContext);
+    if (!lookup(drv->configs, configId))
+        return VA_STATUS_ERROR_INVALID_CONFIG;
+    NullContext context;
+    context.config = configId;
+    context.target = VA_INVALID_SURFACE;
+    *contextId = drv->nextId++;
+    drv->contexts[*contextId] = context;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullDestroyContext(VADriverContextP ctx, VAContextID contextId)
+{
+    NULL_DRIVER_LOCK();
+    if (!drv->contexts.erase(contextId))
+        return VA_STATUS_ERROR_INVALID_CONTEXT;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullCreateBuffer(VADriverContextP ctx,
+    VAContextID context, VABufferType type, unsigned int size,
+    unsigned int numElements, void* data, VABufferID* bufId)
+{
+    NULL_DRIVER_CALL(CreateBuffer);
+    *bufId = newBuffer(drv, type, size, numElements, NULL);
+    if (data)
+        memcpy(&drv->buffers[*bufId]->data[0], data, size * numElements);
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullBufferSetNumElements(VADriverContextP ctx,
+    VABufferID bufId, unsigned int numElements)
+{
+    NULL_DRIVER_LOCK();
+    NullBuffer** buf = lookup(drv->buffers, bufId);
+    if (!buf)
+        return VA_STATUS_ERROR_INVALID_BUFFER;
+    if ((*buf)->external || numElements > (*buf)->numElements)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+    (*buf)->numElements = numElements;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullMapBuffer(VADriverContextP ctx, VABufferID bufId, void** pbuf)
+{
+    NULL_DRIVER_CALL(MapBuffer);
+    NullBuffer** buf = lookup(drv->buffers, bufId);
+    if (!buf)
+        return VA_STATUS_ERROR_INVALID_BUFFER;
+    NullBuffer* b = *buf;
+    if (b->external) {
+        *pbuf = b->external;
+        return VA_STATUS_SUCCESS;
+    }
+    if (b->type == VAEncCodedBufferType) {
+        /* nothing is encoded, return an empty segment */
+        VACodedBufferSegment* segment = (VACodedBufferSegment*)&b->data[0];
+        memset(segment, 0, sizeof(*segment));
+        segment->buf = &b->data[0] + sizeof(*segment);
+    }
+    *pbuf = &b->data[0];
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullUnmapBuffer(VADriverContextP ctx, VABufferID bufId)
+{
+    NULL_DRIVER_CALL(UnmapBuffer);
+    if (!lookup(drv->buffers, bufId))
+        return VA_STATUS_ERROR_INVALID_BUFFER;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullDestroyBuffer(VADriverContextP ctx, VABufferID bufId)
+{
+    NULL_DRIVER_CALL(DestroyBuffer);
+    std::map<VABufferID, NullBuffer*>::iterator it = drv->buffers.find(bufId);
+    if (it == drv->buffers.end())
+        return VA_STATUS_ERROR_INVALID_BUFFER;
+    deleteBuffer(drv, it);
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullBeginPicture(VADriverContextP ctx,
+    VAContextID contextId, VASurfaceID renderTarget)
+{
+    NULL_DRIVER_CALL(BeginPicture);
+    NullContext* context = lookup(drv->contexts, contextId);
+    if (!context)
+        return VA_STATUS_ERROR_INVALID_CONTEXT;
+    if (!lookup(drv->surfaces, renderTarget))
+        return VA_STATUS_ERROR_INVALID_SURFACE;
+    context->target = renderTarget;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullRenderPicture(VADriverContextP ctx,
+    VAContextID contextId, VABufferID* buffers, int numBuffers)
+{
+    NULL_DRIVER_CALL(RenderPicture);
+    NullContext* context = lookup(drv->contexts, contextId);
+    if (!context)
+        return VA_STATUS_ERROR_INVALID_CONTEXT;
+    if (context->target == VA_INVALID_SURFACE)
+        return VA_STATUS_ERROR_OPERATION_FAILED;
+    for (int i = 0; i < numBuffers; i++) {
+        if (!lookup(drv->buffers, buffers[i]))
+            return VA_STATUS_ERROR_INVALID_BUFFER;
+    }
+    for (int i = 0; i < numBuffers; i++) {
+        NullBuffer* buf = *lookup(drv->buffers, buffers[i]);
+        if (buf->type == VASliceDataBufferType)
+            drv->stats.renderedSliceBytes += buf->size * buf->numElements;
+    }
+    drv->stats.renderedBuffers += numBuffers;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullEndPicture(VADriverContextP ctx, VAContextID contextId)
+{
+    NULL_DRIVER_CALL(EndPicture);
+    NullContext* context = lookup(drv->contexts, contextId);
+    if (!context)
+        return VA_STATUS_ERROR_INVALID_CONTEXT;
+    if (context->target == VA_INVALID_SURFACE)
+        return VA_STATUS_ERROR_OPERATION_FAILED;
+    NullSurface** surface = lookup(drv->surfaces, context->target);
+    if (surface)
+        (*surface)->rendering = true;
+    context->target = VA_INVALID_SURFACE;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullSyncSurface(VADriverContextP ctx, VASurfaceID renderTarget)
+{
+    NULL_DRIVER_CALL(SyncSurface);
+    NullSurface** surface = lookup(drv->surfaces, renderTarget);
+    if (!surface)
+        return VA_STATUS_ERROR_INVALID_SURFACE;
+    (*surface)->rendering = false;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullQuerySurfaceStatus(VADriverContextP ctx,
+    VASurfaceID renderTarget, VASurfaceStatus* status)
+{
+    NULL_DRIVER_LOCK();
+    NullSurface** surface = lookup(drv->surfaces, renderTarget);
+    if (!surface)
+        return VA_STATUS_ERROR_INVALID_SURFACE;
+    *status = (*surface)->rendering ? VASurfaceRendering : VASurfaceReady;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullQueryImageFormats(VADriverContextP ctx,
+    VAImageFormat* formatList, int* numFormats)
+{
+    VAImage image;
+    for (size_t i = 0; i < N_ELEMENTS(s_fourccs); i++) {
+        getImageLayout(s_fourccs[i], 16, 16, image);
+        formatList[i] = image.format;
+    }
+    *numFormats = N_ELEMENTS(s_fourccs);
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullCreateImage(VADriverContextP ctx,
+    VAImageFormat* format, int width, int height, VAImage* image)
+{
+    NULL_DRIVER_LOCK();
+    if (!getImageLayout(format->fourcc, width, height, *image))
+        return VA_STATUS_ERROR_INVALID_IMAGE_FORMAT;
+    image->buf = newBuffer(drv, VAImageBufferType, image->data_size, 1, NULL);
+    image->image_id = drv->nextId++;
+    drv->images[image->image_id] = *image;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullDeriveImage(VADriverContextP ctx,
+    VASurfaceID surfaceId, VAImage* image)
+{
+    NULL_DRIVER_CALL(DeriveImage);
+    NullSurface** surface = lookup(drv->surfaces, surfaceId);
+    if (!surface)
+        return VA_STATUS_ERROR_INVALID_SURFACE;
+    *image = (*surface)->layout;
+    image->buf = newBuffer(drv, VAImageBufferType, image->data_size, 1, &(*surface)->data[0]);
+    image->image_id = drv->nextId++;
+    drv->images[image->image_id] = *image;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullDestroyImage(VADriverContextP ctx, VAImageID imageId)
+{
+    NULL_DRIVER_CALL(DestroyImage);
+    std::map<VAImageID, VAImage>::iterator it = drv->images.find(imageId);
+    if (it == drv->images.end())
+        return VA_STATUS_ERROR_INVALID_IMAGE;
+    std::map<VABufferID, NullBuffer*>::iterator buf = drv->buffers.find(it->second.buf);
+    if (buf != drv->buffers.end())
+        deleteBuffer(drv, buf);
+    drv->images.erase(it);
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullQuerySubpictureFormats(VADriverContextP ctx,
+    VAImageFormat* formatList, unsigned int* flags, unsigned int* numFormats)
+{
+    *numFormats = 0;
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullQueryDisplayAttributes(VADriverContextP ctx,
+    VADisplayAttribute* attrList, int* numAttributes)
+{
+    *numAttributes = 0;
+    return VA_STATUS_SUCCESS;
+}
+
+static int nullIsValid(VADisplayContextP dctx)
+{
+    return dctx->pDriverContext != NULL;
+}
+
+static void nullDestroy(VADisplayContextP dctx)
+{
+    destroyNullDisplay(dctx);
+}
+
+static VAStatus nullGetDriverName(VADisplayContextP dctx, char** driverName)
+{
+    *driverName = strdup("null");
+    return VA_STATUS_SUCCESS;
+}
+
+static void fillVTable(struct VADriverVTable* vtable)
+{
+    vtable->vaTerminate = nullTerminate;
+    vtable->vaQueryConfigProfiles = nullQueryConfigProfiles;
+    vtable->vaQueryConfigEntrypoints = nullQueryConfigEntrypoints;
+    vtable->vaGetConfigAttributes = nullGetConfigAttributes;
+    vtable->vaCreateConfig = nullCreateConfig;
+    vtable->vaDestroyConfig = nullDestroyConfig;
+    vtable->vaQueryConfigAttributes = nullQueryConfigAttributes;
+    vtable->vaCreateSurfaces = nullCreateSurfaces;
+    vtable->vaCreateSurfaces2 = nullCreateSurfaces2;
+    vtable->vaDestroySurfaces = nullDestroySurfaces;
+    vtable->vaCreateContext = nullCreateContext;
+    vtable->vaDestroyContext = nullDestroyContext;
+    vtable->vaCreateBuffer = nullCreateBuffer;
+    vtable->vaBufferSetNumElements = nullBufferSetNumElements;
+    vtable->vaMapBuffer = nullMapBuffer;
+    vtable->vaUnmapBuffer = nullUnmapBuffer;
+    vtable->vaDestroyBuffer = nullDestroyBuffer;
+    vtable->vaBeginPicture = nullBeginPicture;
+    vtable->vaRenderPicture = nullRenderPicture;
+    vtable->vaEndPicture = nullEndPicture;
+    vtable->vaSyncSurface = nullSyncSurface;
+    vtable->vaQuerySurfaceStatus = nullQuerySurfaceStatus;
+    vtable->vaQueryImageFormats = nullQueryImageFormats;
+    vtable->vaCreateImage = nullCreateImage;
+    vtable->vaDeriveImage = nullDeriveImage;
+    vtable->vaDestroyImage = nullDestroyImage;
+    vtable->vaQuerySubpictureFormats = nullQuerySubpictureFormats;
+    vtable->vaQueryDisplayAttributes = nullQueryDisplayAttributes;
+}
+
+VADisplay createNullDisplay()
+{
+    VADisplayContextP dctx = (VADisplayContextP)calloc(1, sizeof(*dctx));
+    VADriverContextP ctx = (VADriverContextP)calloc(1, sizeof(*ctx));
+    struct VADriverVTable* vtable = (struct VADriverVTable*)calloc(1, sizeof(*vtable));
+    struct VADriverVTableVPP* vtableVpp = (struct VADriverVTableVPP*)calloc(1, sizeof(*vtableVpp));
+    if (!dctx || !ctx || !vtable || !vtableVpp) {
+        free(dctx);
+        free(ctx);
+        free(vtable);
+        free(vtableVpp);
+        return NULL;
+    }
+    fillVTable(vtable);
+
+    ctx->pDriverData = new NullDriver;
+    ctx->vtable = vtable;
+    ctx->vtable_vpp = vtableVpp;
+    ctx->version_major = VA_MAJOR_VERSION;
+    ctx->version_minor = VA_MINOR_VERSION;
+    ctx->max_profiles = N_ELEMENTS(s_profiles);
+    ctx->max_entrypoints = N_ELEMENTS(s_entrypoints);
+    ctx->max_attributes = 16;
+    ctx->max_image_formats = N_ELEMENTS(s_fourccs);
+    ctx->max_subpic_formats = 1;
+    ctx->max_display_attributes = 1;
+    ctx->str_vendor = "libyami null driver";
+
+    dctx->vadpy_magic = VA_DISPLAY_MAGIC;
+    dctx->pDriverContext = ctx;
+    dctx->vaIsValid = nullIsValid;
+    dctx->vaDestroy = nullDestroy;
+    dctx->vaGetDriverName = nullGetDriverName;
+    return dctx;
+}
+
+static bool isNullDisplay(VADisplay display)
+{
+    VADisplayContextP dctx = (VADisplayContextP)display;
+    return dctx && dctx->vaGetDriverName == nullGetDriverName;
+}
+
+void destroyNullDisplay(VADisplay display)
+{
+    if (!isNullDisplay(display))
+        return;
+    VADisplayContextP dctx = (VADisplayContextP)display;
+    VADriverContextP ctx = dctx->pDriverContext;
+    nullTerminate(ctx);
+    delete (NullDriver*)ctx->pDriverData;
+    free(ctx->vtable);
+    free(ctx->vtable_vpp);
+    free(ctx);
+    free(dctx);
+}
+
+bool getNullDriverStats(VADisplay display, NullDriverStats& stats)
+{
+    if (!isNullDisplay(display))
+        return false;
+    VADriverContextP ctx = ((VADisplayContextP)display)->pDriverContext;
+    NULL_DRIVER_LOCK();
+    stats = drv->stats;
+    return true;
+}
+
+void resetNullDriverStats(VADisplay display)
+{
+    if (!isNullDisplay(display))
+        return;
+    VADriverContextP ctx = ((VADisplayContextP)display)->pDriverContext;
+    NULL_DRIVER_LOCK();
+    memset(drv->stats.count, 0, sizeof(drv->stats.count));
+    memset(drv->stats.nanoseconds, 0, sizeof(drv->stats.nanoseconds));
+    drv->stats.renderedBuffers = 0;
+    drv->stats.renderedSliceBytes = 0;
+}
+
+} //namespace YamiMediaCodec
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VaapiNullDriver_h
+#define VaapiNullDriver_h
+
+#include <va/va.h>
+#include <stdint.h>
+
+namespace YamiMediaCodec {
+
+/* call counts and accumulated time of the null driver entry points,
+ * it is used to measure the host side overhead of yami without hardware */
+struct NullDriverStats {
+    enum Call {
+        CreateConfig,
+        CreateContext,
+        CreateSurfaces,
+        DestroySurfaces,
+        CreateBuffer,
+        DestroyBuffer,
+        MapBuffer,
+        UnmapBuffer,
+        BeginPicture,
+        RenderPicture,
+        EndPicture,
+        SyncSurface,
+        DeriveImage,
+        DestroyImage,
+        CallMax
+    };
+    uint64_t count[CallMax];
+    uint64_t nanoseconds[CallMax];
+    /* buffers passed to vaRenderPicture */
+    uint64_t renderedBuffers;
+    /* size of the slice data buffers passed to vaRenderPicture */
+    uint64_t renderedSliceBytes;
+    /* objects still alive */
+    uint32_t liveSurfaces;
+    uint32_t liveBuffers;
+};
+
+/* Create a VADisplay backed by system memory, nothing is decoded or encoded.
+ * A rendered surface stays VASurfaceRendering until vaSyncSurface.
+ * The display is not initialized by vaInitialize, pass it to yami with
+ * NATIVE_DISPLAY_VA, and destroy it with destroyNullDisplay */
+VADisplay createNullDisplay();
+void destroyNullDisplay(VADisplay display);
+
+/* return false if display is not a null display */
+bool getNullDriverStats(VADisplay display, NullDriverStats& stats);
+void resetNullDriverStats(VADisplay display);
+
+} //namespace YamiMediaCodec
+
+#endif //VaapiNullDriver_h
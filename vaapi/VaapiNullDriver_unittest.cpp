@@ -0,0 +1,139 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// The unittest header must be included before va_x11.h (which might be
+// included indirectly), see vaapidisplay_unittest.cpp for details.
+#include "vaapi/VaapiNullDisplayTest.h"
+
+// primary header
+#include "VaapiNullDriver.h"
+
+// library headers
+#include "vaapi/VaapiBuffer.h"
+#include "vaapi/VaapiUtils.h"
+
+namespace YamiMediaCodec {
+
+class VaapiNullDriverTest : public NullDisplayTest {
+};
+
+#define VAAPI_NULL_DRIVER_TEST(name) \
+    TEST_F(VaapiNullDriverTest, name)
+
+VAAPI_NULL_DRIVER_TEST(NotNullDisplay)
+{
+    NullDriverStats stats;
+    EXPECT_FALSE(getNullDriverStats(NULL, stats));
+}
+
+VAAPI_NULL_DRIVER_TEST(RenderPicture)
+{
+    ConfigPtr config;
+    ASSERT_EQ(YAMI_SUCCESS, VaapiConfig::create(m_display, VAProfileH264Main, VAEntrypointVLD, NULL, 0, config));
+
+    VASurfaceID surfaces[4];
+    ASSERT_EQ(VA_STATUS_SUCCESS, vaCreateSurfaces(m_vaDisplay, VA_RT_FORMAT_YUV420, 320, 240, surfaces, 4, NULL, 0));
+    ContextPtr context = VaapiContext::create(config, 320, 240, VA_PROGRESSIVE, surfaces, 4);
+    ASSERT_TRUE(bool(context));
+
+    const uint8_t data[] = { 0x00, 0x01, 0x02, 0x03 };
+    VABufferID buffers[2];
+    BufObjectPtr picture = VaapiBuffer::create(context, VAPictureParameterBufferType, sizeof(data), data);
+    BufObjectPtr slice = VaapiBuffer::create(context, VASliceDataBufferType, sizeof(data), data);
+    ASSERT_TRUE(picture && slice);
+    EXPECT_EQ(0, memcmp(slice->map(), data, sizeof(data)));
+    slice->unmap();
+    buffers[0] = picture->getID();
+    buffers[1] = slice->getID();
+
+    EXPECT_EQ(VA_STATUS_SUCCESS, vaBeginPicture(m_vaDisplay, context->getID(), surfaces[0]));
+    EXPECT_EQ(VA_STATUS_SUCCESS, vaRenderPicture(m_vaDisplay, context->getID(), buffers, 2));
+    EXPECT_EQ(VA_STATUS_SUCCESS, vaEndPicture(m_vaDisplay, context->getID()));
+    EXPECT_EQ(VA_STATUS_SUCCESS, vaSyncSurface(m_vaDisplay, surfaces[0]));
+
+    NullDriverStats stats = getStats();
+    EXPECT_EQ(1u, stats.count[NullDriverStats::CreateSurfaces]);
+    EXPECT_EQ(2u, stats.count[NullDriverStats::CreateBuffer]);
+    EXPECT_EQ(1u, stats.count[NullDriverStats::RenderPicture]);
+    EXPECT_EQ(2u, stats.renderedBuffers);
+    EXPECT_EQ(sizeof(data), stats.renderedSliceBytes);
+    EXPECT_EQ(4u, stats.liveSurfaces);
+    EXPECT_EQ(2u, stats.liveBuffers);
+
+    picture.reset();
+    slice.reset();
+    context.reset();
+    EXPECT_EQ(VA_STATUS_SUCCESS, vaDestroySurfaces(m_vaDisplay, surfaces, 4));
+    stats = getStats();
+    EXPECT_EQ(0u, stats.liveSurfaces);
+    EXPECT_EQ(0u, stats.liveBuffers);
+
+    resetNullDriverStats(m_vaDisplay);
+    stats = getStats();
+    EXPECT_EQ(0u, stats.count[NullDriverStats::CreateBuffer]);
+}
+
+VAAPI_NULL_DRIVER_TEST(DeriveImage)
+{
+    VASurfaceID surface;
+    VASurfaceAttrib attrib;
+    attrib.flags = VA_SURFACE_ATTRIB_SETTABLE;
+    attrib.type = VASurfaceAttribPixelFormat;
+    attrib.value.type = VAGenericValueTypeInteger;
+    attrib.value.value.i = YAMI_FOURCC_I420;
+    ASSERT_EQ(VA_STATUS_SUCCESS, vaCreateSurfaces(m_vaDisplay, VA_RT_FORMAT_YUV420, 64, 32, &surface, 1, &attrib, 1));
+
+    VAImage image;
+    uint8_t* p = mapSurfaceToImage(m_vaDisplay, surface, image);
+    ASSERT_TRUE(p);
+    EXPECT_EQ(YAMI_FOURCC_I420, image.format.fourcc);
+    EXPECT_EQ(3u, image.num_planes);
+    EXPECT_EQ(64u * 32 * 3 / 2, image.data_size);
+    memset(p, 0x80, image.data_size);
+    unmapImage(m_vaDisplay, image);
+
+    //write through the derived image is visible in next map
+    p = mapSurfaceToImage(m_vaDisplay, surface, image);
+    ASSERT_TRUE(p);
+    EXPECT_EQ(0x80, p[image.data_size - 1]);
+    unmapImage(m_vaDisplay, image);
+
+    EXPECT_EQ(VA_STATUS_SUCCESS, vaDestroySurfaces(m_vaDisplay, &surface, 1));
+    EXPECT_EQ(0u, getStats().liveBuffers);
+}
+
+VAAPI_NULL_DRIVER_TEST(CodedBuffer)
+{
+    ConfigPtr config;
+    ASSERT_EQ(YAMI_SUCCESS, VaapiConfig::create(m_display, VAProfileH264Main, VAEntrypointEncSlice, NULL, 0, config));
+    ContextPtr context = VaapiContext::create(config, 320, 240, VA_PROGRESSIVE, NULL, 0);
+    ASSERT_TRUE(bool(context));
+
+    BufObjectPtr coded = VaapiBuffer::create(context, VAEncCodedBufferType, 1024);
+    ASSERT_TRUE(bool(coded));
+    VACodedBufferSegment* segment = (VACodedBufferSegment*)coded->map();
+    ASSERT_TRUE(segment);
+    EXPECT_EQ(0u, segment->size);
+    EXPECT_TRUE(segment->buf);
+    EXPECT_FALSE(segment->next);
+    coded->unmap();
+}
+
+}
@@ -23,6 +23,7 @@
 #include "common/log.h"
 #include "common/common_def.h"
 #include "vaapi/vaapidisplay.h"
+#include "vaapi/VaapiBufferPool.h"
 #include "vaapi/VaapiUtils.h"
 #include "vaapi/vaapistreamable.h"
 #include <algorithm>
@@ -134,10 +135,13 @@ ContextPtr VaapiContext::create(const ConfigPtr& config,
 VaapiContext::VaapiContext(const ConfigPtr& config, VAContextID context)
 :m_config(config), m_context(context)
 {
+    m_bufferPool.reset(new VaapiBufferPool(config->m_display, context));
 }
 
 VaapiContext::~VaapiContext()
 {
+    //outstanding buffers may hold the pool, make them destroy themselves
+    m_bufferPool->close();
     vaDestroyContext(m_config->m_display->getID(), m_context);
 }
 }
@@ -46,12 +46,14 @@ public:
                       int num_render_targets);
     VAContextID getID() const { return m_context; }
     DisplayPtr getDisplay() const { return m_config->m_display; }
+    BufferPoolPtr getBufferPool() const { return m_bufferPool; }
 
     ~VaapiContext();
 private:
     VaapiContext(const ConfigPtr&,  VAContextID);
     ConfigPtr m_config;
     VAContextID m_context;
+    BufferPoolPtr m_bufferPool;
     DISALLOW_COPY_AND_ASSIGN(VaapiContext);
 };
 }
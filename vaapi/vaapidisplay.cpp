@@ -24,9 +24,13 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <list>
+#include "common/KeepAliveCache.h"
 #include "common/log.h"
 #include "common/lock.h"
 #include "vaapi/VaapiUtils.h"
+#if defined(__ENABLE_NULL_DRIVER__)
+#include "vaapi/VaapiNullDriver.h"
+#endif
 #include <inttypes.h>
 
 using std::list;
@@ -174,6 +178,32 @@ class NativeDisplayVADisplay : public NativeDisplayBase{
     }
 };
 
+#if defined(__ENABLE_NULL_DRIVER__)
+//a VADisplay backed by system memory, owned by yami
+class NativeDisplayNull : public NativeDisplayVADisplay {
+  public:
+    NativeDisplayNull() :NativeDisplayVADisplay(){ };
+    ~NativeDisplayNull() {
+        destroyNullDisplay((VADisplay)m_handle);
+    };
+    virtual bool initialize (const NativeDisplay& display) {
+        m_handle = (intptr_t)createNullDisplay();
+        m_selfCreated = true;
+        return m_handle != 0;
+    };
+
+    bool isCompatible(const NativeDisplay& display) {
+        return display.type != NATIVE_DISPLAY_VA;
+    }
+};
+
+//set YAMI_NULL_DRIVER to run without hardware
+static bool useNullDriver(const NativeDisplay& display)
+{
+    return display.type != NATIVE_DISPLAY_VA && getenv("YAMI_NULL_DRIVER");
+}
+#endif
+
 typedef SharedPtr<NativeDisplayBase> NativeDisplayPtr;
 
 bool VaapiDisplay::isCompatible(const NativeDisplay& other)
@@ -259,25 +289,49 @@ VaapiDisplay::getVaFormat(uint32_t fourcc)
 class DisplayCache
 {
 public:
-    static SharedPtr<DisplayCache> getInstance();
+    static DisplayCache* getInstance();
     DisplayPtr createDisplay(const NativeDisplay& nativeDisplay);
+    void keepAlive(const DisplayPtr& display);
+    void releaseIdle();
 
     ~DisplayCache() {}
 private:
     DisplayCache() {}
+    static void createInstance();
 
     list<WeakPtr<VaapiDisplay> > m_cache;
     YamiMediaCodec::Lock m_lock;
+
+    //strong references to idle displays, so they are not vaTerminate-d between sessions
+    KeepAliveCache<VADisplay, VaapiDisplay> m_keepAlive;
+
+    //never deleted, a static destructor must not vaTerminate cached displays
+    static DisplayCache* s_instance;
+    static pthread_once_t s_once;
 };
 
-SharedPtr<DisplayCache> DisplayCache::getInstance()
+DisplayCache* DisplayCache::s_instance;
+pthread_once_t DisplayCache::s_once = PTHREAD_ONCE_INIT;
+
+void DisplayCache::createInstance()
 {
-    static SharedPtr<DisplayCache> cache;
-    if (!cache) {
-        SharedPtr<DisplayCache> temp(new DisplayCache);
-        cache = temp;
-    }
-    return cache;
+    s_instance = new DisplayCache;
+}
+
+DisplayCache* DisplayCache::getInstance()
+{
+    pthread_once(&s_once, createInstance);
+    return s_instance;
+}
+
+void DisplayCache::keepAlive(const DisplayPtr& display)
+{
+    m_keepAlive.put(display->getID(), display);
+}
+
+void DisplayCache::releaseIdle()
+{
+    m_keepAlive.clear();
 }
 
 bool expired(const WeakPtr<VaapiDisplay>& weak)
@@ -307,6 +361,22 @@ DisplayPtr DisplayCache::createDisplay(const NativeDisplay& nativeDisplay)
     //crate new one
     DEBUG("nativeDisplay: (type : %d), (handle : %" PRIxPTR ")", nativeDisplay.type, nativeDisplay.handle);
 
+#if defined(__ENABLE_NULL_DRIVER__)
+    if (useNullDriver(nativeDisplay)) {
+        nativeDisplayObj.reset(new NativeDisplayNull());
+        if (nativeDisplayObj->initialize(nativeDisplay))
+            vaDisplay = (VADisplay)nativeDisplayObj->nativeHandle();
+        INFO("use vaapi null backend");
+        if (vaDisplay) {
+            DisplayPtr temp(new VaapiDisplay(nativeDisplayObj, vaDisplay));
+            m_cache.push_back(WeakPtr<VaapiDisplay>(temp));
+            return temp;
+        }
+        ERROR("create null display failed.");
+        return vaapiDisplay;
+    }
+#endif
+
     switch (nativeDisplay.type) {
     case NATIVE_DISPLAY_AUTO:
 #if defined(__ENABLE_X11__)
@@ -359,4 +429,15 @@ DisplayPtr VaapiDisplay::create(const NativeDisplay& display)
 {
     return DisplayCache::getInstance()->createDisplay(display);
 }
+
+void VaapiDisplay::keepAlive(const DisplayPtr& display)
+{
+    if (display)
+        DisplayCache::getInstance()->keepAlive(display);
+}
+
+void VaapiDisplay::releaseCache()
+{
+    DisplayCache::getInstance()->releaseIdle();
+}
 } //YamiMediaCodec
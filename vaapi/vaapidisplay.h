@@ -45,6 +45,10 @@ public:
     virtual ~VaapiDisplay();
     //FIXME: add more create functions.
     static DisplayPtr create(const NativeDisplay& display);
+    /// keep @display initialized after its last user is gone, see KeepAliveCache
+    static void keepAlive(const DisplayPtr& display);
+    /// release the displays kept by keepAlive(), displays still in use are not affected
+    static void releaseCache();
     virtual bool setRotation(int degree);
     VADisplay getID() const { return m_vaDisplay; }
     const VAImageFormat* getVaFormat(uint32_t fourcc);
@@ -22,6 +22,7 @@
 
 #include "common/log.h"
 #include "VaapiBuffer.h"
+#include "VaapiBufferPool.h"
 #include "vaapidisplay.h"
 #include "vaapicontext.h"
 #include "VaapiSurface.h"
@@ -55,17 +56,39 @@ bool VaapiPicture::render()
     if (!checkVaapiStatus(status, "vaBeginPicture()"))
         return false;
 
+#if __PSB_RENDER_BUFFER_ONE_BY_ONE__
+    //buffers are rendered and destroyed one by one, the pool is not used
     bool ret = doRender();
+    status = vaEndPicture(m_display->getID(), m_context->getID());
+#else
+    BufferPoolPtr pool = m_context->getBufferPool();
+    pool->beginPicture();
+    bool ret = doRender();
+    if (ret)
+        ret = renderPending();
 
     status = vaEndPicture(m_display->getID(), m_context->getID());
+    m_pendingIds.clear();
+    m_pendingBuffers.clear();
+    //buffers released during rendering are reused once the surface is ready
+    pool->endPicture(m_surface->getID());
+#endif
     if (!checkVaapiStatus(status, "vaEndPicture()"))
         return false;
     return ret;
 }
 
+bool VaapiPicture::renderPending()
+{
+    if (m_pendingIds.empty())
+        return true;
+    VAStatus status = vaRenderPicture(m_display->getID(), m_context->getID(),
+        &m_pendingIds[0], m_pendingIds.size());
+    return checkVaapiStatus(status, "vaRenderPicture failed");
+}
+
 bool VaapiPicture::render(BufObjectPtr& buffer)
 {
-    VAStatus status = VA_STATUS_SUCCESS;
     VABufferID bufferID = VA_INVALID_ID;
 
     if (!buffer)
@@ -77,9 +100,15 @@ bool VaapiPicture::render(BufObjectPtr& buffer)
     if (bufferID == VA_INVALID_ID)
         return false;
 
-    status = vaRenderPicture(m_display->getID(), m_context->getID(), &bufferID, 1);
+#if __PSB_RENDER_BUFFER_ONE_BY_ONE__
+    VAStatus status = vaRenderPicture(m_display->getID(), m_context->getID(), &bufferID, 1);
     if (!checkVaapiStatus(status, "vaRenderPicture failed"))
         return false;
+#else
+    //keep the order, driver may depend on it
+    m_pendingIds.push_back(bufferID);
+    m_pendingBuffers.push_back(buffer);
+#endif
 
     buffer.reset();             // silently work  arouond for psb
     return true;
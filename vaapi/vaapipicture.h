@@ -18,6 +18,7 @@
 #define vaapipicture_h
 
 #include "VideoCommonDefs.h"
+#include "common/log.h"
 #include "VaapiBuffer.h"
 #include "vaapiptrs.h"
 #include "VaapiSurface.h"
@@ -81,6 +82,13 @@ protected:
     inline BufObjectPtr createBufferObject(VABufferType bufType,
         uint32_t size, const void* data, void** mapped);
     VaapiPicture();
+
+private:
+    bool renderPending();
+
+    //buffers queued by render(buffer), submitted in one vaRenderPicture
+    std::vector<VABufferID> m_pendingIds;
+    std::vector<BufObjectPtr> m_pendingBuffers;
 };
 
 template<class T>
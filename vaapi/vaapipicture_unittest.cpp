@@ -0,0 +1,113 @@
+/*
+ * Copyright 2016 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+// The unittest header must be included before va_x11.h (which might be
+// included indirectly), see vaapidisplay_unittest.cpp for details.
+#include "vaapi/VaapiNullDisplayTest.h"
+
+// primary header
+#include "vaapipicture.h"
+
+// system headers
+#include <vector>
+
+namespace YamiMediaCodec {
+
+class TestPicture : public VaapiPicture {
+public:
+    TestPicture(const ContextPtr& context, const SurfacePtr& surface)
+        : VaapiPicture(context, surface, 0)
+    {
+    }
+
+    bool addSlice()
+    {
+        VASliceParameterBufferH264* param;
+        BufObjectPtr data = createBufferObject(VASliceDataBufferType, 16, NULL, NULL);
+        return addObject(m_slices, createBufferObject(VASliceParameterBufferType, param), data);
+    }
+
+    bool decode()
+    {
+        VAPictureParameterBufferH264* param;
+        if (!editObject(m_picture, VAPictureParameterBufferType, param))
+            return false;
+        return render();
+    }
+
+    std::vector<std::pair<BufObjectPtr, BufObjectPtr> > m_slices;
+
+private:
+    virtual bool doRender()
+    {
+        RENDER_OBJECT(m_picture);
+        RENDER_OBJECT(m_slices);
+        return true;
+    }
+
+    BufObjectPtr m_picture;
+};
+
+class VaapiPictureTest : public NullDisplayTest {
+protected:
+    virtual void SetUp()
+    {
+        NullDisplayTest::SetUp();
+        m_context = createContext(VAProfileH264Main, VAEntrypointVLD, 1);
+        ASSERT_TRUE(bool(m_context));
+        m_surface.reset(new VaapiSurface(m_surfaces[0], 320, 240, YAMI_FOURCC_NV12));
+    }
+
+    virtual void TearDown()
+    {
+        m_surface.reset();
+        m_context.reset();
+        NullDisplayTest::TearDown();
+    }
+
+    ContextPtr m_context;
+    SurfacePtr m_surface;
+};
+
+#define VAAPI_PICTURE_TEST(name) \
+    TEST_F(VaapiPictureTest, name)
+
+VAAPI_PICTURE_TEST(BatchRender)
+{
+    const uint32_t slices = 10;
+    TestPicture picture(m_context, m_surface);
+    for (uint32_t i = 0; i < slices; i++)
+        ASSERT_TRUE(picture.addSlice());
+    ASSERT_TRUE(picture.decode());
+    EXPECT_TRUE(picture.m_slices.empty());
+
+    NullDriverStats stats = getStats();
+    EXPECT_EQ(1 + slices * 2, stats.renderedBuffers);
+#if __PSB_RENDER_BUFFER_ONE_BY_ONE__
+    EXPECT_EQ(1 + slices * 2, stats.count[NullDriverStats::RenderPicture]);
+    //destroyed right after rendering, none of them is pooled
+    EXPECT_EQ(0u, stats.liveBuffers);
+#else
+    EXPECT_EQ(1u, stats.count[NullDriverStats::RenderPicture]);
+#endif
+    EXPECT_EQ(1u, stats.count[NullDriverStats::EndPicture]);
+}
+
+}
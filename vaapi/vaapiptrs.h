@@ -29,6 +29,9 @@ typedef SharedPtr < VaapiCodedBuffer > CodedBufferPtr;
 class VaapiBuffer;
 typedef SharedPtr<VaapiBuffer> BufObjectPtr;
 
+class VaapiBufferPool;
+typedef SharedPtr<VaapiBufferPool> BufferPoolPtr;
+
 class VaapiDisplay;
 typedef SharedPtr < VaapiDisplay > DisplayPtr;
 